@@ -0,0 +1,86 @@
+// Benchmark: CPU cost of the timestamps of one request
+//
+// A request takes a Date header and, at log_level INFO, a few log
+// timestamps. Compares formatting them on every call, as HttpUtils and the
+// Logger used to, with reading the strings the Clock formats once per
+// second, the Clock being updated once per request (an event loop
+// iteration serves one or more).
+//
+// Run with: make bench
+
+#include <sys/time.h>
+#include <time.h>
+#include <cstdio>
+#include <string>
+#include "WebServer/Clock/Clock.hpp"
+
+#define BENCH_REQUESTS 1000000
+// Líneas de log de una petición a nivel INFO
+#define BENCH_LOG_LINES 3
+
+static std::string httpDateBefore() {
+  time_t    now = time(0);
+  struct tm tm  = *gmtime(&now);
+  char      buf[100];
+  strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return std::string(buf);
+}
+
+static std::string logTimeBefore() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  time_t    now = tv.tv_sec;
+  struct tm tstruct;
+  localtime_r(&now, &tstruct);
+  char buf[80];
+  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tstruct);
+  char currentTimeWithMs[84];
+  snprintf(currentTimeWithMs, sizeof(currentTimeWithMs), "%s.%03ld", buf, tv.tv_usec / 1000);
+  return std::string(currentTimeWithMs);
+}
+
+static size_t requestBefore() {
+  size_t      length = 0;
+  std::string date   = "Date: " + httpDateBefore() + "\r\n";
+  length += date.size();
+  for (int i = 0; i < BENCH_LOG_LINES; ++i) {
+    length += logTimeBefore().size();
+  }
+  return length;
+}
+
+static size_t requestClock() {
+  size_t length = 0;
+  Clock::update();
+  length += Clock::dateHeader().size();
+  for (int i = 0; i < BENCH_LOG_LINES; ++i) {
+    // El Logger copia la cadena en el mensaje
+    length += std::string(Clock::logTime()).size();
+  }
+  return length;
+}
+
+static double cpuNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double run(size_t (*request)(), int count, size_t &sink) {
+  double start = cpuNs();
+  for (int i = 0; i < count; ++i) {
+    sink += request();
+  }
+  return (cpuNs() - start) / count;
+}
+
+int main() {
+  size_t sink   = 0;
+  double before = run(requestBefore, BENCH_REQUESTS, sink);
+  double clock  = run(requestClock, BENCH_REQUESTS, sink);
+
+  printf("%-14s %14s\n", "timestamps", "cpu ns/request");
+  printf("%-14s %14.1f\n", "per call", before);
+  printf("%-14s %14.1f\n", "clock", clock);
+  return sink == 0;
+}
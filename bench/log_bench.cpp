@@ -0,0 +1,116 @@
+// Benchmark: CPU cost of filtered log statements per request
+//
+// Replays the log statements of a typical GET request (the DEBUG and INFO
+// lines it prints at log_level DEBUG) with the level set to ERROR, as in
+// production, in three builds of the macros:
+//   - before:       the message is formatted, then log() filters it
+//   - runtime:      LOG_* check the active level first
+//   - compiled out: LOG_MIN_LEVEL=Logger::INFO, LOG_DEBUG is not built
+//
+// Run with: make bench
+
+#include <time.h>
+#include <cstdio>
+#include <string>
+#include "Logger/includes/Logger.hpp"
+
+#define BENCH_REQUESTS 1000000
+
+// LOG_* antes de comprobar el nivel
+#define BEFORE_LOG(level, message)                                 \
+  {                                                                \
+    std::ostringstream oss;                                        \
+    oss << message;                                                \
+    Logger::getInstance().log(level, oss, __FUNCTION__, __FILE__); \
+  }
+
+struct Request {
+  int         socket;
+  int         client_id;
+  int         status;
+  std::string method;
+  std::string location;
+  std::string file_path;
+};
+
+static void requestBefore(const Request &r) {
+  BEFORE_LOG(Logger::DEBUG, "Activity on socket " << r.socket << " (read), client ID: " << r.client_id);
+  BEFORE_LOG(Logger::DEBUG, "RequestParser constructor called");
+  BEFORE_LOG(Logger::DEBUG, "Using location-specific configuration for path: " << r.location);
+  BEFORE_LOG(Logger::DEBUG, "Received request method: " << r.method);
+  BEFORE_LOG(Logger::DEBUG, "Full file path: " << r.file_path);
+  BEFORE_LOG(Logger::DEBUG, "Delete allowed: " << 1);
+  BEFORE_LOG(Logger::DEBUG, "Queueing response on socket: " << r.socket << ", status: " << r.status);
+  BEFORE_LOG(Logger::DEBUG, "RequestParser destructor called");
+  BEFORE_LOG(Logger::DEBUG, "Activity on socket " << r.socket << " (read), client ID: " << r.client_id);
+  BEFORE_LOG(Logger::DEBUG, "Closing connection for client ID: " << r.client_id);
+  BEFORE_LOG(Logger::INFO, "Active connections: " << 0);
+}
+
+static void requestRuntime(const Request &r) {
+  LOG_DEBUG("Activity on socket " << r.socket << " (read), client ID: " << r.client_id);
+  LOG_DEBUG("RequestParser constructor called");
+  LOG_DEBUG("Using location-specific configuration for path: " << r.location);
+  LOG_DEBUG("Received request method: " << r.method);
+  LOG_DEBUG("Full file path: " << r.file_path);
+  LOG_DEBUG("Delete allowed: " << 1);
+  LOG_DEBUG("Queueing response on socket: " << r.socket << ", status: " << r.status);
+  LOG_DEBUG("RequestParser destructor called");
+  LOG_DEBUG("Activity on socket " << r.socket << " (read), client ID: " << r.client_id);
+  LOG_DEBUG("Closing connection for client ID: " << r.client_id);
+  LOG_INFO("Active connections: " << 0);
+}
+
+// Lo mismo compilado como con make release
+#undef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL Logger::INFO
+
+static void requestCompiledOut(const Request &r) {
+  LOG_DEBUG("Activity on socket " << r.socket << " (read), client ID: " << r.client_id);
+  LOG_DEBUG("RequestParser constructor called");
+  LOG_DEBUG("Using location-specific configuration for path: " << r.location);
+  LOG_DEBUG("Received request method: " << r.method);
+  LOG_DEBUG("Full file path: " << r.file_path);
+  LOG_DEBUG("Delete allowed: " << 1);
+  LOG_DEBUG("Queueing response on socket: " << r.socket << ", status: " << r.status);
+  LOG_DEBUG("RequestParser destructor called");
+  LOG_DEBUG("Activity on socket " << r.socket << " (read), client ID: " << r.client_id);
+  LOG_DEBUG("Closing connection for client ID: " << r.client_id);
+  LOG_INFO("Active connections: " << 0);
+}
+
+static double cpuNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double run(void (*request)(const Request &), const Request &r, int count) {
+  double start = cpuNs();
+  for (int i = 0; i < count; ++i) {
+    request(r);
+  }
+  return (cpuNs() - start) / count;
+}
+
+int main() {
+  Request r;
+  r.socket    = 7;
+  r.client_id = 2;
+  r.status    = 200;
+  r.method    = "GET";
+  r.location  = "/files";
+  r.file_path = "/var/www/files/index.html";
+
+  Logger::getInstance().setLogLevel(Logger::ERROR);
+
+  double before   = run(requestBefore, r, BENCH_REQUESTS / 10);
+  double runtime  = run(requestRuntime, r, BENCH_REQUESTS);
+  double compiled = run(requestCompiledOut, r, BENCH_REQUESTS);
+
+  printf("%-14s %14s\n", "macros", "cpu ns/request");
+  printf("%-14s %14.1f\n", "before", before);
+  printf("%-14s %14.1f\n", "runtime check", runtime);
+  printf("%-14s %14.1f\n", "compiled out", compiled);
+  return 0;
+}
@@ -0,0 +1,165 @@
+// Benchmark: server and location selection, linear scan vs RouteTable
+//
+// Builds configurations of growing size (virtual hosts on one port, each
+// with its share of locations) and times the lookup of request paths with
+// the linear scan that get_server() used to do and with the compiled
+// RouteTable. Both must pick the same entry for every request.
+//
+// Run with: make bench
+
+#include <sys/time.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ConfigFileParse/RouteTable/RouteTable.hpp"
+#include "ConfigFileParse/Server/Server.hpp"
+
+#define BENCH_PORT 8080
+#define BENCH_HOSTS 10
+
+struct Request {
+  std::string host;
+  std::string path;
+};
+
+// get_server() antes de RouteTable, sin las trazas LOG_DEBUG
+static int linearFind(const std::vector<Server> &servers, const std::string &hostname, int port, const std::string &path) {
+  int         exactMatch = -1;
+  int         portMatch  = -1;
+  int         bestMatch  = -1;
+  std::string bestMatchPath;
+
+  for (size_t i = 0; i < servers.size(); ++i) {
+    if (servers[i].getListen() != port)
+      continue;
+    if (portMatch < 0)
+      portMatch = i;
+    if (servers[i].matchServerName(hostname)) {
+      std::string locationPath = servers[i].getLocationPath();
+      if (locationPath == path) {
+        exactMatch = i;
+        break;
+      }
+      if (path.compare(0, locationPath.length(), locationPath) == 0) {
+        if (bestMatch < 0 || locationPath.length() > bestMatchPath.length()) {
+          bestMatch     = i;
+          bestMatchPath = locationPath;
+        }
+      }
+    }
+  }
+  if (exactMatch >= 0)
+    return exactMatch;
+  if (bestMatch >= 0)
+    return bestMatch;
+  return portMatch;
+}
+
+static std::string hostName(size_t host) {
+  std::ostringstream name;
+  name << "site" << host << ".example.com";
+  return name.str();
+}
+
+// Un bloque server por host y sus locations, como los deja el parser
+static void buildServers(size_t locations, std::vector<Server> &servers) {
+  servers.clear();
+  for (size_t host = 0; host < BENCH_HOSTS; ++host) {
+    Server server;
+    server.setListen(BENCH_PORT);
+    server.addServerName(hostName(host));
+    server.setLocationPath("/");
+    servers.push_back(server);
+
+    for (size_t i = host; i < locations; i += BENCH_HOSTS) {
+      std::ostringstream path;
+      path << "/app" << i % 97 << "/section" << i;
+      Server location = server;
+      location.setType(1);
+      location.setLocationPath(path.str());
+      servers.push_back(location);
+    }
+  }
+}
+
+static void buildRequests(size_t locations, size_t count, std::vector<Request> &requests) {
+  requests.resize(count);
+  for (size_t n = 0; n < count; ++n) {
+    size_t             i = rand() % locations;
+    std::ostringstream path;
+    path << "/app" << i % 97 << "/section" << i;
+    if (n % 4 == 1)
+      path << "/images/logo.png";
+    else if (n % 4 == 2)
+      path.str("/index.html");
+    requests[n].host = hostName(n % 5 == 0 ? rand() % BENCH_HOSTS : i % BENCH_HOSTS);
+    requests[n].path = path.str();
+  }
+}
+
+static double elapsedNs(const struct timeval &start, size_t lookups) {
+  struct timeval end;
+  gettimeofday(&end, NULL);
+  double us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_usec - start.tv_usec);
+  return us * 1000.0 / lookups;
+}
+
+int main() {
+  static const size_t sizes[] = {10, 100, 1000, 10000};
+
+  Logger::getInstance().setLogLevel(Logger::ERROR);
+  srand(42);
+  printf("%10s %10s %16s %16s %10s\n", "locations", "lookups", "linear ns/op", "table ns/op", "speedup");
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    std::vector<Server>  servers;
+    std::vector<Request> requests;
+    RouteTable           table;
+    size_t               lookups = std::max(static_cast<size_t>(2000), 20000000 / sizes[s]);
+
+    buildServers(sizes[s], servers);
+    buildRequests(sizes[s], 4096, requests);
+    table.build(servers);
+
+    for (size_t n = 0; n < requests.size(); ++n) {
+      const Request &request  = requests[n];
+      int            expected = linearFind(servers, request.host, BENCH_PORT, request.path);
+      int            found =
+          table.find(request.host.data(), request.host.size(), BENCH_PORT, request.path.data(), request.path.size());
+      if (expected != found) {
+        fprintf(stderr, "mismatch for %s%s: linear %d, table %d\n", request.host.c_str(), request.path.c_str(),
+                expected, found);
+        return 1;
+      }
+    }
+
+    struct timeval start;
+    long           checksum = 0;
+
+    gettimeofday(&start, NULL);
+    for (size_t n = 0; n < lookups; ++n) {
+      const Request &request = requests[n % requests.size()];
+      checksum += linearFind(servers, request.host, BENCH_PORT, request.path);
+    }
+    double linear = elapsedNs(start, lookups);
+
+    gettimeofday(&start, NULL);
+    for (size_t n = 0; n < lookups; ++n) {
+      const Request &request = requests[n % requests.size()];
+      checksum -=
+          table.find(request.host.data(), request.host.size(), BENCH_PORT, request.path.data(), request.path.size());
+    }
+    double compiled = elapsedNs(start, lookups);
+
+    if (checksum != 0) {
+      fprintf(stderr, "checksum mismatch\n");
+      return 1;
+    }
+    printf("%10lu %10lu %16.1f %16.1f %9.1fx\n", static_cast<unsigned long>(sizes[s]),
+           static_cast<unsigned long>(lookups), linear, compiled, linear / compiled);
+  }
+  return 0;
+}
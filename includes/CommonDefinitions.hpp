@@ -6,19 +6,16 @@
 #include <vector>
 #include <map>
 #include <fstream>
+#include <unistd.h>
 
-#define AJXWEBSERVER_VERSION "1.1.1"
+#include "SocketResult.hpp"
+#include "RequestParser/HttpScanner.hpp"
+#include "RequestParser/RequestBody.hpp"
+#include "WebServer/AccessLog/AccessLog.hpp"
+#include "WebServer/BufferPool/InputBuffer.hpp"
+#include "WebServer/OutputQueue/OutputQueue.hpp"
 
-// -----------------------------------------------------------------------------
-// SocketResult
-// -----------------------------------------------------------------------------
-enum SocketResult
-{
-    SOCKET_OK,
-    SOCKET_CLOSED,
-    SOCKET_ERROR,
-    SOCKET_WOULD_BLOCK
-};
+#define AJXWEBSERVER_VERSION "1.1.1"
 
 // -----------------------------------------------------------------------------
 // HTTP Error Codes
@@ -47,71 +44,147 @@ enum e_http_errorcodes {
 //  LOCAL CONFIG
 // -----------------------------------------------------------------------------
 
+// Bits of LocationConfig::allowed_methods
+enum e_http_methods {
+  HTTP_METHOD_GET    = 1 << 0,
+  HTTP_METHOD_POST   = 1 << 1,
+  HTTP_METHOD_DELETE = 1 << 2,
+  HTTP_METHOD_HEAD   = 1 << 3
+};
+
+// Settings of a location, compiled once from its Server block when the
+// configuration is loaded (ConfigurationManager::compileLocations). Requests
+// get a const reference that stays valid as long as the configuration.
 struct LocationConfig {
     bool                                autoindex;
+    bool                                sendfile;
     unsigned int                        client_max_body_size;
+    unsigned int                        allowed_methods; // Máscara de HTTP_METHOD_*
     std::string                         location_path;  
     std::string                         root_path;
+    std::string                         root_dir;    // root_path terminado en '/'
     std::string                         upload_path;
-    std::vector<std::string>            allowed_methods;
     std::vector<std::string>            index_files;
-    std::map<int, std::string>          error_pages;
+    std::map<int, std::string>          error_pages; // Solo las páginas .html, las que se sirven
     std::map<short int, std::string>    return_code_path;
     std::map<std::string, std::string>  cgi_extensions;
     std::map<std::string, std::string>  redirects;
+
+    LocationConfig() : autoindex(false), sendfile(false), client_max_body_size(0), allowed_methods(0) {}
+
+    bool allows(unsigned int method) const { return (allowed_methods & method) != 0; }
 };
 
-struct FileState {
-  std::ifstream *file;
-  size_t         file_size;
-  size_t         bytes_sent;
-  bool           headers_sent;
-  char           buffer[4096];
-  size_t         buffer_pos;
-  size_t         buffer_len;
-  bool           last_chunk_sent;
-  std::string    filename;
-
-  FileState() : file(NULL), file_size(0), bytes_sent(0), headers_sent(false), buffer_pos(0), buffer_len(0), last_chunk_sent(false) {}
-
-  ~FileState() {
-    if (file) {
-      file->close();
-      delete file;
-    }
-  }
+class RequestTask;
+class MultipartParser;
+
+// Deadline kinds tracked per connection by the TimerWheel
+enum TimerKind {
+  TIMER_NONE,
+  TIMER_KEEPALIVE, // Esperando la siguiente petición
+  TIMER_HEADER,    // Leyendo las cabeceras
+  TIMER_BODY,      // Leyendo el cuerpo (se reinicia con cada lectura)
+  TIMER_SEND,      // Enviando la respuesta (se reinicia con cada escritura)
+  TIMER_TASK       // Esperando a una tarea (CGI...)
+};
 
-private:
-  // Prohibir la copia
-  FileState(const FileState &);
-  FileState &operator=(const FileState &);
+// Intrusive node of the TimerWheel. Embedded in its owner so arming and
+// cancelling a deadline never allocates.
+struct TimerNode {
+  TimerNode    *prev;
+  TimerNode    *next;
+  unsigned long expires; // En ticks de la rueda
+  int           kind;
+  void         *owner;
+
+  TimerNode() : prev(NULL), next(NULL), expires(0), kind(TIMER_NONE), owner(NULL) {}
+  bool isLinked() const { return next != NULL; }
 };
 
 struct ClientInfo {
   int            socket;
   int            id;
   int            port;
+  unsigned int   slot;
+  unsigned int   generation;
   bool           ready_for_read;
   bool           ready_for_write;
   bool           waiting_to_write;
-  std::string    pending_response;
-  std::string    partial_request;
-  bool           request_complete;
-  size_t         content_length;
-  size_t         bytes_received;
-  time_t         last_activity;
+  bool           read_paused; // Demasiada salida pendiente, no se leen más peticiones
+  unsigned int   interest;
+  OutputQueue    output;
+  InputBuffer    input; // Bytes recibidos aún sin atender
+  HttpScanner    scanner;
+  RequestBody    body;
+  bool           body_checked;
+  size_t         body_limit;
+  MultipartParser *upload; // Recibe el cuerpo multipart en curso, NULL si no hay
+  RequestTask   *task;    // Petición suspendida, NULL si no hay
+  int            task_fd; // Descriptor registrado por la tarea, -1 si no hay
+  TimerNode      timer;
+  AccessEntry    access; // Petición en curso, para el access log
+
+  ClientInfo()
+      : socket(-1)
+      , id(0)
+      , port(0)
+      , slot(0)
+      , generation(0)
+      , ready_for_read(false)
+      , ready_for_write(false)
+      , waiting_to_write(false)
+      , read_paused(false)
+      , interest(0)
+      , body_checked(false)
+      , body_limit(0)
+      , upload(NULL)
+      , task(NULL)
+      , task_fd(-1) {
+    timer.owner = this;
+  }
 
   ClientInfo(int s, int i, int p)
       : socket(s)
       , id(i)
       , port(p)
+      , slot(0)
+      , generation(0)
       , ready_for_read(false)
       , ready_for_write(false)
       , waiting_to_write(false)
-      , request_complete(false)
-      , content_length(0)
-      , bytes_received(0)
-      , last_activity(time(NULL)) {}
+      , read_paused(false)
+      , interest(0)
+      , body_checked(false)
+      , body_limit(0)
+      , upload(NULL)
+      , task(NULL)
+      , task_fd(-1) {
+    timer.owner = this;
+  }
+
+  // Reutiliza el objeto para una nueva conexión conservando la memoria de los buffers
+  void reset(int s, int i, int p) {
+    socket           = s;
+    id               = i;
+    port             = p;
+    ready_for_read   = false;
+    ready_for_write  = false;
+    waiting_to_write = false;
+    read_paused      = false;
+    interest         = 0;
+    output.clear();
+    input.clear();
+    scanner.reset();
+    body.clear();
+    body_checked     = false;
+    body_limit       = 0;
+    upload           = NULL;
+    task             = NULL;
+    task_fd          = -1;
+    timer.owner      = this;
+    access.start_us      = 0;
+    access.task_start_us = 0;
+  }
 };
 
 // -----------------------------------------------------------------------------
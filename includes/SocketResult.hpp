@@ -0,0 +1,16 @@
+// SocketResult.hpp
+#ifndef SOCKET_RESULT_HPP
+#define SOCKET_RESULT_HPP
+
+// -----------------------------------------------------------------------------
+// SocketResult
+// -----------------------------------------------------------------------------
+enum SocketResult
+{
+    SOCKET_OK,
+    SOCKET_CLOSED,
+    SOCKET_ERROR,
+    SOCKET_WOULD_BLOCK
+};
+
+#endif // SOCKET_RESULT_HPP
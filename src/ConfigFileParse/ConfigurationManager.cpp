@@ -45,8 +45,61 @@ bool ConfigurationManager::parseFile(const std::string &file_path) {
     }
   }
   file.close();
+  compileLocations();
   return true;
 }
+
+/**
+ * @brief Builds the LocationConfig of every Server block and the routing
+ *        table that selects them.
+ *
+ * Done once after parsing, so a request only takes a reference to the
+ * location that matches instead of copying its settings. The servers must
+ * not change afterwards.
+ */
+void ConfigurationManager::compileLocations() {
+  _locations.clear();
+  _locations.resize(_servers.size());
+  for (size_t i = 0; i < _servers.size(); ++i) {
+    const Server   &server   = _servers[i];
+    LocationConfig &location = _locations[i];
+
+    location.location_path        = server.getLocationPath();
+    location.root_path            = server.getRootPath();
+    location.root_dir             = location.root_path;
+    location.autoindex            = server.getAutoindex();
+    location.sendfile             = server.getSendfile();
+    location.client_max_body_size = server.getClientMaxBodySize();
+    location.index_files          = server.getIndex();
+    location.cgi_extensions       = server.getLocationCgiHandler();
+    location.upload_path          = server.getUploadPath();
+    location.return_code_path     = server.getReturnCodePath();
+    if (!location.root_dir.empty() && location.root_dir[location.root_dir.length() - 1] != '/') {
+      location.root_dir += '/';
+    }
+
+    const std::vector<std::string> &methods = server.getAllowedMethods();
+    for (std::vector<std::string>::const_iterator it = methods.begin(); it != methods.end(); ++it) {
+      if (*it == "GET")
+        location.allowed_methods |= HTTP_METHOD_GET;
+      else if (*it == "POST")
+        location.allowed_methods |= HTTP_METHOD_POST;
+      else if (*it == "DELETE")
+        location.allowed_methods |= HTTP_METHOD_DELETE;
+      else if (*it == "HEAD")
+        location.allowed_methods |= HTTP_METHOD_HEAD;
+    }
+
+    // Solo se sirven como página de error los ficheros .html
+    const std::map<int, std::string> &pages = server.getErrorPages();
+    for (std::map<int, std::string>::const_iterator it = pages.begin(); it != pages.end(); ++it) {
+      if (it->second.substr(it->second.find_last_of('.') + 1) == "html") {
+        location.error_pages.insert(*it);
+      }
+    }
+  }
+  _routes.build(_servers);
+}
 /**
  * @brief Parse a line of the configuration file
  * @param line The line to parse
@@ -115,6 +168,8 @@ bool ConfigurationManager::parseServerConfig(std::istringstream &iss, std::strin
     return parseClientMaxBodySize(value);
   else if (token == "autoindex" and (depth == 1 or depth == 2))
     return parseAutoindex(value);
+  else if (token == "sendfile" and (depth == 1 or depth == 2))
+    return parseSendfile(value);
   else if (token == "allowed_methods" and (depth == 1 or depth == 2))
     return parseAllowedMethods(value);
   else if (token == "cgi_ext" and (depth == 1 or depth == 2))
@@ -305,6 +360,26 @@ bool ConfigurationManager::parseAutoindex(const std::string &value) {
   }
   return false;
 }
+/**
+ * @brief Parse the sendfile configuration
+ *
+ * "sendfile off" makes static files go through buffered reads instead of
+ * sendfile(2), e.g. for file systems that do not support it.
+ * @param value The value to parse
+ * @return True if the value was parsed successfully, false otherwise
+ */
+bool ConfigurationManager::parseSendfile(const std::string &value) {
+  if (value != "on" && value != "off") {
+    LOG_ERROR("Invalid sendfile value (on|off): " << value);
+    return false;
+  }
+  if (_servers.empty()) {
+    LOG_CRITICAL("No server to assign " << value);
+    return false;
+  }
+  _servers.back().setSendfile(value == "on");
+  return true;
+}
 /**
  * @brief Parse the client max body size configuration
  * @param value The value to parse
@@ -429,15 +504,32 @@ bool ConfigurationManager::parseIndex(const std::string &value) {
 }
 /**
  * @brief Parse the listen configuration
+ *
+ * `listen [ip:]port [backlog=N] [deferred[=seconds]] [fastopen=N]
+ * [rcvbuf=size] [sndbuf=size]`; sizes accept a K or M suffix. The backlog
+ * must be at least 1.
+ *
  * @param value The value to parse
  * @return True if the value was parsed successfully, false otherwise
  */
 bool ConfigurationManager::parseListen(const std::string &value) {
-  size_t colonPos = value.find(':');
+  std::istringstream iss(value);
+  std::string        address;
+  iss >> address;
+
+  if (_servers.empty()) {
+    LOG_ERROR("No server to assign " << value);
+    return false;
+  }
+  if (!parseListenOptions(iss)) {
+    return false;
+  }
+
+  size_t colonPos = address.find(':');
 
   if (colonPos != std::string::npos) {
-    std::string ip      = value.substr(0, colonPos);
-    std::string portStr = value.substr(colonPos + 1);
+    std::string ip      = address.substr(0, colonPos);
+    std::string portStr = address.substr(colonPos + 1);
 
     struct in_addr addr;
     if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
@@ -445,24 +537,86 @@ bool ConfigurationManager::parseListen(const std::string &value) {
 
       return false;
     }
-
-    if (!_servers.empty()) {
-      _servers.back().setIp(ip);
-    } else {
-      LOG_ERROR("No server to assign IP: " << ip);
-      return false;
-    }
-
+    _servers.back().setIp(ip);
     return validateAndSetPort(portStr);
   } else {
-    if (!_servers.empty()) {
-      _servers.back().setIp("127.0.0.1");
-    } else {
-      LOG_ERROR("No server to assign ");
+    _servers.back().setIp("127.0.0.1");
+    return validateAndSetPort(address);
+  }
+}
+/**
+ * @brief Parse the socket options that follow the address of a listen
+ * @param iss The stream positioned after the address
+ * @return True if every option was valid, false otherwise
+ */
+bool ConfigurationManager::parseListenOptions(std::istringstream &iss) {
+  ListenOptions options;
+  std::string   option;
+
+  while (iss >> option) {
+    size_t      equalPos = option.find('=');
+    std::string name     = option.substr(0, equalPos);
+    std::string arg      = equalPos == std::string::npos ? "" : option.substr(equalPos + 1);
+    int         number   = 0;
+    bool        valid    = false;
+
+    if (name == "deferred" && arg.empty()) {
+      options.defer_accept = 1;
+      valid                = true;
+    } else if (!arg.empty() && parseListenSize(arg, number)) {
+      valid = true;
+      if (name == "backlog") {
+        // listen() tomaría 0 como el mínimo del kernel: se exige al menos 1
+        valid           = number > 0;
+        options.backlog = number;
+      } else if (name == "deferred")
+        options.defer_accept = number;
+      else if (name == "fastopen")
+        options.fastopen = number;
+      else if (name == "rcvbuf")
+        options.rcvbuf = number;
+      else if (name == "sndbuf")
+        options.sndbuf = number;
+      else
+        valid = false;
+    }
+    if (!valid) {
+      LOG_ERROR("Invalid listen option: " << option);
       return false;
     }
-    return validateAndSetPort(value);
   }
+  _servers.back().setListenOptions(options);
+  return true;
+}
+/**
+ * @brief Parse a non-negative number with an optional K or M suffix
+ * @param value The value to parse
+ * @param number The parsed value
+ * @return True if the value was valid and fits in an int, false otherwise
+ */
+bool ConfigurationManager::parseListenSize(const std::string &value, int &number) {
+  std::string digits     = value;
+  int         multiplier = 1;
+  char        suffix     = value[value.length() - 1];
+
+  if (suffix == 'k' || suffix == 'K') {
+    multiplier = 1024;
+  } else if (suffix == 'm' || suffix == 'M') {
+    multiplier = 1024 * 1024;
+  }
+  if (multiplier != 1) {
+    digits.erase(digits.length() - 1);
+  }
+  if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos || digits.length() > 9) {
+    return false;
+  }
+  // Se acota antes de multiplicar: con el sufijo el producto no cabría en un int
+  long parsed = std::strtol(digits.c_str(), NULL, 10);
+  if (parsed > INT_MAX / multiplier) {
+    return false;
+  }
+  number = static_cast<int>(parsed * multiplier);
+  return true;
 }
 /**
  * @brief Validate and set the port
@@ -586,6 +740,181 @@ int ConfigurationManager::get_keep_alive_timeout() {
   return atoi(_configMap["keep_alive_timeout"].c_str());
 }
 
+/**
+ * @brief Number of worker processes to run (`workers` directive).
+ *
+ * @return The configured value, or 1 when it is missing or invalid.
+ */
+int ConfigurationManager::get_workers() {
+  int workers = atoi(_configMap["workers"].c_str());
+  return workers > 0 ? workers : 1;
+}
+
+/**
+ * @brief Seconds allowed to receive the request headers (`client_header_timeout`).
+ *
+ * @return The configured value, or 60 when it is missing or invalid.
+ */
+int ConfigurationManager::get_client_header_timeout() {
+  int timeout = atoi(_configMap["client_header_timeout"].c_str());
+  return timeout > 0 ? timeout : 60;
+}
+
+/**
+ * @brief Seconds allowed between two reads of the request body (`client_body_timeout`).
+ *
+ * @return The configured value, or 60 when it is missing or invalid.
+ */
+int ConfigurationManager::get_client_body_timeout() {
+  int timeout = atoi(_configMap["client_body_timeout"].c_str());
+  return timeout > 0 ? timeout : 60;
+}
+
+/**
+ * @brief Paths kept by the open file cache of each worker (`open_file_cache`).
+ *
+ * @return The configured value, 1000 when it is missing; 0 disables the cache.
+ */
+int ConfigurationManager::get_open_file_cache() {
+  if (_configMap["open_file_cache"].empty())
+    return 1000;
+  int entries = atoi(_configMap["open_file_cache"].c_str());
+  return entries > 0 ? entries : 0;
+}
+
+/**
+ * @brief Seconds an open file cache entry is trusted (`open_file_cache_valid`).
+ *
+ * @return The configured value, or 60 when it is missing or invalid.
+ */
+int ConfigurationManager::get_open_file_cache_valid() {
+  int valid = atoi(_configMap["open_file_cache_valid"].c_str());
+  return valid > 0 ? valid : 60;
+}
+
+/**
+ * @brief Memory budget in bytes of the response cache of each worker (`response_cache`).
+ *
+ * @return The configured value, 8 MiB when it is missing; 0 disables the cache.
+ */
+size_t ConfigurationManager::get_response_cache() {
+  if (_configMap["response_cache"].empty())
+    return 8 * 1024 * 1024;
+  long budget = atol(_configMap["response_cache"].c_str());
+  return budget > 0 ? budget : 0;
+}
+
+/**
+ * @brief Largest file in bytes kept in the response cache (`response_cache_max_file`).
+ *
+ * @return The configured value, or 64 KiB when it is missing or invalid.
+ */
+size_t ConfigurationManager::get_response_cache_max_file() {
+  long max_file = atol(_configMap["response_cache_max_file"].c_str());
+  return max_file > 0 ? max_file : 64 * 1024;
+}
+
+/**
+ * @brief Queueing delay in ms tolerated for new connections (`admission_target`).
+ *
+ * @return The configured value, or 50 when it is missing or invalid.
+ */
+int ConfigurationManager::get_admission_target() {
+  int target = atoi(_configMap["admission_target"].c_str());
+  return target > 0 ? target : 50;
+}
+
+/**
+ * @brief Time in ms the queueing delay has to stay above the target before
+ *        connections are shed (`admission_interval`).
+ *
+ * @return The configured value, or 500 when it is missing or invalid.
+ */
+int ConfigurationManager::get_admission_interval() {
+  int interval = atoi(_configMap["admission_interval"].c_str());
+  return interval > 0 ? interval : 500;
+}
+
+/**
+ * @brief Whether workers log through the background writer (`log_async on`).
+ */
+bool ConfigurationManager::get_log_async() {
+  std::string value = _configMap["log_async"];
+  return value == "on" || value == "ON";
+}
+
+/**
+ * @brief Bytes of the asynchronous log buffer of each worker (`log_buffer`).
+ *
+ * @return The configured value, or 1 MiB when it is missing or invalid.
+ */
+size_t ConfigurationManager::get_log_buffer() {
+  long size = atol(_configMap["log_buffer"].c_str());
+  return size > 0 ? size : 1024 * 1024;
+}
+
+/**
+ * @brief What to do when the asynchronous log buffer is full (`log_overflow`).
+ *
+ * @return "block" to wait for the writer, "drop" (the default) to discard
+ *         the message and count it.
+ */
+std::string ConfigurationManager::get_log_overflow() {
+  return _configMap["log_overflow"] == "block" ? "block" : "drop";
+}
+
+/**
+ * @brief Path of the access log (`access_log`).
+ *
+ * @return The configured path, or an empty string when it is missing or `off`.
+ */
+std::string ConfigurationManager::get_access_log() {
+  std::string path = _configMap["access_log"];
+  return path == "off" ? "" : path;
+}
+
+/**
+ * @brief Line format of the access log (`access_log_format`).
+ *
+ * @return "json", or "combined" (the default).
+ */
+std::string ConfigurationManager::get_access_log_format() {
+  return _configMap["access_log_format"] == "json" ? "json" : "combined";
+}
+
+/**
+ * @brief Bytes of access log lines each worker gathers before handing them
+ *        to its writer (`access_log_buffer`).
+ *
+ * @return The configured value, or 64 KiB when it is missing or invalid.
+ */
+size_t ConfigurationManager::get_access_log_buffer() {
+  long size = atol(_configMap["access_log_buffer"].c_str());
+  return size > 0 ? size : 64 * 1024;
+}
+
+/**
+ * @brief Longest time in ms an access log line waits in the buffer
+ *        (`access_log_flush`).
+ *
+ * @return The configured value, or 1000 when it is missing or invalid.
+ */
+int ConfigurationManager::get_access_log_flush() {
+  int flush = atoi(_configMap["access_log_flush"].c_str());
+  return flush > 0 ? flush : 1000;
+}
+
+/**
+ * @brief Size in bytes at which the access log is rotated
+ *        (`access_log_rotate_size`).
+ *
+ * @return The configured value, or 0 (no rotation by size).
+ */
+size_t ConfigurationManager::get_access_log_rotate_size() {
+  long size = atol(_configMap["access_log_rotate_size"].c_str());
+  return size > 0 ? size : 0;
+}
+
 std::string ConfigurationManager::get_debug_file() {
   return _configMap["debug_file"];
 }
@@ -594,12 +923,15 @@ int ConfigurationManager::get_serverCount() {
   return _servers.size();
 }
 
-std::vector<Server> ConfigurationManager::get_servers() {
+const std::vector<Server> &ConfigurationManager::get_servers() const {
   return _servers;
 }
 std::string ConfigurationManager::get_log_level() {
   return _configMap["log_level"];
 }
+std::string ConfigurationManager::get_event_engine() {
+  return _configMap["event_engine"];
+}
 //------------------------------------------------------------------------------
 //                                SETTERS
 //------------------------------------------------------------------------------
@@ -669,7 +1001,12 @@ int ConfigurationManager::getDepth(const std::string &line) const {
  * @return True if the token is a global configuration token, false otherwise
  */
 bool ConfigurationManager::isGlobalConfigToken(const std::string &token) {
-  static const char *validTokens[] = {"server", "debug_file", "log_level", "max_clients", "keep_alive_timeout", NULL};
+  static const char *validTokens[] = {
+      "server", "debug_file", "log_level", "max_clients", "keep_alive_timeout", "event_engine",
+      "workers", "client_header_timeout", "client_body_timeout", "open_file_cache", "open_file_cache_valid",
+      "response_cache", "response_cache_max_file", "admission_target", "admission_interval",
+      "log_async", "log_buffer", "log_overflow", "access_log", "access_log_format", "access_log_buffer",
+      "access_log_flush", "access_log_rotate_size", NULL};
 
   for (int i = 0; validTokens[i] != NULL; ++i) {
     if (token == validTokens[i]) {
@@ -680,65 +1017,23 @@ bool ConfigurationManager::isGlobalConfigToken(const std::string &token) {
 }
 /**
  * @brief Get the server
- * @param hostname The hostname to get the server
+ *
+ * The longest location prefix among the blocks of the port that have the
+ * hostname as server_name; the first block of the port if none matches.
+ *
+ * @param hostname The hostname to get the server, hostname_length bytes
  * @param server_port The server port
- * @param request_path The request path
+ * @param request_path The request path, request_path_length bytes
  * @return The server
  */
-
-Server *ConfigurationManager::get_server(const std::string &hostname, int server_port, std::string request_path) {
-  LOG_DEBUG("Searching for server: hostname=" << hostname << ", port=" << server_port << ", path=" << request_path);
-
-  Server     *exactMatch = NULL;
-  Server     *portMatch  = NULL;
-  Server     *bestMatch  = NULL;
-  std::string bestMatchPath;
-
-  for (std::vector<Server>::iterator it = _servers.begin(); it != _servers.end(); ++it) {
-    LOG_DEBUG("Checking server: hostname=" << (it->getServerNames().empty() ? "N/A" : it->getServerNames()[0])
-                                          << ", port=" << it->getListen() << ", location=" << it->getLocationPath());
-
-    if (it->getListen() == server_port) {
-      if (portMatch == NULL) {
-        portMatch = &(*it);
-        LOG_DEBUG("Port match found");
-      }
-
-      if (it->matchServerName(hostname)) {
-        std::string locationPath = it->getLocationPath();
-
-        if (locationPath == request_path) {
-          LOG_DEBUG("Exact match found for path: " << request_path);
-          exactMatch = &(*it);
-          break; // end the search
-        }
-
-        // Buscar la mejor coincidencia parcial
-        if (request_path.compare(0, locationPath.length(), locationPath) == 0) {
-          if (bestMatch == NULL || locationPath.length() > bestMatchPath.length()) {
-            bestMatch     = &(*it);
-            bestMatchPath = locationPath;
-            LOG_DEBUG("Better match found: " << locationPath);
-          }
-        }
-      }
-    } else {
-      LOG_DEBUG("Port mismatch, skipping");
-    }
-  }
-
-  // Priorizar la selección del servidor
-  if (exactMatch != NULL) {
-    LOG_DEBUG("Returning exact match");
-    return exactMatch;
-  }
-  if (bestMatch != NULL) {
-    LOG_DEBUG("Returning best partial match");
-    return bestMatch;
-  }
-  if (portMatch != NULL) {
-    LOG_DEBUG("Returning port match");
-    return portMatch;
+Server *ConfigurationManager::get_server(const char *hostname,
+                                         size_t      hostname_length,
+                                         int         server_port,
+                                         const char *request_path,
+                                         size_t      request_path_length) {
+  int index = _routes.find(hostname, hostname_length, server_port, request_path, request_path_length);
+  if (index >= 0) {
+    return &_servers[index];
   }
 
   LOG_WARNING("No matching server found for request");
@@ -752,6 +1047,33 @@ Server *ConfigurationManager::get_server(const std::string &hostname, int server
   return NULL;
 }
 
+/**
+ * @brief The compiled location that serves a request.
+ *
+ * @return The location of the matching Server; an empty location if there
+ *         are no servers.
+ */
+const LocationConfig &ConfigurationManager::get_location(const char *hostname,
+                                                         size_t      hostname_length,
+                                                         int         server_port,
+                                                         const char *request_path,
+                                                         size_t      request_path_length) {
+  return get_location(get_server(hostname, hostname_length, server_port, request_path, request_path_length));
+}
+
+/**
+ * @brief The compiled location of one of the servers returned by
+ *        get_server().
+ */
+const LocationConfig &ConfigurationManager::get_location(const Server *server) const {
+  static const LocationConfig none;
+
+  if (server == NULL || _servers.empty() || server < &_servers[0] || server >= &_servers[0] + _locations.size()) {
+    return none;
+  }
+  return _locations[server - &_servers[0]];
+}
+
 //------------------------------------------------------------------------------
 //                               OPERATORS
 //------------------------------------------------------------------------------
@@ -761,9 +1083,27 @@ std::ostream &operator<<(std::ostream &o, ConfigurationManager &i) {
 
   LOG_INFO(spaces << "max_clients:\t\t" << i.get_max_clients());
   LOG_INFO(spaces << "keep_alive_timeout:\t" << i.get_keep_alive_timeout());
+  LOG_INFO(spaces << "workers:\t\t" << i.get_workers());
+  LOG_INFO(spaces << "client_header_timeout:\t" << i.get_client_header_timeout());
+  LOG_INFO(spaces << "client_body_timeout:\t" << i.get_client_body_timeout());
+  LOG_INFO(spaces << "open_file_cache:\t" << i.get_open_file_cache());
+  LOG_INFO(spaces << "open_file_cache_valid:\t" << i.get_open_file_cache_valid());
+  LOG_INFO(spaces << "response_cache:\t\t" << i.get_response_cache());
+  LOG_INFO(spaces << "response_cache_max_file:\t" << i.get_response_cache_max_file());
+  LOG_INFO(spaces << "admission_target:\t" << i.get_admission_target());
+  LOG_INFO(spaces << "admission_interval:\t" << i.get_admission_interval());
   LOG_INFO("debug_file:\t\t" << i.get_debug_file());
   LOG_INFO("log_level:\t\t" << i.get_log_level());
-  std::vector<Server> servers = i.get_servers();
+  LOG_INFO("log_async:\t\t" << (i.get_log_async() ? "on" : "off"));
+  LOG_INFO("log_buffer:\t\t" << i.get_log_buffer());
+  LOG_INFO("log_overflow:\t\t" << i.get_log_overflow());
+  LOG_INFO("access_log:\t\t" << (i.get_access_log().empty() ? "off" : i.get_access_log()));
+  LOG_INFO("access_log_format:\t" << i.get_access_log_format());
+  LOG_INFO("access_log_buffer:\t" << i.get_access_log_buffer());
+  LOG_INFO("access_log_flush:\t" << i.get_access_log_flush());
+  LOG_INFO("access_log_rotate_size:\t" << i.get_access_log_rotate_size());
+  LOG_INFO("event_engine:\t\t" << (i.get_event_engine().empty() ? "default" : i.get_event_engine()));
+  const std::vector<Server> &servers = i.get_servers();
   for (std::vector<Server>::const_iterator it = servers.begin(); it != servers.end(); ++it) {
     o << *it;
   }
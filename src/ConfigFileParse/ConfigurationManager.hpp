@@ -14,12 +14,15 @@
 #define CONFIGURATIONMANAGER_HPP
 
 //------------------------------------------------------------------------------
+#include "CommonDefinitions.hpp"
 #include "Logger/includes/Logger.hpp"
+#include "RouteTable/RouteTable.hpp"
 #include "Server/Server.hpp"
 //------------------------------------------------------------------------------
 #include <arpa/inet.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -33,15 +36,35 @@ class ConfigurationManager {
  private:
   std::map<std::string, std::string> _configMap;
   std::vector<Server>                _servers;
+  std::vector<LocationConfig>        _locations; // Una por cada Server, en el mismo orden
+  RouteTable                         _routes;
 
   //------------------------GETTERS---------------------------------------------
  public:
   int                 get_max_clients();
   int                 get_keep_alive_timeout();
-  int                 get_serverCount();
-  std::string         get_log_level();
-  std::string         get_debug_file();
-  std::vector<Server> get_servers();
+  int                 get_workers();
+  int                 get_client_header_timeout();
+  int                 get_client_body_timeout();
+  int                 get_open_file_cache();
+  int                 get_open_file_cache_valid();
+  size_t              get_response_cache();
+  size_t              get_response_cache_max_file();
+  int                 get_admission_target();
+  int                 get_admission_interval();
+  int                        get_serverCount();
+  std::string                get_log_level();
+  bool                       get_log_async();
+  size_t                     get_log_buffer();
+  std::string                get_log_overflow();
+  std::string                get_access_log();
+  std::string                get_access_log_format();
+  size_t                     get_access_log_buffer();
+  int                        get_access_log_flush();
+  size_t                     get_access_log_rotate_size();
+  std::string                get_debug_file();
+  std::string                get_event_engine();
+  const std::vector<Server> &get_servers() const;
 
   //------------------------SETTERS---------------------------------------------
   void set_max_clients(std::string max_clients);
@@ -57,12 +80,15 @@ class ConfigurationManager {
   bool parseConfig(std::istringstream &iss, std::string &token, int depth);
   bool parseServerConfig(std::istringstream &iss, std::string &token, int depth);
   bool parseListen(const std::string &value);
+  bool parseListenOptions(std::istringstream &iss);
+  bool parseListenSize(const std::string &value, int &number);
   bool parseServerName(const std::string &value);
   bool parseRootPath(const std::string &value);
   bool parseIndex(const std::string &value);
   bool parseErrorPage(const std::string &value);
   bool parseClientMaxBodySize(const std::string &value);
   bool parseAutoindex(const std::string &value);
+  bool parseSendfile(const std::string &value);
   bool parseCgiExt(const std::string &value);
   bool parseUploadPath(const std::string &value);
   bool parseReturn(const std::string &value);
@@ -74,9 +100,21 @@ class ConfigurationManager {
   bool        isGlobalConfigToken(const std::string &token);
   bool        isValidLocationPath(const std::string &path);
   std::string trim(const std::string &line) const;
-  Server     *get_server(const std::string &hostname,
-                         int                server_port,
-                         std::string        request_path);
+  Server     *get_server(const char *hostname,
+                         size_t      hostname_length,
+                         int         server_port,
+                         const char *request_path,
+                         size_t      request_path_length);
+
+  const LocationConfig &get_location(const char *hostname,
+                                     size_t      hostname_length,
+                                     int         server_port,
+                                     const char *request_path,
+                                     size_t      request_path_length);
+  const LocationConfig &get_location(const Server *server) const;
+
+ private:
+  void compileLocations();
 };
 
 std::ostream &operator<<(std::ostream &o, ConfigurationManager &i);
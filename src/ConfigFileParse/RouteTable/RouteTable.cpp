@@ -0,0 +1,234 @@
+#include "RouteTable.hpp"
+
+RouteTable::RouteTable() {}
+
+RouteTable::~RouteTable() {
+  clear();
+}
+
+/**
+ * @brief Compiles the routes of the parsed servers.
+ *
+ * @param servers Server entries in configuration order; find() returns
+ *                indexes into this vector.
+ */
+void RouteTable::build(const std::vector<Server> &servers) {
+  clear();
+
+  // Índice temporal de nombres mientras se construye cada puerto
+  std::map<int, std::map<std::string, Host *> > names;
+
+  for (size_t i = 0; i < servers.size(); ++i) {
+    const Server &server = servers[i];
+    int           entry  = static_cast<int>(i);
+
+    PortMap::iterator port = _ports.find(server.getListen());
+    if (port == _ports.end()) {
+      port               = _ports.insert(std::make_pair(server.getListen(), Port())).first;
+      port->second.first = entry;
+    }
+
+    std::map<std::string, Host *>  &hosts       = names[server.getListen()];
+    const std::vector<std::string> &serverNames = server.getServerNames();
+    for (std::vector<std::string>::const_iterator it = serverNames.begin(); it != serverNames.end(); ++it) {
+      Host *&host = hosts[*it];
+      if (host == NULL) {
+        host       = new Host();
+        host->name = *it;
+        host->hash = hashName(it->data(), it->size());
+        host->root = new Node("", -1);
+        port->second.hosts.push_back(host);
+      }
+      insert(host->root, server.getLocationPath(), entry);
+    }
+  }
+
+  for (PortMap::iterator it = _ports.begin(); it != _ports.end(); ++it) {
+    buildBuckets(it->second);
+  }
+}
+
+/**
+ * @brief The server entry that serves a request.
+ *
+ * Names and path are taken as pointer and length so the request strings,
+ * which live in its RequestArena, are matched in place.
+ *
+ * @param hostname Host header without the port.
+ * @return Index of the entry, -1 if no server listens on the port.
+ */
+int RouteTable::find(const char *hostname, size_t hostname_length, int port, const char *path, size_t path_length)
+    const {
+  PortMap::const_iterator it = _ports.find(port);
+  if (it == _ports.end()) {
+    return -1;
+  }
+
+  const Host *host = findHost(it->second, hostname, hostname_length);
+  if (host != NULL) {
+    int entry = longestPrefix(host->root, path, path_length);
+    if (entry >= 0) {
+      return entry;
+    }
+  }
+  return it->second.first;
+}
+
+void RouteTable::clear() {
+  for (PortMap::iterator it = _ports.begin(); it != _ports.end(); ++it) {
+    for (size_t i = 0; i < it->second.hosts.size(); ++i) {
+      destroy(it->second.hosts[i]->root);
+      delete it->second.hosts[i];
+    }
+  }
+  _ports.clear();
+}
+
+/**
+ * @brief FNV-1a hash of a server name.
+ */
+unsigned long RouteTable::hashName(const char *name, size_t length) {
+  unsigned long hash = 2166136261UL;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(name[i]);
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+/**
+ * @brief Sizes the name table to at most half full and fills it.
+ */
+void RouteTable::buildBuckets(Port &port) {
+  size_t size = 1;
+  while (size < port.hosts.size() * 2) {
+    size <<= 1;
+  }
+  port.buckets.assign(size, NULL);
+
+  size_t mask = size - 1;
+  for (size_t i = 0; i < port.hosts.size(); ++i) {
+    size_t slot = port.hosts[i]->hash & mask;
+    while (port.buckets[slot] != NULL) {
+      slot = (slot + 1) & mask;
+    }
+    port.buckets[slot] = port.hosts[i];
+  }
+}
+
+RouteTable::Host *RouteTable::findHost(const Port &port, const char *name, size_t length) {
+  if (port.buckets.empty()) {
+    return NULL;
+  }
+  unsigned long hash = hashName(name, length);
+  size_t        mask = port.buckets.size() - 1;
+  for (size_t slot = hash & mask; port.buckets[slot] != NULL; slot = (slot + 1) & mask) {
+    Host *host = port.buckets[slot];
+    if (host->hash == hash && host->name.compare(0, std::string::npos, name, length) == 0) {
+      return host;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief The child whose label starts with c, by binary search.
+ */
+RouteTable::Node *RouteTable::findChild(const Node *node, char c) {
+  size_t low  = 0;
+  size_t high = node->children.size();
+  while (low < high) {
+    size_t mid   = (low + high) / 2;
+    char   first = node->children[mid]->label[0];
+    if (first == c) {
+      return node->children[mid];
+    }
+    if (static_cast<unsigned char>(first) < static_cast<unsigned char>(c)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Adds a location path, splitting the edge where it diverges.
+ *
+ * A path that is already present keeps its first entry, as the first
+ * matching block in the file is the one that serves it.
+ */
+void RouteTable::insert(Node *root, const std::string &path, int entry) {
+  Node  *node = root;
+  size_t pos  = 0;
+
+  while (pos < path.size()) {
+    Node *child = findChild(node, path[pos]);
+    if (child == NULL) {
+      Node *leaf = new Node(path.substr(pos), entry);
+      size_t at  = 0;
+      while (at < node->children.size() &&
+             static_cast<unsigned char>(node->children[at]->label[0]) < static_cast<unsigned char>(path[pos])) {
+        ++at;
+      }
+      node->children.insert(node->children.begin() + at, leaf);
+      return;
+    }
+
+    size_t common = 0;
+    while (common < child->label.size() && pos + common < path.size() && child->label[common] == path[pos + common]) {
+      ++common;
+    }
+    if (common < child->label.size()) {
+      // La ruta se separa a mitad de la etiqueta: nodo intermedio
+      Node *split = new Node(child->label.substr(0, common), -1);
+      child->label.erase(0, common);
+      split->children.push_back(child);
+      for (size_t i = 0; i < node->children.size(); ++i) {
+        if (node->children[i] == child) {
+          node->children[i] = split;
+          break;
+        }
+      }
+      child = split;
+    }
+    node = child;
+    pos += common;
+  }
+
+  if (node->entry < 0) {
+    node->entry = entry;
+  }
+}
+
+/**
+ * @brief Entry of the longest location path that is a prefix of path.
+ *
+ * @return -1 if none is.
+ */
+int RouteTable::longestPrefix(const Node *root, const char *path, size_t length) {
+  const Node *node = root;
+  size_t      pos  = 0;
+  int         best = root->entry;
+
+  while (pos < length) {
+    const Node *child = findChild(node, path[pos]);
+    if (child == NULL || child->label.size() > length - pos ||
+        child->label.compare(0, child->label.size(), path + pos, child->label.size()) != 0) {
+      break;
+    }
+    pos += child->label.size();
+    node = child;
+    if (node->entry >= 0) {
+      best = node->entry;
+    }
+  }
+  return best;
+}
+
+void RouteTable::destroy(Node *node) {
+  for (size_t i = 0; i < node->children.size(); ++i) {
+    destroy(node->children[i]);
+  }
+  delete node;
+}
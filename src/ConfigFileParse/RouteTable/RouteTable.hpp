@@ -0,0 +1,70 @@
+#ifndef ROUTE_TABLE_HPP
+#define ROUTE_TABLE_HPP
+
+//------------------------------------------------------------------------------
+#include "ConfigFileParse/Server/Server.hpp"
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// RouteTable: compiled lookup of the Server entry that serves a request
+//
+// Built once from the parsed servers. Each listening port keeps a hash
+// table of its server names, and each name a radix tree with the location
+// paths of its entries, so a lookup costs one hash of the Host name plus a
+// walk of the request path, whatever the number of servers and locations.
+//
+// The result is the one the linear scan used to give: the entry whose
+// location path is the longest prefix of the request path (an exact match
+// being the longest one), the first in configuration order on ties; the
+// first entry on the port if no name or location matches.
+class RouteTable {
+ public:
+  RouteTable();
+  ~RouteTable();
+
+  void build(const std::vector<Server> &servers);
+  int  find(const char *hostname, size_t hostname_length, int port, const char *path, size_t path_length) const;
+  void clear();
+
+ private:
+  // Nodo del árbol radix: la etiqueta es el tramo de ruta desde el padre
+  struct Node {
+    std::string         label;
+    int                 entry; // Índice del Server, -1 si ninguna location acaba aquí
+    std::vector<Node *> children; // Ordenados por el primer byte de la etiqueta
+
+    Node(const std::string &label, int entry) : label(label), entry(entry) {}
+  };
+
+  struct Host {
+    std::string   name;
+    unsigned long hash;
+    Node         *root;
+  };
+
+  struct Port {
+    int                 first; // Primer Server del puerto, el de reserva
+    std::vector<Host *> hosts;
+    std::vector<Host *> buckets; // Potencia de dos; direccionamiento abierto
+  };
+
+  typedef std::map<int, Port> PortMap;
+
+  PortMap _ports;
+
+  static unsigned long hashName(const char *name, size_t length);
+  static Node         *findChild(const Node *node, char c);
+  static void          insert(Node *root, const std::string &path, int entry);
+  static int           longestPrefix(const Node *root, const char *path, size_t length);
+  static void          destroy(Node *node);
+  static void          buildBuckets(Port &port);
+  static Host         *findHost(const Port &port, const char *name, size_t length);
+
+  RouteTable(const RouteTable &);
+  RouteTable &operator=(const RouteTable &);
+};
+
+#endif // ROUTE_TABLE_HPP
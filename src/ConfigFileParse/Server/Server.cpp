@@ -21,6 +21,7 @@ Server::Server() : _type(0) {
   addAllowedMethod("POST");
   addAllowedMethod("DELETE");
   _autoindex = false;
+  _sendfile  = true;
   setClientMaxBodySize(1000001);
 }
 
@@ -53,6 +54,9 @@ void Server::setClientMaxBodySize(unsigned int size) {
 void Server::setAutoindex(bool autoindex) {
   _autoindex = autoindex;
 }
+void Server::setSendfile(bool sendfile) {
+  _sendfile = sendfile;
+}
 void Server::setCgiHandler(const std::string &extension, const std::string &path) {
   _cgi_handler[extension] = path;
 }
@@ -66,6 +70,9 @@ void Server::setReturnCodePath(const int code, const std::string path) {
 void Server::setListen(int port) {
   _listen = port;
 }
+void Server::setListenOptions(const ListenOptions &options) {
+  _listen_options = options;
+}
 void Server::setLocationPath(const std::string &locationPath) {
   _locationPath = locationPath;
 }
@@ -80,25 +87,28 @@ void Server::addAllowedMethod(const std::string &method) {
 //                                 GETTERS
 //------------------------------------------------------------------------------
 
-std::string Server::getIP() const {
+const std::string &Server::getIP() const {
   return _ip;
 }
-std::string Server::getIp() const {
+const std::string &Server::getIp() const {
   return _ip;
 }
-std::vector<std::string> Server::getServerNames() const {
+const std::vector<std::string> &Server::getServerNames() const {
   return _server_names;
 }
 int Server::getListen() const {
   return _listen;
 }
-std::string Server::getRootPath() const {
+const ListenOptions &Server::getListenOptions() const {
+  return _listen_options;
+}
+const std::string &Server::getRootPath() const {
   return _root_path;
 }
-std::vector<std::string> Server::getIndex() const {
+const std::vector<std::string> &Server::getIndex() const {
   return _index;
 }
-std::map<int, std::string> Server::getErrorPages() const {
+const std::map<int, std::string> &Server::getErrorPages() const {
   return _error_pages;
 }
 int Server::getType() const {
@@ -110,13 +120,16 @@ unsigned int Server::getClientMaxBodySize() const {
 bool Server::getAutoindex() const {
   return _autoindex;
 }
-std::map<std::string, std::string> Server::getCgiHandler() const {
+bool Server::getSendfile() const {
+  return _sendfile;
+}
+const std::map<std::string, std::string> &Server::getCgiHandler() const {
   return _cgi_handler;
 }
-std::string Server::getUploadPath() const {
+const std::string &Server::getUploadPath() const {
   return _upload_path;
 }
-std::map<short int, std::string> Server::getReturnCodePath() const {
+const std::map<short int, std::string> &Server::getReturnCodePath() const {
   return _return_code_path;
 }
 /* @brief: check if the server name is in the server names vector
@@ -131,14 +144,14 @@ bool Server::matchServerName(const std::string &hostname) const {
   }
   return false;
 }
-std::string Server::getLocationPath() const {
+const std::string &Server::getLocationPath() const {
   return _locationPath;
 }
 
-std::vector<std::string> Server::getAllowedMethods() const {
+const std::vector<std::string> &Server::getAllowedMethods() const {
   return _allowed_methods;
 }
-std::map<std::string, std::string> Server::getLocationCgiHandler() const {
+const std::map<std::string, std::string> &Server::getLocationCgiHandler() const {
   return _cgi_handler;
 }
 
@@ -173,12 +186,21 @@ std::ostream &operator<<(std::ostream &o, const Server &i) {
   spaces += (i.getType() == 0 ? "" : "\t");
   LOG_INFO(spaces << "Listen:\t\t" << i.getListen());
   LOG_INFO(spaces << "Ip:\t\t" << i.getIp());
+  if (i.getType() == 0) {
+    const ListenOptions &options = i.getListenOptions();
+    LOG_INFO(spaces << "Backlog:\t" << options.backlog);
+    LOG_INFO(spaces << "Deferred:\t" << options.defer_accept);
+    LOG_INFO(spaces << "Fastopen:\t" << options.fastopen);
+    LOG_INFO(spaces << "Rcvbuf:\t\t" << options.rcvbuf);
+    LOG_INFO(spaces << "Sndbuf:\t\t" << options.sndbuf);
+  }
   LOG_INFO(spaces << "Server_names:\t" << joinStrings(i.getServerNames(), " "));
   LOG_INFO(spaces << "Methods:\t" << joinStrings(i.getAllowedMethods(), " "));
   LOG_INFO(spaces << "Root_path:\t" << i.getRootPath());
   LOG_INFO(spaces << "Index:\t\t" << joinStrings(i.getIndex(), " "));
   LOG_INFO(spaces << "Max_body_size:\t" << i.getClientMaxBodySize());
   LOG_INFO(spaces << "Autoindex:\t" << (i.getAutoindex() ? "ON" : "OFF"));
+  LOG_INFO(spaces << "Sendfile:\t" << (i.getSendfile() ? "ON" : "OFF"));
   LOG_INFO(spaces << "Upload_path:\t" << (i.getUploadPath().empty() ? "No upload path" : i.getUploadPath()));
   printMap(spaces, "Error_pages", i.getErrorPages());
   printMap(spaces, "Cgi_handler", i.getCgiHandler());
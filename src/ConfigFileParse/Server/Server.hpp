@@ -19,6 +19,17 @@
 #include <vector>
 #include "Logger/includes/Logger.hpp"
 
+// Options of a listening socket, set on the listen directive
+struct ListenOptions {
+  int backlog;      // Cola de conexiones completadas pendientes de accept
+  int defer_accept; // Segundos de TCP_DEFER_ACCEPT, 0 desactivado
+  int fastopen;     // Cola de TCP_FASTOPEN, 0 desactivado
+  int rcvbuf;       // SO_RCVBUF en bytes, 0 el del sistema
+  int sndbuf;       // SO_SNDBUF en bytes, 0 el del sistema
+
+  ListenOptions() : backlog(511), defer_accept(0), fastopen(0), rcvbuf(0), sndbuf(0) {}
+};
+
 class Server {
   //------------------------CONSTRUCTOR--------------------------------------
  public:
@@ -27,23 +38,25 @@ class Server {
 
   //------------------------GETTERS------------------------------------------
  public:
-  bool                               getAutoindex() const;
-  unsigned int                       getClientMaxBodySize() const;
-  int                                getListen() const;
-  int                                getType() const;
-  std::string                        getName() const;
-  std::string                        getIP() const;
-  std::string                        getRootPath() const;
-  std::string                        getUploadPath() const;
-  std::string                        getIp() const;
-  std::string                        getLocationPath() const;
-  std::vector<std::string>           getIndex() const;
-  std::vector<std::string>           getAllowedMethods() const;
-  std::vector<std::string>           getServerNames() const;
-  std::map<std::string, std::string> getCgiHandler() const;
-  std::map<short int, std::string>   getReturnCodePath() const;
-  std::map<int, std::string>         getErrorPages() const;
-  std::map<std::string, std::string> getLocationCgiHandler() const;
+  bool                                      getAutoindex() const;
+  bool                                      getSendfile() const;
+  unsigned int                              getClientMaxBodySize() const;
+  int                                       getListen() const;
+  const ListenOptions                      &getListenOptions() const;
+  int                                       getType() const;
+  std::string                               getName() const;
+  const std::string                        &getIP() const;
+  const std::string                        &getRootPath() const;
+  const std::string                        &getUploadPath() const;
+  const std::string                        &getIp() const;
+  const std::string                        &getLocationPath() const;
+  const std::vector<std::string>           &getIndex() const;
+  const std::vector<std::string>           &getAllowedMethods() const;
+  const std::vector<std::string>           &getServerNames() const;
+  const std::map<std::string, std::string> &getCgiHandler() const;
+  const std::map<short int, std::string>   &getReturnCodePath() const;
+  const std::map<int, std::string>         &getErrorPages() const;
+  const std::map<std::string, std::string> &getLocationCgiHandler() const;
 
   //------------------------MATCHERS------------------------------------------
  public:
@@ -60,10 +73,12 @@ class Server {
   void setType(int type);
   void setClientMaxBodySize(unsigned int size);
   void setAutoindex(bool autoindex);
+  void setSendfile(bool sendfile);
   void setCgiHandler(const std::string &extension, const std::string &path);
   void setUploadPath(const std::string &uploadPath);
   void setReturnCodePath(const int code, const std::string path);
   void setListen(int port);
+  void setListenOptions(const ListenOptions &options);
   void setLocationPath(const std::string &locationPath);
   void addAllowedMethod(const std::string &method);
   void clearAllowedMethods();
@@ -71,8 +86,10 @@ class Server {
   //------------------------ATTRIBUTES----------------------------------------
  private:
   int                                _listen;
+  ListenOptions                      _listen_options;
   int                                _type;
   bool                               _autoindex;
+  bool                               _sendfile;
   unsigned int                       _client_max_body_size;
   std::string                        _ip;
   std::string                        _root_path;
@@ -12,32 +12,44 @@
 
 #include "includes/Logger.hpp"
 
+#ifdef WEBSERVER_DEBUG
+__thread int LogFormatting::depth = 0;
+#endif
+
 /**
  * @brief Log a message with a specific log level
  *
+ * In asynchronous mode the message is only queued for the writer thread.
+ *
  * @param level The log level
  * @param messageStream The message to log
  * @param functionName The name of the function where the log is called
  * @param fileName The name of the file where the log is called
  */
 void Logger::log(LogLevel level, const std::ostringstream &messageStream, const char *functionName, const char *fileName) {
+  if (level < m_level) {
+    return;
+  }
+  if (m_async) {
+    pushRecord(level, messageStream.str(), functionName, fileName);
+    return;
+  }
+
   std::string message   = messageStream.str();
   std::string levelStr  = getLevelString(level);
   std::string timestamp = getCurrentTime();
 
-  if (level >= m_level) {
-    if (m_fileLoggingEnabled) {
-      // Format file output
-      std::string fileMessage = formatFileMessage(timestamp, levelStr, message, functionName, fileName);
-
-      writeToFile(fileMessage);
-    }
-    // Format console output
-    std::string consoleMessage = formatConsoleMessage(level, timestamp, levelStr, message);
+  if (m_fileLoggingEnabled) {
+    // Format file output
+    std::string fileMessage = formatFileMessage(timestamp, levelStr, message, functionName, fileName);
 
-    // Output to console based on log level
-    outputToConsole(level, consoleMessage);
+    writeToFile(fileMessage);
   }
+  // Format console output
+  std::string consoleMessage = formatConsoleMessage(level, timestamp, levelStr, message);
+
+  // Output to console based on log level
+  outputToConsole(level, consoleMessage);
 }
 
 /**
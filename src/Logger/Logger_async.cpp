@@ -0,0 +1,257 @@
+#include "includes/Logger.hpp"
+#include "WebServer/Clock/Clock.hpp"
+
+#include <errno.h>
+#include <signal.h>
+#include <algorithm>
+
+// Asynchronous mode: log() copies the message into a single-producer,
+// single-consumer ring buffer together with its level, time and call site,
+// and returns. A background thread drains the ring, formats the records and
+// writes them with one write per destination and batch, so neither the
+// formatting nor the disk and terminal latency are paid by the event loop.
+
+// Espera del hilo de escritura cuando el buffer está vacío
+#define LOG_ASYNC_IDLE_US 5000
+// Espera de quien registra con el buffer lleno y la política block
+#define LOG_ASYNC_BLOCK_US 100
+// Los registros empiezan en múltiplos de 8 bytes
+#define LOG_ASYNC_ALIGN(n) (((n) + 7) & ~static_cast<size_t>(7))
+
+// Cabecera de cada registro del buffer; le sigue el texto del mensaje
+struct Logger::AsyncRecord {
+  size_t         size;  // Bytes del registro con el texto, alineado
+  int            level; // -1: hueco hasta el final del buffer
+  struct timeval time;
+  const char    *function; // Literales de __FUNCTION__ y __FILE__
+  const char    *file;
+  size_t         length;
+};
+
+#define LOG_ASYNC_HEADER LOG_ASYNC_ALIGN(sizeof(Logger::AsyncRecord))
+
+/**
+ * @brief Starts the background writer.
+ *
+ * Must be called in the process that logs (after fork), as the thread is
+ * not inherited by child processes. A child forked later (a CGI) goes back
+ * to synchronous logging.
+ *
+ * @param bufferSize Bytes of the ring buffer, rounded up to a power of two.
+ * @param block With the buffer full, wait for room instead of dropping the
+ *              message; dropped messages are counted and reported.
+ */
+void Logger::startAsync(size_t bufferSize, bool block) {
+  static bool atforkRegistered = false;
+
+  if (m_async) {
+    return;
+  }
+  size_t size = 4096;
+  while (size < bufferSize) {
+    size <<= 1;
+  }
+  m_ring       = new char[size];
+  m_ringSize   = size;
+  m_ringHead   = 0;
+  m_ringTail   = 0;
+  m_dropped    = 0;
+  m_asyncStop  = false;
+  m_asyncBlock = block;
+  std::cout.flush();
+  std::cerr.flush();
+
+  // Las señales las atiende el bucle de eventos, no el hilo de escritura
+  sigset_t all, previous;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &previous);
+  int error = pthread_create(&m_flusher, NULL, &Logger::flusherMain, this);
+  pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+  if (error != 0) {
+    delete[] m_ring;
+    m_ring = NULL;
+    std::ostringstream logMessage;
+    logMessage << "Could not start the log writer thread, logging synchronously: " << strerror(error);
+    log(WARNING, logMessage, __FUNCTION__, __FILE__);
+    return;
+  }
+  if (!atforkRegistered) {
+    pthread_atfork(NULL, NULL, &Logger::afterForkChild);
+    atforkRegistered = true;
+  }
+  m_async = true;
+}
+
+/**
+ * @brief Writes everything pending and stops the background writer.
+ */
+void Logger::stopAsync() {
+  if (!m_async) {
+    return;
+  }
+  m_async = false;
+  __atomic_store_n(&m_asyncStop, true, __ATOMIC_RELEASE);
+  pthread_join(m_flusher, NULL);
+  delete[] m_ring;
+  m_ring = NULL;
+}
+
+/**
+ * @brief Copies a record into the ring buffer.
+ *
+ * Messages that do not fit in half the buffer are truncated.
+ *
+ * @return false if the buffer was full and the record was dropped.
+ */
+bool Logger::pushRecord(LogLevel level, const std::string &message, const char *functionName, const char *fileName) {
+  size_t length = std::min(message.size(), m_ringSize / 2 - LOG_ASYNC_HEADER);
+  size_t size   = LOG_ASYNC_HEADER + LOG_ASYNC_ALIGN(length);
+  size_t offset = m_ringHead & (m_ringSize - 1);
+  size_t toEnd  = m_ringSize - offset;
+  // Un registro no se parte: si no cabe hasta el final, se salta ese hueco
+  size_t needed = size <= toEnd ? size : toEnd + size;
+
+  while (m_ringSize - (m_ringHead - __atomic_load_n(&m_ringTail, __ATOMIC_ACQUIRE)) < needed) {
+    if (!m_asyncBlock) {
+      __atomic_add_fetch(&m_dropped, 1, __ATOMIC_RELAXED);
+      return false;
+    }
+    usleep(LOG_ASYNC_BLOCK_US);
+  }
+
+  if (size > toEnd) {
+    if (toEnd >= LOG_ASYNC_HEADER) {
+      AsyncRecord *gap = reinterpret_cast<AsyncRecord *>(m_ring + offset);
+      gap->size        = toEnd;
+      gap->level       = -1;
+    }
+    offset = 0;
+  }
+  AsyncRecord *record = reinterpret_cast<AsyncRecord *>(m_ring + offset);
+  record->size        = size;
+  record->level       = level;
+  record->function    = functionName;
+  record->file        = fileName;
+  record->length      = length;
+  record->time        = Clock::wallTime();
+  memcpy(m_ring + offset + LOG_ASYNC_HEADER, message.data(), length);
+
+  __atomic_store_n(&m_ringHead, m_ringHead + needed, __ATOMIC_RELEASE);
+  return true;
+}
+
+void *Logger::flusherMain(void *logger) {
+  static_cast<Logger *>(logger)->flushLoop();
+  return NULL;
+}
+
+/**
+ * @brief Body of the background writer: drains the ring until stopped.
+ */
+void Logger::flushLoop() {
+  std::string fileBatch;
+  std::string outBatch;
+  std::string errBatch;
+
+  while (true) {
+    // Se lee antes de vaciar: lo registrado antes de parar se escribe
+    bool stop = __atomic_load_n(&m_asyncStop, __ATOMIC_ACQUIRE);
+    bool any  = drainRing(fileBatch, outBatch, errBatch);
+
+    unsigned long dropped = __atomic_exchange_n(&m_dropped, 0, __ATOMIC_RELAXED);
+    if (dropped > 0) {
+      std::ostringstream message;
+      message << dropped << " log messages dropped, the log buffer was full";
+      struct timeval now;
+      gettimeofday(&now, NULL);
+      std::string timestamp = getCurrentTime(now);
+      std::string levelStr  = getLevelString(WARNING);
+      if (m_fileLoggingEnabled) {
+        fileBatch += formatFileMessage(timestamp, levelStr, message.str(), __FUNCTION__, __FILE__);
+      }
+      outBatch += formatConsoleMessage(WARNING, timestamp, levelStr, message.str());
+      any = true;
+    }
+
+    if (any) {
+      writeBatches(fileBatch, outBatch, errBatch);
+    } else if (stop) {
+      break;
+    } else {
+      usleep(LOG_ASYNC_IDLE_US);
+    }
+  }
+}
+
+/**
+ * @brief Formats every record in the ring into the output batches.
+ *
+ * @return Whether there was any record.
+ */
+bool Logger::drainRing(std::string &fileBatch, std::string &outBatch, std::string &errBatch) {
+  unsigned long head = __atomic_load_n(&m_ringHead, __ATOMIC_ACQUIRE);
+  unsigned long tail = m_ringTail;
+
+  if (tail == head) {
+    return false;
+  }
+  while (tail != head) {
+    size_t offset = tail & (m_ringSize - 1);
+    size_t toEnd  = m_ringSize - offset;
+    if (toEnd < LOG_ASYNC_HEADER) {
+      tail += toEnd;
+      continue;
+    }
+    const AsyncRecord *record = reinterpret_cast<const AsyncRecord *>(m_ring + offset);
+    if (record->level >= 0) {
+      LogLevel    level = static_cast<LogLevel>(record->level);
+      std::string message(m_ring + offset + LOG_ASYNC_HEADER, record->length);
+      std::string timestamp = getCurrentTime(record->time);
+      std::string levelStr  = getLevelString(level);
+
+      if (m_fileLoggingEnabled) {
+        fileBatch += formatFileMessage(timestamp, levelStr, message, record->function, record->file);
+      }
+      (level < ERROR ? outBatch : errBatch) += formatConsoleMessage(level, timestamp, levelStr, message);
+    }
+    tail += record->size;
+  }
+  __atomic_store_n(&m_ringTail, tail, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void writeAll(int fd, const std::string &data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    written += n;
+  }
+}
+
+/**
+ * @brief Writes the batches, one write per destination, and empties them.
+ */
+void Logger::writeBatches(std::string &fileBatch, std::string &outBatch, std::string &errBatch) {
+  if (!fileBatch.empty() && m_file.is_open()) {
+    m_file << fileBatch;
+    m_file.flush();
+  }
+  writeAll(STDOUT_FILENO, outBatch);
+  writeAll(STDERR_FILENO, errBatch);
+  fileBatch.clear();
+  outBatch.clear();
+  errBatch.clear();
+}
+
+/**
+ * @brief The child of a fork has no writer thread: it logs synchronously.
+ */
+void Logger::afterForkChild() {
+  getInstance().m_async = false;
+}
@@ -11,6 +11,7 @@
 /* ************************************************************************** */
 
 #include "includes/Logger.hpp"
+#include "WebServer/Clock/Clock.hpp"
 
 /**
  * @brief Get the color code for a log level
@@ -65,25 +66,36 @@ std::string Logger::getLevelString(LogLevel level) {
 /**
  * @brief Get the current time as a string with milliseconds
  *
+ * The time is the one of the current event loop iteration, or the current
+ * time outside the loop, formatted by the Clock.
+ *
  * @return std::string The current time as a string
  */
 std::string Logger::getCurrentTime() {
-  // Get current time with microsecond precision
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
+  return Clock::logTime();
+}
 
-  // Convert seconds to local time structure
-  time_t    now = tv.tv_sec;
-  struct tm tstruct;
-  localtime_r(&now, &tstruct);
+/**
+ * @brief Format a point in time as a string with milliseconds
+ *
+ * @param tv The time to format
+ * @return std::string The formatted time
+ */
+std::string Logger::getCurrentTime(const struct timeval &tv) {
+  // Only the writer thread calls this: the date is formatted once per second
+  if (tv.tv_sec != m_timeSecond) {
+    time_t    now = tv.tv_sec;
+    struct tm tstruct;
+    localtime_r(&now, &tstruct);
 
-  // Format date and time
-  char buf[80];
-  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tstruct);
+    char buf[80];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tstruct);
+    m_timeText   = buf;
+    m_timeSecond = tv.tv_sec;
+  }
 
   // Add milliseconds to the formatted time
-  char currentTimeWithMs[84];
-  snprintf(currentTimeWithMs, sizeof(currentTimeWithMs), "%s.%03ld", buf, tv.tv_usec / 1000);
-
-  return std::string(currentTimeWithMs);
+  char millis[8];
+  snprintf(millis, sizeof(millis), ".%03ld", static_cast<long>(tv.tv_usec / 1000));
+  return m_timeText + millis;
 }
\ No newline at end of file
@@ -18,15 +18,25 @@
  * @param filename The name of the log file
  * @throws std::runtime_error if the log file cannot be opened
  */
-Logger::Logger() {
-  m_level = WARNING;
-}
+Logger::Logger()
+    : m_level(WARNING),
+      m_fileLoggingEnabled(false),
+      m_async(false),
+      m_asyncBlock(false),
+      m_ring(NULL),
+      m_ringSize(0),
+      m_ringHead(0),
+      m_ringTail(0),
+      m_dropped(0),
+      m_asyncStop(false),
+      m_timeSecond(static_cast<time_t>(-1)) {}
 
 /**
  * @brief Destroy the Logger object
  *
  */
 Logger::~Logger() {
+  stopAsync();
   if (m_file.is_open()) {
     std::ostringstream logMessage;
     logMessage << "Closing log file: " << m_filename;
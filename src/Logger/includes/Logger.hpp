@@ -17,6 +17,7 @@
 #include "CommonDefinitions.hpp"
 #include "Logger_config.hpp"
 // INCLUDES
+#include <pthread.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <cstring>
@@ -38,13 +39,16 @@
 // - Formatted output with timestamp, level, function name, and file name
 // - Ability to change the log file at runtime
 // - Colorful messages in console output for better visibility
+// - Asynchronous mode: the caller only copies the message into a ring
+//   buffer, and a background thread formats and writes it in batches
 //
 // Typical usage:
 //   Logger::getInstance().log(Logger::INFO, "Information message",
 //   __FUNCTION__, __FILE__);
 //
-// Note: This class is not thread-safe. For use in multi-threaded environments,
-// it is recommended to implement additional synchronization mechanisms.
+// Note: This class is not thread-safe. In asynchronous mode a single thread
+// (the event loop) may log; the ring buffer has one producer and one
+// consumer and needs no lock.
 
 class Logger {
  public:
@@ -55,6 +59,19 @@ class Logger {
   std::ofstream      m_file;
   LogLevel           m_level;
   bool               m_fileLoggingEnabled;
+  // ASYNC MODE
+  struct AsyncRecord;
+  bool               m_async;
+  bool               m_asyncBlock; // Con el buffer lleno se espera en vez de descartar
+  char              *m_ring;
+  size_t             m_ringSize;   // Potencia de dos
+  unsigned long      m_ringHead;   // Solo lo avanza quien registra
+  unsigned long      m_ringTail;   // Solo lo avanza el hilo de escritura
+  unsigned long      m_dropped;
+  bool               m_asyncStop;
+  pthread_t          m_flusher;
+  time_t             m_timeSecond; // Segundo de m_timeText, para el hilo de escritura
+  std::string        m_timeText;
   static std::string centerString(const std::string &str, int width) {
     int padding  = width - str.length();
     int padLeft  = padding / 2;
@@ -72,6 +89,7 @@ class Logger {
  private:
   std::string getLevelString(LogLevel level);
   std::string getCurrentTime();
+  std::string getCurrentTime(const struct timeval &tv);
   std::string getColorCode(LogLevel level);
   // OUTPUT TO CONSOLE AND FILE
   void outputToConsole(LogLevel level, const std::string &consoleMessage);
@@ -91,6 +109,13 @@ class Logger {
   // CLOSE AND OPEN FILES
   void closeCurrentFile();
   int  openNewFile();
+  // ASYNC MODE
+  bool         pushRecord(LogLevel level, const std::string &message, const char *functionName, const char *fileName);
+  void         flushLoop();
+  bool         drainRing(std::string &fileBatch, std::string &outBatch, std::string &errBatch);
+  void         writeBatches(std::string &fileBatch, std::string &outBatch, std::string &errBatch);
+  static void *flusherMain(void *logger);
+  static void  afterForkChild();
   // PUBLIC METHODS
  public:
   static Logger &getInstance();
@@ -101,44 +126,44 @@ class Logger {
   void           setLogFile(const std::string &filename);
   void           setLogLevel(LogLevel level);
   void           setFileLoggingEnabled(bool enable);
+  bool           isEnabled(LogLevel level) const { return level >= m_level; }
+  void           startAsync(size_t bufferSize, bool block);
+  void           stopAsync();
   void           printLogo();
 };
 
+#ifdef WEBSERVER_DEBUG
+// Marks the thread as formatting a log message while it lives, so the
+// per-request heap statistics of debug builds leave the logger out
+class LogFormatting {
+ public:
+  LogFormatting() { ++depth; }
+  ~LogFormatting() { --depth; }
+
+  static __thread int depth;
+};
+#define LOG_FORMATTING LogFormatting logFormatting;
+#else
+#define LOG_FORMATTING
+#endif
+
 // MACROS
-#define LOG_DEBUG(message)                                                 \
-  {                                                                        \
-    std::ostringstream oss;                                                \
-    oss << message;                                                        \
-    Logger::getInstance().log(Logger::DEBUG, oss, __FUNCTION__, __FILE__); \
-  }
-#define LOG_INFO(message)                                                 \
-  {                                                                       \
-    std::ostringstream oss;                                               \
-    oss << message;                                                       \
-    Logger::getInstance().log(Logger::INFO, oss, __FUNCTION__, __FILE__); \
-  }
-#define LOG_WARNING(message)                                                 \
-  {                                                                          \
-    std::ostringstream oss;                                                  \
-    oss << message;                                                          \
-    Logger::getInstance().log(Logger::WARNING, oss, __FUNCTION__, __FILE__); \
-  }
-#define LOG_ERROR(message)                                                 \
-  {                                                                        \
-    std::ostringstream oss;                                                \
-    oss << message;                                                        \
-    Logger::getInstance().log(Logger::ERROR, oss, __FUNCTION__, __FILE__); \
-  }
-#define LOG_CRITICAL(message)                                                 \
-  {                                                                           \
-    std::ostringstream oss;                                                   \
-    oss << message;                                                           \
-    Logger::getInstance().log(Logger::CRITICAL, oss, __FUNCTION__, __FILE__); \
-  }
-#define LOG_SUCCESS(message)                                                 \
-  {                                                                          \
-    std::ostringstream oss;                                                  \
-    oss << message;                                                          \
-    Logger::getInstance().log(Logger::SUCCESS, oss, __FUNCTION__, __FILE__); \
+// The level is checked before the message is formatted, so a filtered
+// statement costs a comparison. Levels below LOG_MIN_LEVEL are removed at
+// compile time: the condition is constant and the branch is never built.
+#define LOG_AT(level, message)                                                                                  \
+  {                                                                                                             \
+    if (static_cast<int>(level) >= static_cast<int>(LOG_MIN_LEVEL) && Logger::getInstance().isEnabled(level)) { \
+      LOG_FORMATTING                                                                                            \
+      std::ostringstream oss;                                                                                   \
+      oss << message;                                                                                           \
+      Logger::getInstance().log(level, oss, __FUNCTION__, __FILE__);                                            \
+    }                                                                                                           \
   }
+#define LOG_DEBUG(message) LOG_AT(Logger::DEBUG, message)
+#define LOG_INFO(message) LOG_AT(Logger::INFO, message)
+#define LOG_WARNING(message) LOG_AT(Logger::WARNING, message)
+#define LOG_ERROR(message) LOG_AT(Logger::ERROR, message)
+#define LOG_CRITICAL(message) LOG_AT(Logger::CRITICAL, message)
+#define LOG_SUCCESS(message) LOG_AT(Logger::SUCCESS, message)
 #endif // LOGGER_H
\ No newline at end of file
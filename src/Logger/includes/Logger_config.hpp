@@ -13,6 +13,15 @@
 #ifndef LOGGER_CONFIG_HPP
 #define LOGGER_CONFIG_HPP
 
+// -----------------------------------------------------------------------------
+// LOG LEVEL CONFIG
+// -----------------------------------------------------------------------------
+// Lowest level compiled in; statements below it are removed from the binary
+// (e.g. -DLOG_MIN_LEVEL=Logger::INFO drops every LOG_DEBUG)
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL Logger::DEBUG
+#endif
+
 // -----------------------------------------------------------------------------
 // LOG FORMAT CONFIG
 // -----------------------------------------------------------------------------
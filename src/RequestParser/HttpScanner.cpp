@@ -0,0 +1,494 @@
+#include "HttpScanner.hpp"
+
+#include <cctype>
+#include <cstring>
+
+// Limite del tamaño de cuerpo representable (evita desbordar size_t)
+#define MAX_CHUNK_DIGITS (sizeof(size_t) * 2 - 1)
+
+static bool isTokenChar(unsigned char c) {
+  return std::isalnum(c) || std::strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+static int hexValue(unsigned char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+HttpScanner::HttpScanner() {
+  reset();
+}
+
+/**
+ * @brief Prepares the scanner for a new request.
+ *
+ * The vectors keep their capacity so a keep-alive connection does not
+ * allocate again for the next request.
+ */
+void HttpScanner::reset() {
+  _state   = S_REQUEST_START;
+  _pos     = 0;
+  _start   = 0;
+  _error   = 0;
+  _method  = Span();
+  _uri     = Span();
+  _version = Span();
+  _current = Header();
+  _headers.clear();
+  _has_length     = false;
+  _chunked        = false;
+  _content_length = 0;
+  _header_end     = 0;
+  _request_end    = 0;
+  _chunk_size     = 0;
+  _chunk_digits   = 0;
+  _body_length    = 0;
+  _body.clear();
+}
+
+HttpScanner::Result HttpScanner::fail(int code) {
+  _state = S_ERROR;
+  _error = code;
+  return SCAN_ERROR;
+}
+
+HttpScanner::Result HttpScanner::status() const {
+  if (_state == S_DONE)
+    return SCAN_DONE;
+  if (_state == S_ERROR)
+    return SCAN_ERROR;
+  return headComplete() ? SCAN_HEAD_DONE : SCAN_INCOMPLETE;
+}
+
+/**
+ * @brief Stores the header just scanned and picks up the framing headers.
+ *
+ * @return false if Content-Length or Transfer-Encoding is invalid.
+ */
+bool HttpScanner::finishHeader(const InputBuffer &buffer) {
+  _headers.push_back(_current);
+
+  if (equalsIgnoreCase(buffer, _current.name, "Content-Length")) {
+    if (_current.value.length == 0) {
+      fail(400);
+      return false;
+    }
+    size_t length = 0;
+    for (size_t i = 0; i < _current.value.length; ++i) {
+      unsigned char c = buffer[_current.value.offset + i];
+      if (!std::isdigit(c)) {
+        fail(400);
+        return false;
+      }
+      if (length > (static_cast<size_t>(-1) - 9) / 10) {
+        fail(413);
+        return false;
+      }
+      length = length * 10 + (c - '0');
+    }
+    if (_has_length && length != _content_length) {
+      fail(400);
+      return false;
+    }
+    _has_length     = true;
+    _content_length = length;
+  } else if (equalsIgnoreCase(buffer, _current.name, "Transfer-Encoding")) {
+    const Span &value = _current.value;
+    if (value.length < 7 || !buffer.equalsIgnoreCase(value.offset + value.length - 7, "chunked", 7)) {
+      fail(501);
+      return false;
+    }
+    _chunked = true;
+  }
+  return true;
+}
+
+void HttpScanner::finishHead(size_t end) {
+  // Una lectura grande puede completar de golpe una cabecera que excede el límite
+  if (end - _start > MAX_HEADER_SIZE) {
+    fail(_uri.offset + _uri.length - _start > MAX_HEADER_SIZE ? 414 : 431);
+    return;
+  }
+  _header_end = end;
+  if (_chunked) {
+    // Transfer-Encoding tiene prioridad sobre Content-Length (RFC 7230 3.3.3)
+    _content_length = 0;
+    _chunk_size     = 0;
+    _chunk_digits   = 0;
+    _state          = S_CHUNK_SIZE;
+  } else if (_content_length > 0) {
+    _state = S_BODY;
+  } else {
+    finishRequest(end);
+  }
+}
+
+/**
+ * @brief Records the next length body bytes at the current position.
+ *
+ * Consecutive pieces are merged, so a Content-Length body or a chunk read
+ * in one go is a single span.
+ */
+void HttpScanner::addBody(size_t length) {
+  if (!_body.empty() && _body.back().offset + _body.back().length == _pos) {
+    _body.back().length += length;
+  } else {
+    Span span;
+    span.offset = _pos;
+    span.length = length;
+    _body.push_back(span);
+  }
+  _body_length += length;
+  _pos += length;
+}
+
+void HttpScanner::finishRequest(size_t end) {
+  _request_end = end;
+  _state       = S_DONE;
+}
+
+/**
+ * @brief Scans the bytes appended to the buffer since the last call.
+ *
+ * @param buffer The connection buffer. It may only grow between calls
+ *               until the scanner is reset.
+ * @return The framing state after the new bytes.
+ */
+HttpScanner::Result HttpScanner::consume(const InputBuffer &buffer) {
+  const size_t size = buffer.size();
+
+  while (_pos < size && _state != S_DONE && _state != S_ERROR) {
+    unsigned char c = buffer[_pos];
+
+    switch (_state) {
+      case S_REQUEST_START:
+        // Se toleran líneas vacías antes de la petición (RFC 7230 3.5)
+        if (c == '\r' || c == '\n') {
+          _start = _pos + 1;
+          break;
+        }
+        if (!isTokenChar(c))
+          return fail(400);
+        _method.offset = _pos;
+        _state         = S_METHOD;
+        break;
+
+      case S_METHOD:
+        if (c == ' ') {
+          _method.length = _pos - _method.offset;
+          _state         = S_URI_START;
+        } else if (!isTokenChar(c)) {
+          return fail(400);
+        }
+        break;
+
+      case S_URI_START:
+        if (c == ' ' || c == '\r' || c == '\n')
+          return fail(400);
+        _uri.offset = _pos;
+        _state      = S_URI;
+        break;
+
+      case S_URI:
+        if (c == ' ') {
+          _uri.length = _pos - _uri.offset;
+          _state      = S_VERSION_START;
+        } else if (c == '\r' || c == '\n') {
+          return fail(400);
+        }
+        break;
+
+      case S_VERSION_START:
+        if (c == ' ' || c == '\r' || c == '\n')
+          return fail(400);
+        _version.offset = _pos;
+        _state          = S_VERSION;
+        break;
+
+      case S_VERSION:
+        if (c == '\r') {
+          _version.length = _pos - _version.offset;
+          _state          = S_REQUEST_LINE_LF;
+        } else if (c == '\n') {
+          _version.length = _pos - _version.offset;
+          _state          = S_HEADER_START;
+        } else if (c == ' ') {
+          return fail(400);
+        }
+        break;
+
+      case S_REQUEST_LINE_LF:
+        if (c != '\n')
+          return fail(400);
+        _state = S_HEADER_START;
+        break;
+
+      case S_HEADER_START:
+        if (c == '\r') {
+          _state = S_HEADERS_END_LF;
+        } else if (c == '\n') {
+          finishHead(_pos + 1);
+        } else if (isTokenChar(c)) {
+          _current.name.offset = _pos;
+          _state               = S_HEADER_NAME;
+        } else {
+          // Incluye las cabeceras multilínea (obs-fold), obsoletas
+          return fail(400);
+        }
+        break;
+
+      case S_HEADER_NAME:
+        if (c == ':') {
+          _current.name.length = _pos - _current.name.offset;
+          _state               = S_HEADER_VALUE_WS;
+        } else if (!isTokenChar(c)) {
+          return fail(400);
+        }
+        break;
+
+      case S_HEADER_VALUE_WS:
+        if (c == ' ' || c == '\t')
+          break;
+        _current.value.offset = _pos;
+        _current.value.length = 0;
+        if (c == '\r' || c == '\n') {
+          if (!finishHeader(buffer))
+            return SCAN_ERROR;
+          _state = (c == '\r') ? S_HEADER_LF : S_HEADER_START;
+        } else {
+          _state = S_HEADER_VALUE;
+        }
+        break;
+
+      case S_HEADER_VALUE: {
+        // El valor no necesita examinarse byte a byte: se busca el fin de línea
+        size_t end = buffer.find('\n', _pos);
+        if (end == std::string::npos) {
+          _pos = size;
+          continue;
+        }
+        size_t eol = (end > _current.value.offset && buffer[end - 1] == '\r') ? end - 1 : end;
+        while (eol > _current.value.offset && (buffer[eol - 1] == ' ' || buffer[eol - 1] == '\t'))
+          --eol;
+        _current.value.length = eol - _current.value.offset;
+        if (!finishHeader(buffer))
+          return SCAN_ERROR;
+        _state = S_HEADER_START;
+        _pos   = end;
+        break;
+      }
+
+      case S_HEADER_LF:
+        if (c != '\n')
+          return fail(400);
+        _state = S_HEADER_START;
+        break;
+
+      case S_HEADERS_END_LF:
+        if (c != '\n')
+          return fail(400);
+        finishHead(_pos + 1);
+        break;
+
+      case S_BODY: {
+        // El cuerpo con Content-Length no se examina: solo se cuenta
+        size_t take = size - _pos;
+        if (take > _content_length - _body_length)
+          take = _content_length - _body_length;
+        addBody(take);
+        if (_body_length == _content_length)
+          finishRequest(_pos);
+        continue;
+      }
+
+      case S_CHUNK_SIZE: {
+        int value = hexValue(c);
+        if (value >= 0) {
+          if (++_chunk_digits > MAX_CHUNK_DIGITS)
+            return fail(413);
+          _chunk_size = _chunk_size * 16 + value;
+        } else if (_chunk_digits == 0) {
+          return fail(400);
+        } else if (c == ';' || c == ' ' || c == '\t') {
+          _state = S_CHUNK_EXT;
+        } else if (c == '\r') {
+          _state = S_CHUNK_SIZE_LF;
+        } else if (c == '\n') {
+          _state = S_CHUNK_SIZE_LF;
+          continue;
+        } else {
+          return fail(400);
+        }
+        break;
+      }
+
+      case S_CHUNK_EXT:
+        if (c == '\r')
+          _state = S_CHUNK_SIZE_LF;
+        else if (c == '\n') {
+          _state = S_CHUNK_SIZE_LF;
+          continue;
+        }
+        break;
+
+      case S_CHUNK_SIZE_LF:
+        if (c != '\n')
+          return fail(400);
+        _state = (_chunk_size == 0) ? S_TRAILER_START : S_CHUNK_DATA;
+        break;
+
+      case S_CHUNK_DATA: {
+        size_t take = size - _pos;
+        if (take > _chunk_size)
+          take = _chunk_size;
+        addBody(take);
+        _chunk_size -= take;
+        if (_chunk_size == 0)
+          _state = S_CHUNK_DATA_CR;
+        continue;
+      }
+
+      case S_CHUNK_DATA_CR:
+        if (c == '\r') {
+          _state = S_CHUNK_DATA_LF;
+          break;
+        }
+        if (c != '\n')
+          return fail(400);
+        // fallthrough
+      case S_CHUNK_DATA_LF:
+        if (c != '\n')
+          return fail(400);
+        _chunk_digits = 0;
+        _state        = S_CHUNK_SIZE;
+        break;
+
+      case S_TRAILER_START:
+        if (c == '\r')
+          _state = S_TRAILER_END_LF;
+        else if (c == '\n')
+          finishRequest(_pos + 1);
+        else
+          _state = S_TRAILER;
+        break;
+
+      case S_TRAILER:
+        if (c == '\n')
+          _state = S_TRAILER_START;
+        break;
+
+      case S_TRAILER_END_LF:
+        if (c != '\n')
+          return fail(400);
+        finishRequest(_pos + 1);
+        break;
+
+      case S_DONE:
+      case S_ERROR:
+        break;
+    }
+    ++_pos;
+  }
+
+  if (!headComplete() && _state != S_ERROR && _pos - _start > MAX_HEADER_SIZE) {
+    return fail(_state <= S_URI ? 414 : 431);
+  }
+  return status();
+}
+
+/**
+ * @brief Removes the body scanned so far from the buffer.
+ *
+ * Called once the spans returned by bodySpans() have been handed over, so
+ * the buffer only ever holds the header and the body bytes of the last
+ * read. Chunk framing already scanned is dropped too; a chunk split across
+ * reads is resumed where it stopped. Bytes after the request end are kept.
+ *
+ * @param buffer The buffer passed to consume().
+ */
+void HttpScanner::discardBody(InputBuffer &buffer) {
+  if (!headComplete() || _pos == _header_end)
+    return;
+  buffer.erase(_header_end, _pos - _header_end);
+  if (_state == S_DONE)
+    _request_end = _header_end;
+  _pos = _header_end;
+  _body.clear();
+}
+
+bool HttpScanner::headComplete() const {
+  return _header_end != 0;
+}
+
+bool HttpScanner::complete() const {
+  return _state == S_DONE;
+}
+
+int HttpScanner::errorCode() const {
+  return _error;
+}
+
+bool HttpScanner::isChunked() const {
+  return _chunked;
+}
+
+size_t HttpScanner::contentLength() const {
+  return _content_length;
+}
+
+size_t HttpScanner::headerEnd() const {
+  return _header_end;
+}
+
+size_t HttpScanner::requestEnd() const {
+  return _request_end;
+}
+
+size_t HttpScanner::bodyLength() const {
+  return _body_length;
+}
+
+const HttpScanner::Span &HttpScanner::method() const {
+  return _method;
+}
+
+const HttpScanner::Span &HttpScanner::uri() const {
+  return _uri;
+}
+
+const HttpScanner::Span &HttpScanner::version() const {
+  return _version;
+}
+
+const std::vector<HttpScanner::Header> &HttpScanner::headers() const {
+  return _headers;
+}
+
+const std::vector<HttpScanner::Span> &HttpScanner::bodySpans() const {
+  return _body;
+}
+
+std::string HttpScanner::text(const InputBuffer &buffer, const Span &span) {
+  return buffer.substr(span.offset, span.length);
+}
+
+/**
+ * @brief Copies a span into a string allocated from the current
+ *        RequestArena.
+ */
+ArenaString HttpScanner::arenaText(const InputBuffer &buffer, const Span &span) {
+  ArenaString text(span.length, '\0');
+  if (span.length > 0)
+    buffer.copy(span.offset, span.length, &text[0]);
+  return text;
+}
+
+bool HttpScanner::equalsIgnoreCase(const InputBuffer &buffer, const Span &span, const char *literal) {
+  size_t length = std::strlen(literal);
+  return span.length == length && buffer.equalsIgnoreCase(span.offset, literal, length);
+}
@@ -0,0 +1,130 @@
+#ifndef HTTP_SCANNER_HPP
+#define HTTP_SCANNER_HPP
+
+//------------------------------------------------------------------------------
+#include "WebServer/BufferPool/InputBuffer.hpp"
+#include "WebServer/RequestArena/RequestArena.hpp"
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Maximum size of the request line plus headers (431 when exceeded)
+#define MAX_HEADER_SIZE 32768
+
+// HttpScanner: resumable HTTP/1.1 request framing
+//
+// consume() is called after every recv with the connection buffer and only
+// looks at the bytes it has not seen yet, so every byte is scanned once no
+// matter how the request is split across reads. Nothing is copied: the
+// request line, headers and body chunks are recorded as spans (offset and
+// length) into the buffer, which stay valid when the buffer grows. A span
+// may cross the blocks of the InputBuffer.
+//
+// Content-Length bodies are skipped without scanning; chunked bodies are
+// de-framed and their data recorded as one span per chunk. bodySpans() only
+// covers the body received since the last discardBody(), which lets the
+// caller stream the body out and keep the buffer small.
+class HttpScanner {
+ public:
+  struct Span {
+    size_t offset;
+    size_t length;
+
+    Span() : offset(0), length(0) {}
+  };
+
+  struct Header {
+    Span name;
+    Span value;
+  };
+
+  enum Result {
+    SCAN_INCOMPLETE, // Faltan datos de la cabecera
+    SCAN_HEAD_DONE,  // Cabecera completa, falta el cuerpo
+    SCAN_DONE,       // Petición completa
+    SCAN_ERROR       // Petición mal formada, ver errorCode()
+  };
+
+  HttpScanner();
+
+  Result consume(const InputBuffer &buffer);
+  void   reset();
+  void   discardBody(InputBuffer &buffer);
+
+  bool   headComplete() const;
+  bool   complete() const;
+  int    errorCode() const;
+  bool   isChunked() const;
+  size_t contentLength() const;
+  size_t headerEnd() const;
+  size_t requestEnd() const;
+  size_t bodyLength() const;
+
+  const Span                &method() const;
+  const Span                &uri() const;
+  const Span                &version() const;
+  const std::vector<Header> &headers() const;
+  const std::vector<Span>   &bodySpans() const;
+
+  static std::string text(const InputBuffer &buffer, const Span &span);
+  static ArenaString arenaText(const InputBuffer &buffer, const Span &span);
+  static bool        equalsIgnoreCase(const InputBuffer &buffer, const Span &span, const char *literal);
+
+ private:
+  enum State {
+    S_REQUEST_START,
+    S_METHOD,
+    S_URI_START,
+    S_URI,
+    S_VERSION_START,
+    S_VERSION,
+    S_REQUEST_LINE_LF,
+    S_HEADER_START,
+    S_HEADER_NAME,
+    S_HEADER_VALUE_WS,
+    S_HEADER_VALUE,
+    S_HEADER_LF,
+    S_HEADERS_END_LF,
+    S_BODY,
+    S_CHUNK_SIZE,
+    S_CHUNK_EXT,
+    S_CHUNK_SIZE_LF,
+    S_CHUNK_DATA,
+    S_CHUNK_DATA_CR,
+    S_CHUNK_DATA_LF,
+    S_TRAILER_START,
+    S_TRAILER,
+    S_TRAILER_END_LF,
+    S_DONE,
+    S_ERROR
+  };
+
+  State               _state;
+  size_t              _pos;
+  size_t              _start;
+  int                 _error;
+  Span                _method;
+  Span                _uri;
+  Span                _version;
+  Header              _current;
+  std::vector<Header> _headers;
+  bool                _has_length;
+  bool                _chunked;
+  size_t              _content_length;
+  size_t              _header_end;
+  size_t              _request_end;
+  size_t              _chunk_size;
+  size_t              _chunk_digits;
+  size_t              _body_length;
+  std::vector<Span>   _body;
+
+  Result fail(int code);
+  bool   finishHeader(const InputBuffer &buffer);
+  void   finishHead(size_t end);
+  void   addBody(size_t length);
+  void   finishRequest(size_t end);
+  Result status() const;
+};
+
+#endif // HTTP_SCANNER_HPP
@@ -0,0 +1,158 @@
+#include "RequestBody.hpp"
+
+#include <errno.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include "../Logger/includes/Logger.hpp"
+
+// Plantilla para mkstemp; el fichero se borra nada más crearse
+#define BODY_SPOOL_TEMPLATE "/tmp/webserv_body_XXXXXX"
+
+static bool writeAll(int fd, const char *data, size_t length) {
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    length -= written;
+  }
+  return true;
+}
+
+RequestBody::RequestBody() : _fd(-1), _size(0) {}
+
+RequestBody::~RequestBody() {
+  clear();
+}
+
+/**
+ * @brief Drops the body and closes the spool file, if any.
+ *
+ * The memory window keeps its capacity for the next request of the
+ * connection.
+ */
+void RequestBody::clear() {
+  if (_fd != -1) {
+    close(_fd);
+    _fd = -1;
+  }
+  _memory.clear();
+  _size = 0;
+}
+
+/**
+ * @brief Moves the in-memory part of the body to an unlinked temporary file.
+ */
+bool RequestBody::spill() {
+  char path[] = BODY_SPOOL_TEMPLATE;
+
+  _fd = mkstemp(path);
+  if (_fd == -1) {
+    LOG_ERROR("Failed to create body spool file: " << strerror(errno));
+    return false;
+  }
+  unlink(path);
+  if (!writeAll(_fd, _memory.data(), _memory.size())) {
+    LOG_ERROR("Failed to write body spool file: " << strerror(errno));
+    return false;
+  }
+  _memory.clear();
+  return true;
+}
+
+/**
+ * @brief Adds the next piece of body.
+ *
+ * @param data The de-framed body bytes.
+ * @param length Number of bytes.
+ * @return false if the body could not be stored (spool file error).
+ */
+bool RequestBody::append(const char *data, size_t length) {
+  if (length == 0)
+    return true;
+  if (_fd == -1 && _size + length <= BODY_MEMORY_WINDOW) {
+    if (_memory.capacity() < BODY_MEMORY_WINDOW && _size + length > _memory.capacity())
+      _memory.reserve(BODY_MEMORY_WINDOW);
+    _memory.append(data, length);
+    _size += length;
+    return true;
+  }
+  if (_fd == -1 && !spill())
+    return false;
+  if (!writeAll(_fd, data, length)) {
+    LOG_ERROR("Failed to write body spool file: " << strerror(errno));
+    return false;
+  }
+  _size += length;
+  return true;
+}
+
+size_t RequestBody::size() const {
+  return _size;
+}
+
+bool RequestBody::inMemory() const {
+  return _fd == -1;
+}
+
+/**
+ * @brief The body when it is held in memory (inMemory()), empty otherwise.
+ */
+const std::string &RequestBody::data() const {
+  return _memory;
+}
+
+/**
+ * @brief The spool file, -1 while the body is held in memory.
+ */
+int RequestBody::fd() const {
+  return _fd;
+}
+
+/**
+ * @brief Copies part of the body without moving any file offset.
+ *
+ * @return Bytes copied, 0 at the end of the body or on error.
+ */
+size_t RequestBody::read(size_t offset, char *buffer, size_t length) const {
+  if (offset >= _size)
+    return 0;
+  if (length > _size - offset)
+    length = _size - offset;
+  if (_fd == -1) {
+    std::memcpy(buffer, _memory.data() + offset, length);
+    return length;
+  }
+  ssize_t got;
+  do {
+    got = pread(_fd, buffer, length, offset);
+  } while (got < 0 && errno == EINTR);
+  return got > 0 ? static_cast<size_t>(got) : 0;
+}
+
+/**
+ * @brief Returns the whole body as a string.
+ *
+ * Only for consumers that need it in one piece (e.g. the CGI query string);
+ * handlers dealing with uploads should use read().
+ */
+std::string RequestBody::str() const {
+  if (_fd == -1)
+    return _memory;
+
+  std::string result;
+  char        buffer[8192];
+  size_t      offset = 0;
+  size_t      got;
+
+  result.reserve(_size);
+  while ((got = read(offset, buffer, sizeof(buffer))) > 0) {
+    result.append(buffer, got);
+    offset += got;
+  }
+  return result;
+}
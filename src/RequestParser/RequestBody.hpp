@@ -0,0 +1,47 @@
+#ifndef REQUEST_BODY_HPP
+#define REQUEST_BODY_HPP
+
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+
+// Bytes of body kept in memory before spilling to a temporary file
+#define BODY_MEMORY_WINDOW 65536
+
+// RequestBody: receiving end of the request body pipeline
+//
+// The event loop hands every piece of body to append() as soon as it is
+// framed, and drops it from the connection buffer. Small bodies stay in
+// memory; once a body outgrows BODY_MEMORY_WINDOW it is moved to an unlinked
+// temporary file and the rest is written straight to it, so the memory used
+// by a connection does not depend on the size of the upload.
+//
+// Handlers read the body back in windows with read(), or use fd() to pass it
+// on without copying.
+class RequestBody {
+ public:
+  RequestBody();
+  ~RequestBody();
+
+  bool append(const char *data, size_t length);
+  void clear();
+
+  size_t             size() const;
+  bool               inMemory() const;
+  const std::string &data() const;
+  int                fd() const;
+  size_t             read(size_t offset, char *buffer, size_t length) const;
+  std::string        str() const;
+
+ private:
+  std::string _memory;
+  int         _fd;
+  size_t      _size;
+
+  bool spill();
+
+  RequestBody(const RequestBody &);
+  RequestBody &operator=(const RequestBody &);
+};
+
+#endif // REQUEST_BODY_HPP
@@ -16,17 +16,9 @@
 //                            CONSTRUCTORS / DESTRUCTOR
 //------------------------------------------------------------------------------
 
-RequestParser::RequestParser() : _method(""), _path(""), _version(""), _body(""), _isComplete(false), _totalsize(0) {
+RequestParser::RequestParser()
+    : _method(""), _path(""), _version(""), _body(NULL), _ecode(0), _isComplete(false), _totalsize(0), _chunked(false) {
   LOG_DEBUG("RequestParser constructor called");
-  _httpMethods["GET"]     = "ALLOWED";
-  _httpMethods["POST"]    = "ALLOWED";
-  _httpMethods["DELETE"]  = "ALLOWED";
-  _httpMethods["PUT"]     = "NOT IMPLEMENTED";
-  _httpMethods["PATCH"]   = "NOT IMPLEMENTED";
-  _httpMethods["OPTIONS"] = "NOT IMPLEMENTED";
-  _httpMethods["HEAD"]    = "ALLOWED";
-  _httpMethods["CONNECT"] = "NOT IMPLEMENTED";
-  _httpMethods["TRACE"]   = "NOT IMPLEMENTED";
 }
 
 RequestParser::~RequestParser() {
@@ -51,6 +43,7 @@ RequestParser &RequestParser::operator=(const RequestParser &other) {
     this->_path       = other._path;
     this->_version    = other._version;
     this->_ecode      = other._ecode;
+    this->_chunked    = other._chunked;
   }
   return *this;
 }
@@ -61,12 +54,13 @@ RequestParser &RequestParser::operator=(const RequestParser &other) {
  * This function decodes percent-encoded strings in URIs, converting them back to their original characters.
  *
  * @param uri The URI string containing percent-encoded characters.
- * @return std::string The decoded string.
+ * @return ArenaString The decoded string.
  */
-std::string RequestParser::decode_percent_encoding(const std::string &uri) {
-  std::string decoded;
+ArenaString RequestParser::decode_percent_encoding(const ArenaString &uri) {
+  ArenaString decoded;
   char        hex[2] = {0};
 
+  decoded.reserve(uri.length());
   for (size_t i = 0; i < uri.length(); ++i) {
     if (uri[i] == '%' && i + 2 < uri.length()) {
       hex[0] = uri[i + 1];
@@ -105,22 +99,22 @@ void RequestParser::calculateTotalSize() {
   _totalsize = 0;
 
   // 1. Sumar el tamaño de las cabeceras
-  for (std::map<std::string, std::string>::const_iterator it = _headers.begin(); it != _headers.end(); ++it) {
+  for (ArenaStringMap::const_iterator it = _headers.begin(); it != _headers.end(); ++it) {
     _totalsize += it->first.size() + 2;  // Tamaño de la clave + ": "
     _totalsize += it->second.size() + 2; // Tamaño del valor + "\r\n"
   }
   _totalsize += 2; // Una línea en blanco después de las cabeceras ("\r\n")
 
   // 2. Sumar el tamaño del body
-  _totalsize += _body.size();
+  _totalsize += getBody().size();
 
   // 3. Si es multipart/form-data, sumar los boundaries y las cabeceras de cada parte
-  std::string contentType = getHeader("Content-Type");
-  if (contentType.find("multipart/form-data") != std::string::npos) {
+  const ArenaString &contentType = getHeader("Content-Type");
+  if (contentType.find("multipart/form-data") != ArenaString::npos) {
     // Supongamos que el boundary está definido en el Content-Type
     size_t boundaryPos = contentType.find("boundary=");
-    if (boundaryPos != std::string::npos) {
-      std::string boundary = "--" + contentType.substr(boundaryPos + 9); // boundary=
+    if (boundaryPos != ArenaString::npos) {
+      ArenaString boundary = "--" + contentType.substr(boundaryPos + 9); // boundary=
       // Sumar el tamaño de cada boundary (antes y después de cada parte)
       _totalsize += (boundary.size() + 4); // "--boundary\r\n" para cada parte
       // Aquí también puedes sumar las cabeceras de cada parte si las tienes
@@ -134,18 +128,18 @@ std::ostream &operator<<(std::ostream &os, const RequestParser &rp) {
   os << "Version: " << rp.getVersion() << std::endl;
   os << "Headers: \n";
 
-  std::map<std::string, std::string>::const_iterator headerIt;
+  ArenaStringMap::const_iterator headerIt;
   for (headerIt = rp.getHeaders().begin(); headerIt != rp.getHeaders().end(); ++headerIt)
     os << "    " << headerIt->first << ": " << headerIt->second << std::endl;
 
   os << "Queries: \n";
-  std::map<std::string, std::string>::const_iterator queryIt;
+  ArenaStringMap::const_iterator queryIt;
   for (queryIt = rp.getQueries().begin(); queryIt != rp.getQueries().end(); ++queryIt)
     os << "    " << queryIt->first << ": " << queryIt->second << std::endl;
 
-  std::string contentType = rp.getHeader("ContentType");
-  if (contentType.find("text") != std::string::npos || contentType.find("json") != std::string::npos) {
-    os << "Body: " << rp.getBody() << std::endl;
+  const ArenaString &contentType = rp.getHeader("ContentType");
+  if (contentType.find("text") != ArenaString::npos || contentType.find("json") != ArenaString::npos) {
+    os << "Body: " << rp.getBody().str() << std::endl;
   } else {
     os << "Body contains binary data (size: " << rp.getBody().size() << " bytes)" << std::endl;
   }
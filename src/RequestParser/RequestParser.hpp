@@ -16,6 +16,8 @@
 //------------------------------------------------------------------------------
 #include "../Logger/includes/Logger.hpp"
 #include "CommonDefinitions.hpp"
+#include "HttpScanner.hpp"
+#include "RequestBody.hpp"
 //------------------------------------------------------------------------------
 #include <cctype>
 #include <cstdlib>
@@ -25,23 +27,23 @@
 #include <string>
 #include <vector>
 //------------------------------------------------------------------------------
-bool is_numeric(const std::string &str);
+bool is_numeric(const ArenaString &str);
 bool isValidUriChar(char ch);
 
 //------------------------------------------------------------------------------
 class RequestParser {
   // ---------------ATTRIBUTES-------------------------------------------------
  private:
-  std::string                        _method;
-  std::string                        _path;
-  std::string                        _version;
-  std::map<std::string, std::string> _headers;
-  std::string                        _body;
-  unsigned short                     _ecode;
-  bool                               _isComplete;
-  std::map<std::string, std::string> _httpMethods;
-  std::map<std::string, std::string> _queries;
-  size_t                             _totalsize;
+  ArenaString        _method; // Todo en la RequestArena de la petición
+  ArenaString        _path;
+  ArenaString        _version;
+  ArenaStringMap     _headers;
+  const RequestBody *_body;
+  unsigned short     _ecode;
+  bool               _isComplete;
+  ArenaStringMap     _queries;
+  size_t             _totalsize;
+  bool               _chunked;
 
   // ---------------CONSTRUCTORS-----------------------------------------------
  public:
@@ -56,15 +58,14 @@ class RequestParser {
   bool           isComplete() const;
   unsigned short getErrorCode() const;
   int            getTotalSize() const;
-  std::string    getMethod() const;
-  std::string    getPath() const;
-  std::string    getVersion() const;
-  std::string    getHeader(const std::string &name) const;
-  std::string    getQuery(const std::string &name) const;
-  std::string    getBody() const;
-  const std::map<std::string, std::string> &getHeaders() const;
-  const std::map<std::string, std::string> &getQueries() const;
-  const std::map<std::string, std::string> &getHttpMethods() const;
+  const ArenaString &getMethod() const;
+  const ArenaString &getPath() const;
+  const ArenaString &getVersion() const;
+  const ArenaString &getHeader(const char *name) const;
+  const ArenaString &getQuery(const char *name) const;
+  const RequestBody &getBody() const;
+  const ArenaStringMap &getHeaders() const;
+  const ArenaStringMap &getQueries() const;
   // -------------------- UTILS -------------------------------------------
  public:
   void        clear();
@@ -73,21 +74,17 @@ class RequestParser {
 
  private:
   void        calculateTotalSize();
-  std::string decode_percent_encoding(const std::string &uri);
+  ArenaString decode_percent_encoding(const ArenaString &uri);
 
   // --------------------- PARSERS  ---------------------------------------
  private:
-  void parseRequestLine(const std::string &line);
-  void parseHeaderLine(const std::string &line);
-  void parseBody(const std::string &body);
-
  public:
-  void parseRequest(const std::string &request);
+  void parseRequest(const InputBuffer &buffer, const HttpScanner &scan, const RequestBody *body = NULL);
 
   // ----------------------- CHECKS -----------------------------------------
  private:
-  bool check_directory_traversal(const std::string &uri);
-  bool check_query_string(const std::string &query);
+  bool check_directory_traversal(const ArenaString &uri);
+  bool check_query_string(const ArenaString &query);
   bool check_line_method();
   bool check_line_URI();
   bool check_line_protocol();
@@ -45,25 +45,25 @@ bool RequestParser::isComplete() const {
 
 /**
  * @brief Gets the HTTP method of the request.
- * @return A string representing the HTTP method.
+ * @return The HTTP method, valid until the RequestArena is reset.
  */
-std::string RequestParser::getMethod() const {
+const ArenaString &RequestParser::getMethod() const {
   return _method;
 }
 
 /**
  * @brief Gets the path of the request.
- * @return A string representing the request path.
+ * @return The request path, valid until the RequestArena is reset.
  */
-std::string RequestParser::getPath() const {
+const ArenaString &RequestParser::getPath() const {
   return _path;
 }
 
 /**
  * @brief Gets the version of the HTTP protocol.
- * @return A string representing the HTTP protocol version.
+ * @return The HTTP protocol version, valid until the RequestArena is reset.
  */
-std::string RequestParser::getVersion() const {
+const ArenaString &RequestParser::getVersion() const {
   return _version;
 }
 
@@ -72,11 +72,11 @@ std::string RequestParser::getVersion() const {
  * @param name The name of the header.
  * @return The value of the header if it exists, or an empty string if not found.
  */
-std::string RequestParser::getHeader(const std::string &name) const {
-  std::map<std::string, std::string>::const_iterator it = _headers.find(name);
-  if (it != _headers.end())
-    return it->second;
-  return "";
+const ArenaString &RequestParser::getHeader(const char *name) const {
+  static const ArenaString none;
+
+  ArenaStringMap::const_iterator it = _headers.find(ArenaString(name));
+  return it != _headers.end() ? it->second : none;
 }
 
 /**
@@ -84,19 +84,21 @@ std::string RequestParser::getHeader(const std::string &name) const {
  * @param name The name of the query.
  * @return The value of the query if it exists, or an empty string if not found.
  */
-std::string RequestParser::getQuery(const std::string &name) const {
-  std::map<std::string, std::string>::const_iterator it = _queries.find(name);
-  if (it != _queries.end())
-    return it->second;
-  return "";
+const ArenaString &RequestParser::getQuery(const char *name) const {
+  static const ArenaString none;
+
+  ArenaStringMap::const_iterator it = _queries.find(ArenaString(name));
+  return it != _queries.end() ? it->second : none;
 }
 
 /**
  * @brief Gets the body of the request.
- * @return A string representing the request body.
+ * @return The body received by the connection, empty if there is none.
  */
-std::string RequestParser::getBody() const {
-  return _body;
+const RequestBody &RequestParser::getBody() const {
+  static const RequestBody empty;
+
+  return _body != NULL ? *_body : empty;
 }
 
 /**
@@ -119,7 +121,7 @@ int RequestParser::getTotalSize() const {
  * @brief Gets all headers of the request.
  * @return A constant reference to the map of headers.
  */
-const std::map<std::string, std::string> &RequestParser::getHeaders() const {
+const ArenaStringMap &RequestParser::getHeaders() const {
   return _headers;
 }
 
@@ -127,14 +129,6 @@ const std::map<std::string, std::string> &RequestParser::getHeaders() const {
  * @brief Gets all queries of the request.
  * @return A constant reference to the map of queries.
  */
-const std::map<std::string, std::string> &RequestParser::getQueries() const {
+const ArenaStringMap &RequestParser::getQueries() const {
   return _queries;
 }
-
-/**
- * @brief Gets all supported HTTP methods.
- * @return A constant reference to the map of HTTP methods.
- */
-const std::map<std::string, std::string> &RequestParser::getHttpMethods() const {
-  return _httpMethods;
-}
\ No newline at end of file
@@ -24,8 +24,8 @@
  * @return true If the string consists solely of digits.
  * @return false If the string contains non-numeric characters.
  */
-bool is_numeric(const std::string &str) {
-  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+bool is_numeric(const ArenaString &str) {
+  for (ArenaString::const_iterator it = str.begin(); it != str.end(); ++it) {
     if (!isdigit(*it))
       return false;
   }
@@ -59,25 +59,25 @@ bool isValidUriChar(char ch) {
 std::string RequestParser::buildQueryString() const {
   std::string query_string;
 
-  const std::map<std::string, std::string> &queries = getQueries();
-  for (std::map<std::string, std::string>::const_iterator it = queries.begin(); it != queries.end(); ++it) {
+  const ArenaStringMap &queries = getQueries();
+  for (ArenaStringMap::const_iterator it = queries.begin(); it != queries.end(); ++it) {
     if (it != queries.begin()) {
       query_string += "&";
     }
-    query_string += it->first + "=" + it->second;
+    query_string.append(it->first.data(), it->first.size());
+    query_string += "=";
+    query_string.append(it->second.data(), it->second.size());
   }
-  const std::map<std::string, std::string>          &headers         = getHeaders();
-  std::map<std::string, std::string>::const_iterator content_type_it = headers.find("Content-Type");
+  const ArenaString &header = getHeader("Content-Type");
+  std::string        content_type(header.data(), header.size());
 
-  if (content_type_it != headers.end()) {
-    if (content_type_it->second.find("application/x-www-form") != std::string::npos) {
-      if (!query_string.empty()) {
-        query_string += "?";
-      }
-      query_string += getBody();
-    } else if (content_type_it->second.find("multipart/form-data") == 0) {
-      query_string += parseMultipartFormData(content_type_it->second);
+  if (content_type.find("application/x-www-form") != std::string::npos) {
+    if (!query_string.empty()) {
+      query_string += "?";
     }
+    query_string += getBody().str();
+  } else if (content_type.find("multipart/form-data") == 0) {
+    query_string += parseMultipartFormData(content_type);
   }
 
   return query_string;
@@ -85,7 +85,7 @@ std::string RequestParser::buildQueryString() const {
 
 std::string RequestParser::parseMultipartFormData(const std::string &content_type) const {
   std::string query_string;
-  std::string body     = getBody();
+  std::string body     = getBody().str();
   std::string boundary = content_type.substr(content_type.find("boundary=") + 9);
   size_t      pos      = 0;
 
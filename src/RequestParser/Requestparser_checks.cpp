@@ -12,6 +12,22 @@
 
 #include "RequestParser.hpp"
 
+// Métodos reconocidos; cualquier otro es una petición mal formada (400)
+static const struct {
+  const char *name;
+  bool        implemented;
+} http_methods[] = {
+    {"GET", true},
+    {"POST", true},
+    {"DELETE", true},
+    {"HEAD", true},
+    {"PUT", false},
+    {"PATCH", false},
+    {"OPTIONS", false},
+    {"CONNECT", false},
+    {"TRACE", false},
+};
+
 /**
  * @brief Checks the validity of a domain name in HTTP requests.
  *
@@ -23,12 +39,12 @@
  * @return true If the domain name is valid.
  * @return false If the domain name is not valid.
  */
-bool check_host_valid_domain_name(const std::string &host) {
+bool check_host_valid_domain_name(const ArenaString &host) {
   if (host.empty())
     return false;
 
-  std::string::const_iterator it          = host.begin();
-  std::string::const_iterator label_start = it;
+  ArenaString::const_iterator it          = host.begin();
+  ArenaString::const_iterator label_start = it;
 
   while (it != host.end()) {
     if (!isalnum(*it) && *it != '-' && *it != '.') {
@@ -68,10 +84,10 @@ bool check_host_valid_domain_name(const std::string &host) {
  * @return true If the IP address is valid.
  * @return false If the IP address is not valid.
  */
-bool check_host_valid_ipv4(const std::string &host) {
+bool check_host_valid_ipv4(const ArenaString &host) {
   int         segments = 0;
-  std::string segment;
-  for (std::string::const_iterator it = host.begin(); it != host.end(); ++it) {
+  ArenaString segment;
+  for (ArenaString::const_iterator it = host.begin(); it != host.end(); ++it) {
     if (*it == '.') {
       if (segment.empty() || !is_numeric(segment) || std::atoi(segment.c_str()) > 255) {
         return false;
@@ -104,13 +120,13 @@ bool check_host_valid_ipv4(const std::string &host) {
  * @return true If the host header is valid.
  * @return false If the host header is not valid.
  */
-bool check_valid_host(const std::string &host_header) {
+bool check_valid_host(const ArenaString &host_header) {
   if (host_header.empty())
     return false;
 
-  std::string host, port;
+  ArenaString host, port;
   std::size_t colon_pos = host_header.find(':');
-  if (colon_pos != std::string::npos) {
+  if (colon_pos != ArenaString::npos) {
     host = host_header.substr(0, colon_pos);
     port = host_header.substr(colon_pos + 1);
 
@@ -159,10 +175,9 @@ bool RequestParser::check_headers() {
  */
 bool RequestParser::check_body() {
   // validacion junto al header content-length
-  std::string content_length = getHeader("Content-Length");
-  std::string ismultipart    = getHeader("Content-Type");
+  const ArenaString &content_length = getHeader("Content-Length");
 
-  if (!getHeader("Transfer-encoding").empty())
+  if (_chunked || !getHeader("Transfer-encoding").empty())
     return true;
   calculateTotalSize();
   if (!is_numeric(content_length)) {
@@ -183,29 +198,28 @@ bool RequestParser::check_body() {
  * @return true If the query string is valid.
  * @return false If the query string is not valid.
  */
-bool RequestParser::check_query_string(const std::string &query) {
+bool RequestParser::check_query_string(const ArenaString &query) {
   size_t start   = 0;
   size_t amp_pos = 0;
   while (start < query.length()) {
     amp_pos       = query.find('&', start);
     size_t eq_pos = query.find('=', start);
 
-    if (eq_pos == std::string::npos || (amp_pos != std::string::npos && eq_pos > amp_pos)) {
+    if (eq_pos == ArenaString::npos || (amp_pos != ArenaString::npos && eq_pos > amp_pos)) {
       LOG_ERROR("WRONG FORMAT QUERIES");
       _ecode = e_http_errorcodes(BAD_REQUEST);
       return false;
     }
-    std::string key = query.substr(start, eq_pos - start);
+    ArenaString key(query.data() + start, eq_pos - start);
 
     size_t value_length;
-    if (amp_pos == std::string::npos)
+    if (amp_pos == ArenaString::npos)
       value_length = query.length();
     else
       value_length = amp_pos;
 
-    std::string value = query.substr(eq_pos + 1, value_length - eq_pos - 1);
-    _queries[key]     = value;
-    if (amp_pos == std::string::npos)
+    _queries[key].assign(query.data() + eq_pos + 1, value_length - eq_pos - 1);
+    if (amp_pos == ArenaString::npos)
       start = query.length();
     else
       start = amp_pos + 1;
@@ -232,14 +246,16 @@ bool RequestParser::check_line_URI() {
       return false;
     }
   }
-  std::string decode_path = decode_percent_encoding(_path);
+  ArenaString decode_path = decode_percent_encoding(_path);
   if (decode_path.empty()) {
     return false;
   } else
-    _path = decode_path;
+    _path.swap(decode_path);
   size_t      query_pos = _path.find('?');
-  std::string path      = _path.substr(0, query_pos);
-  std::string query     = (query_pos != std::string::npos) ? _path.substr(query_pos + 1) : "";
+  ArenaString path      = _path.substr(0, query_pos);
+  ArenaString query;
+  if (query_pos != ArenaString::npos)
+    query = _path.substr(query_pos + 1);
 
   if (!check_directory_traversal(path)) {
     _ecode = e_http_errorcodes(FORBIDDEN);
@@ -268,7 +284,7 @@ bool RequestParser::check_line_URI() {
  * @return false If the protocol is not valid.
  */
 bool RequestParser::check_line_protocol() {
-  std::string version = "HTTP/";
+  const char *version = "HTTP/";
 
   for (size_t i = 0; i < 4; i++) {
     if (_version[i] != version[i]) {
@@ -296,13 +312,13 @@ bool RequestParser::check_line_protocol() {
  * @return false If the URI is not valid.
  */
 
-bool RequestParser::check_directory_traversal(const std::string &uri) {
-  std::vector<std::string> segments;
-  std::string              segment;
-  size_t                   start           = 0, end;
-  bool                     ends_with_slash = !uri.empty() && uri[uri.length() - 1] == '/';
+bool RequestParser::check_directory_traversal(const ArenaString &uri) {
+  std::vector<ArenaString, ArenaAllocator<ArenaString> > segments;
+  ArenaString                                            segment;
+  size_t                                                 start           = 0, end;
+  bool                                                   ends_with_slash = !uri.empty() && uri[uri.length() - 1] == '/';
 
-  while ((end = uri.find('/', start)) != std::string::npos) {
+  while ((end = uri.find('/', start)) != ArenaString::npos) {
     segment = uri.substr(start, end - start);
     start   = end + 1;
 
@@ -334,7 +350,7 @@ bool RequestParser::check_directory_traversal(const std::string &uri) {
     }
   }
 
-  std::string normalized_uri = "/";
+  ArenaString normalized_uri = "/";
   for (size_t i = 0; i < segments.size(); ++i) {
     if (i > 0)
       normalized_uri += "/";
@@ -345,7 +361,7 @@ bool RequestParser::check_directory_traversal(const std::string &uri) {
     normalized_uri += '/';
   }
 
-  _path = normalized_uri;
+  _path.swap(normalized_uri);
   return true;
 }
 
@@ -360,23 +376,17 @@ bool RequestParser::check_directory_traversal(const std::string &uri) {
  * @return false If the method is not valid.
  */
 bool RequestParser::check_line_method() {
-  std::map<std::string, std::string>::iterator it = _httpMethods.find(_method);
-
-  if (it != _httpMethods.end()) {
-    if (it->second == "NOT ALLOWED") {
-      LOG_ERROR("METHOD NOT ALLOWED");
-      _ecode = e_http_errorcodes(METHOD_NOT_ALLOWED);
-      return false;
-    }
-    if (it->second == "NOT IMPLEMENTED") {
+  for (size_t i = 0; i < sizeof(http_methods) / sizeof(http_methods[0]); ++i) {
+    if (_method != http_methods[i].name)
+      continue;
+    if (!http_methods[i].implemented) {
       LOG_ERROR("METHOD NOT IMPLEMENTED");
       _ecode = e_http_errorcodes(METHOD_NOT_IMPLEMENTED);
       return false;
     }
     return true;
-  } else {
-    LOG_ERROR("INVALID METHOD");
-    _ecode = e_http_errorcodes(BAD_REQUEST);
-    return false;
   }
+  LOG_ERROR("INVALID METHOD");
+  _ecode = e_http_errorcodes(BAD_REQUEST);
+  return false;
 }
@@ -0,0 +1,474 @@
+#include "AccessLog.hpp"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Logger/includes/Logger.hpp"
+#include "WebServer/Clock/Clock.hpp"
+
+// Buffers de retraso que se toleran al hilo de escritura antes de descartar
+#define ACCESS_LOG_MAX_BACKLOG 8
+
+AccessLog::AccessLog()
+    : _format(FORMAT_COMBINED),
+      _buffer_size(0),
+      _flush_ms(0),
+      _rotate_size(0),
+      _enabled(false),
+      _lines(0),
+      _first_ms(0),
+      _time_second(0),
+      _writer(),
+      _reopen(false),
+      _stop(false),
+      _fd(-1),
+      _file_size(0) {
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_cond, NULL);
+}
+
+AccessLog::~AccessLog() {
+  close();
+  pthread_cond_destroy(&_cond);
+  pthread_mutex_destroy(&_mutex);
+}
+
+/**
+ * @brief Opens the log file and starts the writer thread.
+ *
+ * Must be called in the process that serves the requests (after fork), as
+ * the thread is not inherited by child processes.
+ *
+ * @param buffer_size Bytes of lines gathered before they are handed over.
+ * @param flush_ms Longest time a line waits in the buffer.
+ * @param rotate_size Size at which the file is rotated, 0 to never do it.
+ * @return false if the file could not be opened; the log stays disabled.
+ */
+bool AccessLog::open(const std::string &path,
+                     Format             format,
+                     size_t             buffer_size,
+                     unsigned int       flush_ms,
+                     size_t             rotate_size) {
+  close();
+  _path        = path;
+  _format      = format;
+  _buffer_size = buffer_size;
+  _flush_ms    = flush_ms;
+  _rotate_size = rotate_size;
+  _reopen      = false;
+  _stop        = false;
+  _lines       = 0;
+  _buffer.clear();
+  _buffer.reserve(buffer_size);
+  if (!openFile()) {
+    LOG_ERROR("Could not open the access log " << path << ": " << strerror(errno));
+    return false;
+  }
+
+  // Las señales las atiende el bucle de eventos, no el hilo de escritura
+  sigset_t all, previous;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &previous);
+  int error = pthread_create(&_writer, NULL, &AccessLog::writerMain, this);
+  pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+  if (error != 0) {
+    LOG_ERROR("Could not start the access log writer thread: " << strerror(error));
+    ::close(_fd);
+    _fd = -1;
+    return false;
+  }
+  _enabled = true;
+  return true;
+}
+
+/**
+ * @brief Writes the lines still buffered and stops the writer thread.
+ */
+void AccessLog::close() {
+  if (!_enabled) {
+    return;
+  }
+  flush();
+  pthread_mutex_lock(&_mutex);
+  _stop = true;
+  pthread_cond_signal(&_cond);
+  pthread_mutex_unlock(&_mutex);
+  pthread_join(_writer, NULL);
+  ::close(_fd);
+  _fd      = -1;
+  _enabled = false;
+}
+
+bool AccessLog::enabled() const {
+  return _enabled;
+}
+
+/**
+ * @brief Formats the line of a finished request into the buffer.
+ *
+ * @param now_ms Loop time, used for the flush deadline.
+ */
+void AccessLog::write(const AccessEntry &entry, unsigned long now_ms) {
+  if (!_enabled) {
+    return;
+  }
+  time_t now = Clock::seconds();
+  if (now != _time_second) {
+    formatTime(now);
+  }
+  if (_buffer.empty()) {
+    _first_ms = now_ms;
+  }
+  if (_format == FORMAT_JSON) {
+    appendJson(entry);
+  } else {
+    appendCombined(entry);
+  }
+  ++_lines;
+  if (_buffer.size() >= _buffer_size) {
+    flush();
+  }
+}
+
+/**
+ * @brief Hands the buffer over once its oldest line has waited flush_ms.
+ */
+void AccessLog::tick(unsigned long now_ms) {
+  if (_enabled && !_buffer.empty() && now_ms - _first_ms >= _flush_ms) {
+    flush();
+  }
+}
+
+/**
+ * @brief Milliseconds until the buffer has to be handed over.
+ *
+ * @return -1 if there is nothing buffered.
+ */
+int AccessLog::nextTimeout(unsigned long now_ms) const {
+  if (!_enabled || _buffer.empty()) {
+    return -1;
+  }
+  unsigned long deadline = _first_ms + _flush_ms;
+  return deadline > now_ms ? static_cast<int>(deadline - now_ms) : 0;
+}
+
+/**
+ * @brief Makes the writer reopen the file, after the lines buffered so far
+ *        have been written to the old one (SIGUSR1, external rotation).
+ */
+void AccessLog::reopen() {
+  if (!_enabled) {
+    return;
+  }
+  flush();
+  pthread_mutex_lock(&_mutex);
+  _reopen = true;
+  pthread_cond_signal(&_cond);
+  pthread_mutex_unlock(&_mutex);
+}
+
+/**
+ * @brief Monotonic time in microseconds, for request latencies.
+ */
+unsigned long AccessLog::nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<unsigned long>(ts.tv_sec) * 1000000UL + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Hands the buffer to the writer thread.
+ *
+ * The lock is only held to swap or append buffers, never during a write to
+ * the file. If the writer is ACCESS_LOG_MAX_BACKLOG buffers behind, the
+ * lines are dropped.
+ */
+void AccessLog::flush() {
+  if (_buffer.empty()) {
+    return;
+  }
+  size_t dropped = 0;
+  pthread_mutex_lock(&_mutex);
+  if (_pending.empty()) {
+    _pending.swap(_buffer);
+  } else if (_pending.size() < _buffer_size * ACCESS_LOG_MAX_BACKLOG) {
+    _pending.append(_buffer);
+  } else {
+    dropped = _lines;
+  }
+  pthread_cond_signal(&_cond);
+  pthread_mutex_unlock(&_mutex);
+
+  _buffer.clear();
+  _lines = 0;
+  if (dropped > 0) {
+    LOG_WARNING("Access log writer is behind, dropped " << dropped << " lines");
+  }
+}
+
+/**
+ * @brief Caches the timestamp of the current second in the log format.
+ */
+void AccessLog::formatTime(time_t now) {
+  struct tm local;
+  char      text[64];
+  char      zone[16];
+  localtime_r(&now, &local);
+  strftime(text, sizeof(text), _format == FORMAT_JSON ? "%Y-%m-%dT%H:%M:%S" : "%d/%b/%Y:%H:%M:%S ", &local);
+  // %z no es C++98: el desfase se escribe a mano
+  long offset = local.tm_gmtoff / 60;
+  snprintf(zone, sizeof(zone), "%c%02ld%02ld", offset < 0 ? '-' : '+', labs(offset) / 60, labs(offset) % 60);
+  _time_text   = text;
+  _time_text  += zone;
+  _time_second = now;
+}
+
+/**
+ * @brief Combined format, with the request time (rt) and the time spent in
+ *        a CGI (ut, "-" without one) in seconds:
+ *
+ * addr - - [time] "request" status bytes "referer" "user_agent" rt=0.000 ut=-
+ */
+void AccessLog::appendCombined(const AccessEntry &entry) {
+  char address[INET_ADDRSTRLEN];
+  char numbers[64];
+
+  inet_ntop(AF_INET, &entry.remote_addr, address, sizeof(address));
+  _buffer += address;
+  _buffer += " - - [";
+  _buffer += _time_text;
+  _buffer += "] \"";
+  if (entry.method.empty()) {
+    _buffer += '-';
+  } else {
+    appendEscaped(_buffer, entry.method, false);
+    _buffer += ' ';
+    appendEscaped(_buffer, entry.uri, false);
+    if (!entry.version.empty()) {
+      _buffer += ' ';
+      appendEscaped(_buffer, entry.version, false);
+    }
+  }
+  snprintf(numbers, sizeof(numbers), "\" %d %lu \"", entry.status, static_cast<unsigned long>(entry.bytes_sent));
+  _buffer += numbers;
+  if (entry.referer.empty()) {
+    _buffer += '-';
+  } else {
+    appendEscaped(_buffer, entry.referer, false);
+  }
+  _buffer += "\" \"";
+  if (entry.user_agent.empty()) {
+    _buffer += '-';
+  } else {
+    appendEscaped(_buffer, entry.user_agent, false);
+  }
+  _buffer += "\" rt=";
+  appendSeconds(_buffer, entry.request_us);
+  _buffer += " ut=";
+  if (entry.task_start_us != 0) {
+    appendSeconds(_buffer, entry.upstream_us);
+  } else {
+    _buffer += '-';
+  }
+  _buffer += '\n';
+}
+
+/**
+ * @brief One JSON object per line; times in seconds, upstream_time null
+ *        without a CGI.
+ */
+void AccessLog::appendJson(const AccessEntry &entry) {
+  char address[INET_ADDRSTRLEN];
+  char numbers[64];
+
+  inet_ntop(AF_INET, &entry.remote_addr, address, sizeof(address));
+  _buffer += "{\"time\":\"";
+  _buffer += _time_text;
+  _buffer += "\",\"remote_addr\":\"";
+  _buffer += address;
+  _buffer += "\",\"method\":\"";
+  appendEscaped(_buffer, entry.method, true);
+  _buffer += "\",\"uri\":\"";
+  appendEscaped(_buffer, entry.uri, true);
+  _buffer += "\",\"protocol\":\"";
+  appendEscaped(_buffer, entry.version, true);
+  snprintf(numbers,
+           sizeof(numbers),
+           "\",\"status\":%d,\"bytes_sent\":%lu,\"referer\":\"",
+           entry.status,
+           static_cast<unsigned long>(entry.bytes_sent));
+  _buffer += numbers;
+  appendEscaped(_buffer, entry.referer, true);
+  _buffer += "\",\"user_agent\":\"";
+  appendEscaped(_buffer, entry.user_agent, true);
+  _buffer += "\",\"request_time\":";
+  appendSeconds(_buffer, entry.request_us);
+  _buffer += ",\"upstream_time\":";
+  if (entry.task_start_us != 0) {
+    appendSeconds(_buffer, entry.upstream_us);
+  } else {
+    _buffer += "null";
+  }
+  _buffer += "}\n";
+}
+
+/**
+ * @brief Appends a client supplied value so it cannot break the line:
+ *        \xHH for quotes, backslashes and non-printable bytes in the
+ *        combined format, JSON string escapes in the JSON one.
+ */
+void AccessLog::appendEscaped(std::string &out, const std::string &value, bool json) {
+  static const char hex[] = "0123456789ABCDEF";
+
+  for (size_t i = 0; i < value.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(value[i]);
+    if (json) {
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += static_cast<char>(c);
+      } else if (c < 0x20) {
+        out += "\\u00";
+        out += hex[c >> 4];
+        out += hex[c & 0xF];
+      } else {
+        out += static_cast<char>(c);
+      }
+    } else if (c == '"' || c == '\\' || c < 0x20 || c >= 0x7F) {
+      out += "\\x";
+      out += hex[c >> 4];
+      out += hex[c & 0xF];
+    } else {
+      out += static_cast<char>(c);
+    }
+  }
+}
+
+/**
+ * @brief Appends a duration in seconds with millisecond resolution.
+ */
+void AccessLog::appendSeconds(std::string &out, unsigned long us) {
+  char text[32];
+  snprintf(text, sizeof(text), "%lu.%03lu", us / 1000000, (us / 1000) % 1000);
+  out += text;
+}
+
+void *AccessLog::writerMain(void *log) {
+  static_cast<AccessLog *>(log)->writerLoop();
+  return NULL;
+}
+
+/**
+ * @brief Body of the writer thread: writes every batch it is handed until
+ *        stopped, and rotates or reopens the file between batches.
+ *
+ * Errors cannot be logged from here (the Logger belongs to the loop); a
+ * failed write loses its batch and a failed reopen keeps the old file.
+ */
+void AccessLog::writerLoop() {
+  std::string batch;
+
+  pthread_mutex_lock(&_mutex);
+  for (;;) {
+    while (_pending.empty() && !_reopen && !_stop) {
+      pthread_cond_wait(&_cond, &_mutex);
+    }
+    if (_pending.empty() && !_reopen) {
+      break;
+    }
+    // El buffer vaciado vuelve como _pending: su capacidad se reutiliza
+    batch.swap(_pending);
+    bool reopen = _reopen;
+    _reopen     = false;
+    pthread_mutex_unlock(&_mutex);
+
+    size_t written = 0;
+    while (written < batch.size()) {
+      ssize_t n = ::write(_fd, batch.data() + written, batch.size() - written);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        break;
+      }
+      written += n;
+    }
+    batch.clear();
+
+    // Con O_APPEND la posición es el final del fichero, con lo que han
+    // escrito los demás workers
+    off_t end  = lseek(_fd, 0, SEEK_CUR);
+    _file_size = end > 0 ? static_cast<size_t>(end) : 0;
+    if (_rotate_size > 0 && _file_size >= _rotate_size) {
+      rotateFile();
+    } else if (reopen || fileMoved()) {
+      openFile();
+    }
+    pthread_mutex_lock(&_mutex);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+/**
+ * @brief Opens (or reopens) the file at the log path for appending.
+ *
+ * @return false if it could not be opened; the previous descriptor is kept.
+ */
+bool AccessLog::openFile() {
+  int fd = ::open(_path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  if (_fd != -1) {
+    ::close(_fd);
+  }
+  _fd = fd;
+  return true;
+}
+
+/**
+ * @brief Renames the file to path.YYYYmmdd-HHMMSS and starts a new one.
+ *
+ * The file is only renamed if it is still the one this worker writes to;
+ * otherwise another worker already rotated it and only the reopen is left.
+ */
+void AccessLog::rotateFile() {
+  if (!fileMoved()) {
+    time_t    now = time(NULL);
+    struct tm local;
+    char      suffix[32];
+    localtime_r(&now, &local);
+    strftime(suffix, sizeof(suffix), ".%Y%m%d-%H%M%S", &local);
+
+    // Dos rotaciones en el mismo segundo no se pisan
+    std::string base   = _path + suffix;
+    std::string target = base;
+    for (int n = 1; access(target.c_str(), F_OK) == 0; ++n) {
+      snprintf(suffix, sizeof(suffix), ".%d", n);
+      target = base + suffix;
+    }
+    rename(_path.c_str(), target.c_str());
+  }
+  openFile();
+}
+
+/**
+ * @brief Whether the log path no longer names the open file (rotated by
+ *        another worker, moved away by logrotate or deleted).
+ */
+bool AccessLog::fileMoved() const {
+  struct stat path_stat;
+  struct stat fd_stat;
+  if (fstat(_fd, &fd_stat) != 0) {
+    return false;
+  }
+  if (stat(_path.c_str(), &path_stat) != 0) {
+    return true;
+  }
+  return path_stat.st_ino != fd_stat.st_ino || path_stat.st_dev != fd_stat.st_dev;
+}
@@ -0,0 +1,114 @@
+#ifndef ACCESS_LOG_HPP
+#define ACCESS_LOG_HPP
+
+//------------------------------------------------------------------------------
+#include <pthread.h>
+#include <cstddef>
+#include <ctime>
+#include <string>
+
+// What the access log records about one request
+//
+// Kept in the connection and reused, so copying the request fields only
+// allocates while they outgrow the previous ones.
+struct AccessEntry {
+  unsigned int  remote_addr;   // IPv4 del cliente, en orden de red
+  unsigned long start_us;      // Primer byte de la petición, 0 si no hay ninguna en curso
+  unsigned long task_start_us; // Inicio de la tarea (CGI), 0 si no la hay
+  unsigned long upstream_us;   // Duración de la tarea
+  size_t        bytes_before;  // OutputQueue::total() antes de la respuesta
+  size_t        bytes_sent;
+  int           status;
+  unsigned long request_us; // Del primer byte a la respuesta encolada
+  std::string   method;
+  std::string   uri;
+  std::string   version;
+  std::string   referer;
+  std::string   user_agent;
+
+  AccessEntry()
+      : remote_addr(0),
+        start_us(0),
+        task_start_us(0),
+        upstream_us(0),
+        bytes_before(0),
+        bytes_sent(0),
+        status(0),
+        request_us(0) {}
+};
+
+// AccessLog: buffered access log of one worker
+//
+// Lines are formatted by the event loop into a buffer that is handed to a
+// writer thread when it reaches buffer_size or when its oldest line is
+// flush_ms old, so the loop never waits for the disk. The writer owns the
+// file: it appends with O_APPEND (workers can share the file), rotates it
+// when it grows past rotate_size and reopens it on reopen() (SIGUSR1) or
+// when the file was moved away by another worker or by logrotate.
+//
+// If the writer falls behind, lines are dropped and counted instead of
+// growing the memory without bound.
+class AccessLog {
+ public:
+  enum Format {
+    FORMAT_COMBINED, // Combined de nginx/Apache con rt= y ut= al final
+    FORMAT_JSON      // Un objeto JSON por línea
+  };
+
+  AccessLog();
+  ~AccessLog();
+
+  bool open(const std::string &path, Format format, size_t buffer_size, unsigned int flush_ms, size_t rotate_size);
+  void close();
+  bool enabled() const;
+
+  void write(const AccessEntry &entry, unsigned long now_ms);
+  void tick(unsigned long now_ms);
+  int  nextTimeout(unsigned long now_ms) const;
+  void reopen();
+
+  static unsigned long nowUs();
+
+ private:
+  std::string   _path;
+  Format        _format;
+  size_t        _buffer_size;
+  unsigned int  _flush_ms;
+  size_t        _rotate_size;
+  bool          _enabled;
+  std::string   _buffer;      // Líneas que aún no tiene el hilo de escritura
+  size_t        _lines;       // Líneas en _buffer
+  unsigned long _first_ms;    // Cuándo entró la primera línea de _buffer
+  time_t        _time_second; // Segundo de _time_text
+  std::string   _time_text;
+
+  // Compartido con el hilo de escritura, protegido por _mutex
+  pthread_t       _writer;
+  pthread_mutex_t _mutex;
+  pthread_cond_t  _cond;
+  std::string     _pending;
+  bool            _reopen;
+  bool            _stop;
+
+  // Solo los usa el hilo de escritura
+  int    _fd;
+  size_t _file_size;
+
+  void        flush();
+  void        formatTime(time_t now);
+  void        appendCombined(const AccessEntry &entry);
+  void        appendJson(const AccessEntry &entry);
+  static void appendEscaped(std::string &out, const std::string &value, bool json);
+  static void appendSeconds(std::string &out, unsigned long us);
+
+  static void *writerMain(void *log);
+  void         writerLoop();
+  bool         openFile();
+  void         rotateFile();
+  bool         fileMoved() const;
+
+  AccessLog(const AccessLog &);
+  AccessLog &operator=(const AccessLog &);
+};
+
+#endif // ACCESS_LOG_HPP
@@ -0,0 +1,152 @@
+#include "AdmissionQueue.hpp"
+
+#include <cmath>
+
+AdmissionQueue::AdmissionQueue()
+    : _max_size(0),
+      _target_ms(50),
+      _interval_ms(500),
+      _first_above_ms(0),
+      _drop_next_ms(0),
+      _drop_count(0),
+      _dropping(false),
+      _lag_ms(0) {}
+
+/**
+ * @param target_ms Acceptable time in the queue.
+ * @param interval_ms Time the delay has to stay above the target before
+ *                    connections are refused.
+ * @param max_size Connections kept waiting; past it the oldest is refused.
+ */
+void AdmissionQueue::configure(unsigned int target_ms, unsigned int interval_ms, size_t max_size) {
+  _target_ms   = target_ms;
+  _interval_ms = interval_ms;
+  _max_size    = max_size;
+}
+
+void AdmissionQueue::push(int fd, int port, unsigned int addr, unsigned long now_ms) {
+  Pending pending;
+  pending.fd        = fd;
+  pending.port      = port;
+  pending.addr      = addr;
+  pending.queued_ms = now_ms;
+  _queue.push_back(pending);
+}
+
+/**
+ * @brief Takes the oldest connection without a decision (queue full, shutdown).
+ */
+bool AdmissionQueue::pop(Pending &pending) {
+  if (_queue.empty()) {
+    return false;
+  }
+  pending = _queue.front();
+  _queue.pop_front();
+  return true;
+}
+
+bool AdmissionQueue::full() const {
+  return _queue.size() >= _max_size;
+}
+
+bool AdmissionQueue::empty() const {
+  return _queue.empty();
+}
+
+/**
+ * @brief Decides what happens to the head of the queue.
+ *
+ * Called until it returns ADMISSION_WAIT. Refusals happen even when nothing
+ * can be admitted, so a full worker still sheds its backlog.
+ *
+ * @param can_admit Whether the worker has room for one more connection.
+ * @param pending The head, when the decision is ADMIT or DROP; it has
+ *                been removed from the queue.
+ */
+AdmissionDecision AdmissionQueue::next(unsigned long now_ms, bool can_admit, Pending &pending) {
+  if (_queue.empty()) {
+    _first_above_ms = 0;
+    _dropping       = false;
+    return ADMISSION_WAIT;
+  }
+
+  bool ok_to_drop = aboveTarget(now_ms);
+  bool drop       = false;
+  if (_dropping) {
+    if (!ok_to_drop) {
+      _dropping = false;
+    } else if (now_ms >= _drop_next_ms) {
+      ++_drop_count;
+      _drop_next_ms = controlLaw(_drop_next_ms);
+      drop          = true;
+    }
+  } else if (ok_to_drop) {
+    // Si se acaba de salir del estado de rechazo se sigue con una cadencia parecida
+    bool recent   = _drop_count > 2 && now_ms - _drop_next_ms < 16UL * _interval_ms;
+    _drop_count   = recent ? _drop_count - 2 : 1;
+    _dropping     = true;
+    _drop_next_ms = controlLaw(now_ms);
+    drop          = true;
+  }
+
+  if (!drop && !can_admit) {
+    return ADMISSION_WAIT;
+  }
+  pending = _queue.front();
+  _queue.pop_front();
+  return drop ? ADMISSION_DROP : ADMISSION_ADMIT;
+}
+
+/**
+ * @brief Milliseconds until next() may decide something new, -1 if the
+ *        queue is empty.
+ */
+int AdmissionQueue::nextTimeout(unsigned long now_ms) const {
+  if (_queue.empty()) {
+    return -1;
+  }
+  unsigned long at = _queue.front().queued_ms + _target_ms;
+  if (_first_above_ms != 0) {
+    at = _first_above_ms;
+  }
+  if (_dropping) {
+    at = _drop_next_ms;
+  }
+  return at > now_ms ? static_cast<int>(at - now_ms) : 0;
+}
+
+/**
+ * @brief Records how long one iteration of the event loop took.
+ */
+void AdmissionQueue::recordLag(unsigned long lag_ms) {
+  // Media móvil exponencial con peso 1/8
+  _lag_ms = (_lag_ms * 7 + lag_ms) / 8;
+}
+
+/**
+ * @brief Whether the loop takes longer than the target, so new connections
+ *        would only slow down the ones already admitted.
+ */
+bool AdmissionQueue::lagging() const {
+  return _lag_ms > _target_ms;
+}
+
+/**
+ * @brief Whether the head has waited above the target for a whole interval.
+ */
+bool AdmissionQueue::aboveTarget(unsigned long now_ms) {
+  unsigned long sojourn_ms = now_ms - _queue.front().queued_ms;
+  if (sojourn_ms < _target_ms) {
+    _first_above_ms = 0;
+    return false;
+  }
+  if (_first_above_ms == 0) {
+    _first_above_ms = now_ms + _interval_ms;
+    return false;
+  }
+  return now_ms >= _first_above_ms;
+}
+
+unsigned long AdmissionQueue::controlLaw(unsigned long t) const {
+  return t + static_cast<unsigned long>(_interval_ms / std::sqrt(static_cast<double>(_drop_count)));
+}
@@ -0,0 +1,66 @@
+#ifndef ADMISSION_QUEUE_HPP
+#define ADMISSION_QUEUE_HPP
+
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <deque>
+
+// What to do with the connection at the head of the AdmissionQueue
+enum AdmissionDecision {
+  ADMISSION_WAIT,  // Nada que hacer por ahora
+  ADMISSION_ADMIT, // Registrar la conexión
+  ADMISSION_DROP   // Rechazarla con 503
+};
+
+// AdmissionQueue: CoDel admission control for new connections
+//
+// Accepted connections wait here until the worker has room for them: a
+// free connection slot, and a loop that is not lagging. Instead of
+// refusing every connection past the limit, the queue absorbs spikes and
+// only sheds load when the time connections spend in it (their sojourn)
+// stays above the target for a whole interval, as CoDel does with
+// packets. It then refuses the head, more often while the delay persists
+// (interval / sqrt(drops)), and stops as soon as the delay is back below
+// the target.
+//
+// The sojourn grows when slots are not released (slow requests) and when
+// the loop falls behind, so both drive the decision.
+class AdmissionQueue {
+ public:
+  struct Pending {
+    int           fd;
+    int           port;
+    unsigned int  addr; // IPv4 del cliente, en orden de red
+    unsigned long queued_ms;
+  };
+
+  AdmissionQueue();
+
+  void configure(unsigned int target_ms, unsigned int interval_ms, size_t max_size);
+  void push(int fd, int port, unsigned int addr, unsigned long now_ms);
+  bool pop(Pending &pending);
+  bool full() const;
+  bool empty() const;
+
+  AdmissionDecision next(unsigned long now_ms, bool can_admit, Pending &pending);
+  int               nextTimeout(unsigned long now_ms) const;
+
+  void recordLag(unsigned long lag_ms);
+  bool lagging() const;
+
+ private:
+  std::deque<Pending> _queue;
+  size_t              _max_size;
+  unsigned int        _target_ms;
+  unsigned int        _interval_ms;
+  unsigned long       _first_above_ms; // Cuándo se puede empezar a rechazar, 0 si el retardo es bajo
+  unsigned long       _drop_next_ms;
+  unsigned int        _drop_count;
+  bool                _dropping;
+  unsigned long       _lag_ms; // Media móvil del tiempo de una vuelta del bucle
+
+  bool          aboveTarget(unsigned long now_ms);
+  unsigned long controlLaw(unsigned long t) const;
+};
+
+#endif // ADMISSION_QUEUE_HPP
@@ -0,0 +1,60 @@
+#include "BufferPool.hpp"
+
+#include "Logger/includes/Logger.hpp"
+
+BufferPool::BufferPool() : _free(NULL), _in_use(0) {}
+
+BufferPool::~BufferPool() {
+  for (size_t i = 0; i < _slabs.size(); ++i) {
+    delete[] _slabs[i];
+  }
+}
+
+/**
+ * @brief Hands out a block, growing the pool by a slab if none is free.
+ *
+ * @return The block; its contents are undefined.
+ */
+IoBlock *BufferPool::acquire() {
+  if (_free == NULL) {
+    grow();
+  }
+  IoBlock *block = _free;
+  _free          = block->next_free;
+  ++_in_use;
+  return block;
+}
+
+/**
+ * @brief Gives a block back to the pool.
+ */
+void BufferPool::release(IoBlock *block) {
+  block->next_free = _free;
+  _free            = block;
+  --_in_use;
+}
+
+/**
+ * @brief Blocks currently handed out.
+ */
+size_t BufferPool::inUse() const {
+  return _in_use;
+}
+
+/**
+ * @brief Blocks owned by the pool, in use or free.
+ */
+size_t BufferPool::capacity() const {
+  return _slabs.size() * BUFFER_POOL_SLAB_BLOCKS;
+}
+
+void BufferPool::grow() {
+  IoBlock *slab = new IoBlock[BUFFER_POOL_SLAB_BLOCKS];
+
+  _slabs.push_back(slab);
+  for (int i = BUFFER_POOL_SLAB_BLOCKS - 1; i >= 0; --i) {
+    slab[i].next_free = _free;
+    _free             = &slab[i];
+  }
+  LOG_DEBUG("Buffer pool grown to " << capacity() << " blocks of " << IO_BLOCK_SIZE << " bytes");
+}
@@ -0,0 +1,54 @@
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+// Size of a pooled I/O block (power of two, see InputBuffer)
+#define IO_BLOCK_SIZE 8192
+// Blocks allocated at once when the pool runs out
+#define BUFFER_POOL_SLAB_BLOCKS 32
+
+// Alignment of IoBlock::data, which the RequestArena relies on
+#define IO_BLOCK_ALIGN 16
+
+// Fixed-size block handed out by the BufferPool. The free-list link is padded
+// to IO_BLOCK_ALIGN so data keeps the alignment of the slab it comes from.
+struct IoBlock {
+  union {
+    IoBlock *next_free;
+    char     header[IO_BLOCK_ALIGN];
+  };
+  char data[IO_BLOCK_SIZE];
+};
+
+// BufferPool: slab allocator of fixed-size I/O blocks
+//
+// Blocks are carved from slabs of BUFFER_POOL_SLAB_BLOCKS and recycled
+// through a free list, so acquiring and releasing one never touches the
+// heap once the pool has grown to the peak number of blocks in use. Slabs
+// are only freed with the pool: under a steady load the heap stays flat.
+class BufferPool {
+ public:
+  BufferPool();
+  ~BufferPool();
+
+  IoBlock *acquire();
+  void     release(IoBlock *block);
+
+  size_t inUse() const;
+  size_t capacity() const;
+
+ private:
+  std::vector<IoBlock *> _slabs;
+  IoBlock               *_free;
+  size_t                 _in_use;
+
+  void grow();
+
+  BufferPool(const BufferPool &);
+  BufferPool &operator=(const BufferPool &);
+};
+
+#endif // BUFFER_POOL_HPP
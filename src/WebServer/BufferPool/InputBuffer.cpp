@@ -0,0 +1,218 @@
+#include "InputBuffer.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+InputBuffer::InputBuffer() : _pool(NULL), _head(0), _size(0) {}
+
+InputBuffer::~InputBuffer() {
+  clear();
+}
+
+/**
+ * @brief Sets the pool the blocks come from. Must be called before the
+ *        first read, and not changed while the buffer holds blocks.
+ */
+void InputBuffer::setPool(BufferPool *pool) {
+  _pool = pool;
+}
+
+/**
+ * @brief Receives from a socket into the end of the buffer.
+ *
+ * One recvmsg fills the space left in the last block and a new block, so a
+ * read is never limited to the few bytes at the end of a block.
+ *
+ * @return What recvmsg returned: bytes added, 0 on EOF, -1 with errno set.
+ */
+ssize_t InputBuffer::readFrom(int socket) {
+  size_t       end  = _head + _size;
+  size_t       used = end % IO_BLOCK_SIZE;
+  struct iovec iov[2];
+  int          count = 0;
+
+  if (used != 0) {
+    iov[count].iov_base = _blocks.back()->data + used;
+    iov[count].iov_len  = IO_BLOCK_SIZE - used;
+    ++count;
+  }
+  _blocks.push_back(_pool->acquire());
+  iov[count].iov_base = _blocks.back()->data;
+  iov[count].iov_len  = IO_BLOCK_SIZE;
+  ++count;
+
+  struct msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov    = iov;
+  message.msg_iovlen = count;
+
+  ssize_t received = recvmsg(socket, &message, MSG_DONTWAIT);
+  if (received > 0) {
+    _size += received;
+  }
+  // Devuelve el bloque nuevo si no ha llegado nada a él
+  truncate(_size);
+  return received;
+}
+
+/**
+ * @brief Copies bytes received elsewhere (an io_uring provided buffer) to
+ *        the end of the buffer.
+ */
+void InputBuffer::append(const char *data, size_t length) {
+  while (length > 0) {
+    size_t end = _head + _size;
+    if (end == _blocks.size() * IO_BLOCK_SIZE) {
+      _blocks.push_back(_pool->acquire());
+    }
+    size_t used  = end % IO_BLOCK_SIZE;
+    size_t chunk = std::min(length, IO_BLOCK_SIZE - used);
+    std::memcpy(_blocks.back()->data + used, data, chunk);
+    _size += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+}
+
+/**
+ * @brief Drops length bytes from the front of the buffer.
+ */
+void InputBuffer::consume(size_t length) {
+  length = std::min(length, _size);
+  if (length == _size) {
+    clear();
+    return;
+  }
+  _head += length;
+  _size -= length;
+  size_t done = _head / IO_BLOCK_SIZE;
+  for (size_t i = 0; i < done; ++i) {
+    _pool->release(_blocks[i]);
+  }
+  _blocks.erase(_blocks.begin(), _blocks.begin() + done);
+  _head %= IO_BLOCK_SIZE;
+}
+
+/**
+ * @brief Removes a range from the middle of the buffer, moving the bytes
+ *        after it down.
+ */
+void InputBuffer::erase(size_t offset, size_t length) {
+  if (offset >= _size)
+    return;
+  length = std::min(length, _size - offset);
+
+  size_t to   = offset;
+  size_t from = offset + length;
+  while (from < _size) {
+    size_t      from_length = _size - from;
+    const char *source      = contiguous(from, from_length);
+    size_t      to_length   = from_length;
+    char       *target      = const_cast<char *>(contiguous(to, to_length));
+    std::memmove(target, source, to_length);
+    from += to_length;
+    to += to_length;
+  }
+  truncate(_size - length);
+}
+
+/**
+ * @brief Empties the buffer and returns all its blocks to the pool.
+ */
+void InputBuffer::clear() {
+  for (size_t i = 0; i < _blocks.size(); ++i) {
+    _pool->release(_blocks[i]);
+  }
+  _blocks.clear();
+  _head = 0;
+  _size = 0;
+}
+
+/**
+ * @brief The bytes stored contiguously from an offset.
+ *
+ * @param offset Offset of the first byte, below size().
+ * @param length In: bytes wanted. Out: bytes available at the returned
+ *               pointer, up to the end of the block.
+ */
+const char *InputBuffer::contiguous(size_t offset, size_t &length) const {
+  size_t index = _head + offset;
+  length       = std::min(length, std::min(_size - offset, IO_BLOCK_SIZE - index % IO_BLOCK_SIZE));
+  return _blocks[index / IO_BLOCK_SIZE]->data + index % IO_BLOCK_SIZE;
+}
+
+/**
+ * @brief Offset of the first c at or after from, npos if there is none.
+ */
+size_t InputBuffer::find(char c, size_t from) const {
+  while (from < _size) {
+    size_t      length = _size - from;
+    const char *data   = contiguous(from, length);
+    const char *found  = static_cast<const char *>(std::memchr(data, c, length));
+    if (found != NULL)
+      return from + (found - data);
+    from += length;
+  }
+  return std::string::npos;
+}
+
+/**
+ * @brief Copies length bytes from offset to out. The range must be inside
+ *        the buffer.
+ */
+void InputBuffer::copy(size_t offset, size_t length, char *out) const {
+  while (length > 0) {
+    size_t      piece = length;
+    const char *data  = contiguous(offset, piece);
+    std::memcpy(out, data, piece);
+    out += piece;
+    offset += piece;
+    length -= piece;
+  }
+}
+
+/**
+ * @brief Copies a range out of the buffer.
+ */
+std::string InputBuffer::substr(size_t offset, size_t length) const {
+  std::string text;
+  if (offset >= _size)
+    return text;
+  length = std::min(length, _size - offset);
+  text.resize(length);
+  copy(offset, length, &text[0]);
+  return text;
+}
+
+/**
+ * @brief Compares length bytes at offset with literal, ignoring case.
+ */
+bool InputBuffer::equalsIgnoreCase(size_t offset, const char *literal, size_t length) const {
+  if (offset + length > _size)
+    return false;
+  for (size_t i = 0; i < length; ++i) {
+    if (std::tolower(static_cast<unsigned char>((*this)[offset + i])) !=
+        std::tolower(static_cast<unsigned char>(literal[i])))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Shortens the buffer to size bytes, releasing the blocks past it.
+ */
+void InputBuffer::truncate(size_t size) {
+  if (size == 0) {
+    clear();
+    return;
+  }
+  _size         = size;
+  size_t blocks = (_head + _size + IO_BLOCK_SIZE - 1) / IO_BLOCK_SIZE;
+  while (_blocks.size() > blocks) {
+    _pool->release(_blocks.back());
+    _blocks.pop_back();
+  }
+}
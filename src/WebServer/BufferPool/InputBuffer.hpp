@@ -0,0 +1,60 @@
+#ifndef INPUT_BUFFER_HPP
+#define INPUT_BUFFER_HPP
+
+//------------------------------------------------------------------------------
+#include "BufferPool.hpp"
+//------------------------------------------------------------------------------
+#include <sys/types.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// InputBuffer: bytes received on a connection, in a chain of pooled blocks
+//
+// recv writes straight into the free space of the last block and into a
+// fresh one, so nothing is copied on the way in and the buffer never
+// reallocates. Bytes are addressed by their offset from the start of the
+// buffer; as every block has the same size, finding one is a shift and a
+// mask. Consuming bytes at the front returns the blocks left behind to the
+// pool, and an empty buffer holds no block at all, so idle keep-alive
+// connections cost no buffer memory.
+class InputBuffer {
+ public:
+  InputBuffer();
+  ~InputBuffer();
+
+  void setPool(BufferPool *pool);
+
+  ssize_t readFrom(int socket);
+  void    append(const char *data, size_t length);
+  void    consume(size_t length);
+  void    erase(size_t offset, size_t length);
+  void    clear();
+
+  size_t size() const { return _size; }
+  bool   empty() const { return _size == 0; }
+
+  char operator[](size_t offset) const {
+    size_t index = _head + offset;
+    return _blocks[index / IO_BLOCK_SIZE]->data[index % IO_BLOCK_SIZE];
+  }
+
+  const char *contiguous(size_t offset, size_t &length) const;
+  size_t      find(char c, size_t from) const;
+  void        copy(size_t offset, size_t length, char *out) const;
+  std::string substr(size_t offset, size_t length) const;
+  bool        equalsIgnoreCase(size_t offset, const char *literal, size_t length) const;
+
+ private:
+  BufferPool            *_pool;
+  std::vector<IoBlock *> _blocks;
+  size_t                 _head; // Primer byte válido dentro del primer bloque
+  size_t                 _size;
+
+  void truncate(size_t size);
+
+  InputBuffer(const InputBuffer &);
+  InputBuffer &operator=(const InputBuffer &);
+};
+
+#endif // INPUT_BUFFER_HPP
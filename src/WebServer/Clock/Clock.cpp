@@ -0,0 +1,132 @@
+#include "Clock.hpp"
+
+#include <time.h>
+
+// Los relojes _COARSE son de Linux; en otro sistema se usan los normales
+#ifndef CLOCK_MONOTONIC_COARSE
+#define CLOCK_MONOTONIC_COARSE CLOCK_MONOTONIC
+#endif
+#ifndef CLOCK_REALTIME_COARSE
+#define CLOCK_REALTIME_COARSE CLOCK_REALTIME
+#endif
+
+bool           Clock::_held         = false;
+unsigned long  Clock::_monotonic_ms = 0;
+struct timeval Clock::_wall;
+time_t         Clock::_second = static_cast<time_t>(-1);
+std::string    Clock::_http_date;
+std::string    Clock::_date_header;
+std::string    Clock::_log_time;
+
+/**
+ * @brief Reads the clocks; the date strings are rebuilt when the second
+ *        changes, the milliseconds of the log timestamp on every call.
+ */
+void Clock::update() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+  _monotonic_ms = static_cast<unsigned long>(ts.tv_sec) * 1000UL + ts.tv_nsec / 1000000;
+
+  clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+  _wall.tv_sec  = ts.tv_sec;
+  _wall.tv_usec = ts.tv_nsec / 1000;
+  if (ts.tv_sec != _second) {
+    formatSecond();
+  }
+
+  // Solo cambian los milisegundos: "YYYY-mm-dd HH:MM:SS.mmm"
+  unsigned int millis = _wall.tv_usec / 1000;
+  size_t       end    = _log_time.size();
+  _log_time[end - 3]  = '0' + millis / 100;
+  _log_time[end - 2]  = '0' + millis / 10 % 10;
+  _log_time[end - 1]  = '0' + millis % 10;
+}
+
+/**
+ * @brief Reads the clocks and keeps their values until release(): the
+ *        start of an event loop iteration.
+ */
+void Clock::hold() {
+  update();
+  _held = true;
+}
+
+/**
+ * @brief Ends the iteration: until the next hold(), every read refreshes
+ *        the clock.
+ */
+void Clock::release() {
+  _held = false;
+}
+
+/**
+ * @brief Milliseconds of the monotonic clock at the start of the
+ *        iteration, or now outside one.
+ */
+unsigned long Clock::monotonicMs() {
+  if (!_held)
+    update();
+  return _monotonic_ms;
+}
+
+/**
+ * @brief Wall clock seconds at the start of the iteration, or now outside
+ *        one.
+ */
+time_t Clock::seconds() {
+  if (!_held)
+    update();
+  return _wall.tv_sec;
+}
+
+const struct timeval &Clock::wallTime() {
+  if (!_held)
+    update();
+  return _wall;
+}
+
+/**
+ * @brief The time of the last update as an HTTP date (IMF-fixdate):
+ *        "Sun, 18 Oct 2026 10:00:00 GMT".
+ */
+const std::string &Clock::httpDate() {
+  if (!_held)
+    update();
+  return _http_date;
+}
+
+/**
+ * @brief The whole Date header line, ready to be sent.
+ */
+const std::string &Clock::dateHeader() {
+  if (!_held)
+    update();
+  return _date_header;
+}
+
+/**
+ * @brief Local time of the last update with milliseconds, as the Logger
+ *        prints it: "2026-10-18 10:00:00.123".
+ */
+const std::string &Clock::logTime() {
+  if (!_held)
+    update();
+  return _log_time;
+}
+
+void Clock::formatSecond() {
+  time_t    now = _wall.tv_sec;
+  struct tm tm;
+  char      buf[64];
+
+  gmtime_r(&now, &tm);
+  strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  _http_date   = buf;
+  _date_header = "Date: " + _http_date + "\r\n";
+
+  localtime_r(&now, &tm);
+  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S.000", &tm);
+  _log_time = buf;
+  _second   = now;
+}
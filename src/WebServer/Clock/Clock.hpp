@@ -0,0 +1,52 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+//------------------------------------------------------------------------------
+#include <sys/time.h>
+#include <ctime>
+#include <string>
+
+// Clock: coarse time shared by the event loop
+//
+// The loop calls hold() once per iteration; everything that only needs
+// the time of the iteration (timestamps of log lines, the Date header,
+// deadlines) reads the cached values instead of asking the kernel and
+// formatting dates on every call. The loop calls release() before it
+// waits; outside an iteration (start-up, a worker right after fork, the
+// master process) every read refreshes the clock, so nothing logged there
+// gets the time of an iteration that has already ended. The clocks are the _COARSE variants,
+// read from the vDSO without a system call, and the formatted strings are
+// only rebuilt when the second changes.
+//
+// Latencies that must include the work done inside an iteration still use
+// a precise clock (TimerWheel::nowMs, AccessLog::nowUs).
+//
+// Not thread-safe: it is updated and read by the thread of the event loop.
+class Clock {
+ public:
+  static void update();
+  static void hold();
+  static void release();
+
+  static unsigned long         monotonicMs();
+  static time_t                seconds();
+  static const struct timeval &wallTime();
+  static const std::string    &httpDate();
+  static const std::string    &dateHeader();
+  static const std::string    &logTime();
+
+ private:
+  static bool           _held; // Dentro de una vuelta del bucle: no se relee
+  static unsigned long  _monotonic_ms;
+  static struct timeval _wall;
+  static time_t         _second; // Segundo de las cadenas formateadas
+  static std::string    _http_date;
+  static std::string    _date_header; // "Date: <http_date>\r\n"
+  static std::string    _log_time;
+
+  static void formatSecond();
+
+  Clock();
+};
+
+#endif // CLOCK_HPP
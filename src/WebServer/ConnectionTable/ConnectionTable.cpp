@@ -0,0 +1,140 @@
+#include "ConnectionTable.hpp"
+
+ConnectionTable::ConnectionTable(BufferPool &pool) : _pool(pool), _free_head(-1), _size(0), _capacity(0) {}
+
+ConnectionTable::~ConnectionTable() {
+  for (size_t i = 0; i < _chunks.size(); ++i) {
+    delete[] _chunks[i];
+  }
+}
+
+ConnectionTable::Slot *ConnectionTable::slotAt(size_t index) const {
+  return &_chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+}
+
+/**
+ * @brief Adds a new chunk of slots and pushes them to the free list.
+ *
+ * Slots are linked so that the lowest index is handed out first, keeping
+ * live connections packed at the start of the table.
+ */
+void ConnectionTable::grow() {
+  Slot  *chunk = new Slot[CHUNK_SIZE];
+  size_t base  = _capacity;
+
+  _chunks.push_back(chunk);
+  _capacity += CHUNK_SIZE;
+  for (int i = CHUNK_SIZE - 1; i >= 0; --i) {
+    chunk[i].client.slot = static_cast<unsigned int>(base + i);
+    chunk[i].client.input.setPool(&_pool);
+    chunk[i].next_free   = _free_head;
+    _free_head           = static_cast<int>(base + i);
+  }
+}
+
+/**
+ * @brief Registers a new connection for a socket.
+ *
+ * @param fd The client socket, must not be in the table already.
+ * @param id The client id used in the logs.
+ * @param port The server port that accepted the connection.
+ * @return The ClientInfo for the connection, NULL if fd is already in use.
+ */
+ClientInfo *ConnectionTable::insert(int fd, int id, int port) {
+  if (fd < 0 || find(fd) != NULL) {
+    return NULL;
+  }
+  if (_free_head < 0) {
+    grow();
+  }
+  Slot *slot = slotAt(_free_head);
+  _free_head = slot->next_free;
+
+  slot->in_use    = true;
+  slot->next_free = -1;
+  slot->client.reset(fd, id, port);
+
+  if (static_cast<size_t>(fd) >= _fd_to_slot.size()) {
+    _fd_to_slot.resize(fd + 1, -1);
+  }
+  _fd_to_slot[fd] = static_cast<int>(slot->client.slot);
+  ++_size;
+  return &slot->client;
+}
+
+ClientInfo *ConnectionTable::find(int fd) const {
+  if (fd < 0 || static_cast<size_t>(fd) >= _fd_to_slot.size() || _fd_to_slot[fd] < 0) {
+    return NULL;
+  }
+  return &slotAt(_fd_to_slot[fd])->client;
+}
+
+ClientInfo *ConnectionTable::get(const ConnectionRef &ref) const {
+  if (ref.slot >= _capacity) {
+    return NULL;
+  }
+  Slot *slot = slotAt(ref.slot);
+  if (!slot->in_use || slot->client.generation != ref.generation) {
+    return NULL;
+  }
+  return &slot->client;
+}
+
+/**
+ * @brief Returns the connection stored in a slot, NULL if the slot is free.
+ */
+ClientInfo *ConnectionTable::at(size_t index) const {
+  if (index >= _capacity) {
+    return NULL;
+  }
+  Slot *slot = slotAt(index);
+  return slot->in_use ? &slot->client : NULL;
+}
+
+ConnectionRef ConnectionTable::ref(const ClientInfo &client) const {
+  ConnectionRef ref;
+  ref.slot       = client.slot;
+  ref.generation = client.generation;
+  return ref;
+}
+
+/**
+ * @brief Releases the slot of a socket. Does nothing if fd is unknown.
+ *
+ * The caller is responsible for closing the socket.
+ */
+void ConnectionTable::erase(int fd) {
+  ClientInfo *client = find(fd);
+  if (client == NULL) {
+    return;
+  }
+  Slot *slot = slotAt(client->slot);
+
+  _fd_to_slot[fd] = -1;
+  slot->in_use    = false;
+  slot->next_free = _free_head;
+  _free_head      = static_cast<int>(client->slot);
+  ++client->generation;
+  client->socket = -1;
+  client->body.clear();
+  client->output.clear();
+  client->input.clear();
+  --_size;
+}
+
+void ConnectionTable::clear() {
+  for (size_t i = 0; i < _capacity; ++i) {
+    ClientInfo *client = at(i);
+    if (client != NULL) {
+      erase(client->socket);
+    }
+  }
+}
+
+size_t ConnectionTable::size() const {
+  return _size;
+}
+
+size_t ConnectionTable::capacity() const {
+  return _capacity;
+}
@@ -0,0 +1,68 @@
+#ifndef CONNECTION_TABLE_HPP
+#define CONNECTION_TABLE_HPP
+
+//------------------------------------------------------------------------------
+#include "CommonDefinitions.hpp"
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+// Weak reference to a connection. It stays safe to resolve after the
+// connection is closed: the slot generation will no longer match.
+struct ConnectionRef {
+  unsigned int slot;
+  unsigned int generation;
+};
+
+// ConnectionTable: fd-indexed slab of ClientInfo
+//
+// Slots are allocated in fixed-size chunks that are never moved, so a
+// ClientInfo pointer stays valid until that connection is erased. Closed
+// slots go to a free list and are reused by the next connection; each
+// reuse bumps the slot generation. Input buffers take their blocks from
+// the BufferPool and give them back when the connection is erased.
+//
+// insert, find and erase are O(1). Iteration walks the slots in order and
+// skips the free ones.
+class ConnectionTable {
+ public:
+  explicit ConnectionTable(BufferPool &pool);
+  ~ConnectionTable();
+
+  ClientInfo *insert(int fd, int id, int port);
+  ClientInfo *find(int fd) const;
+  ClientInfo *get(const ConnectionRef &ref) const;
+  ClientInfo *at(size_t slot) const;
+  void        erase(int fd);
+  void        clear();
+
+  ConnectionRef ref(const ClientInfo &client) const;
+  size_t        size() const;
+  size_t        capacity() const;
+
+ private:
+  enum { CHUNK_SIZE = 256 };
+
+  struct Slot {
+    ClientInfo client;
+    bool       in_use;
+    int        next_free;
+
+    Slot() : in_use(false), next_free(-1) {}
+  };
+
+  BufferPool         &_pool;
+  std::vector<Slot *> _chunks;
+  std::vector<int>    _fd_to_slot;
+  int                 _free_head;
+  size_t              _size;
+  size_t              _capacity;
+
+  Slot *slotAt(size_t index) const;
+  void  grow();
+
+  ConnectionTable(const ConnectionTable &);
+  ConnectionTable &operator=(const ConnectionTable &);
+};
+
+#endif // CONNECTION_TABLE_HPP
@@ -0,0 +1,80 @@
+#include "EventLoop.hpp"
+#include "Logger/includes/Logger.hpp"
+
+#include <sys/socket.h>
+
+/**
+ * @brief Creates the event loop backend requested in the configuration.
+ *
+ * "epoll" (the default on Linux) selects the edge-triggered epoll backend,
+ * "io_uring" the io_uring one and "select" forces the portable fallback.
+ * If io_uring cannot be initialized epoll is used instead, and select if
+ * epoll cannot be initialized either.
+ *
+ * @param engine The value of the `event_engine` directive (may be empty).
+ * @return A heap allocated EventLoop owned by the caller.
+ */
+EventLoop *EventLoop::create(const std::string &engine) {
+  if (!engine.empty() && engine != "epoll" && engine != "io_uring" && engine != "select") {
+    LOG_WARNING("Unknown event engine '" << engine << "', using the default one");
+  }
+#ifdef EVENT_LOOP_URING
+  if (engine == "io_uring") {
+    UringEventLoop *loop = new UringEventLoop();
+    if (loop->isValid()) {
+      return loop;
+    }
+    LOG_ERROR("io_uring initialization failed, falling back to epoll");
+    delete loop;
+  }
+#endif
+#ifdef __linux__
+  if (engine != "select") {
+    EpollEventLoop *loop = new EpollEventLoop();
+    if (loop->isValid()) {
+      return loop;
+    }
+    LOG_ERROR("epoll initialization failed, falling back to select");
+    delete loop;
+  }
+#endif
+  return new SelectEventLoop();
+}
+
+/**
+ * @brief Watches a listening socket for incoming connections.
+ */
+bool EventLoop::addListener(int fd) {
+  return add(fd, IO_READ);
+}
+
+/**
+ * @brief Watches a client connection; IO_READ is reported when receive()
+ *        has something to return.
+ */
+bool EventLoop::addConnection(int fd, unsigned int events) {
+  return add(fd, events);
+}
+
+/**
+ * @brief Takes the next connection of a listening socket, non-blocking and
+ *        close-on-exec.
+ *
+ * @param addr Filled with the address of the client, may be NULL.
+ * @return The socket, -1 with errno set (EAGAIN when there is none).
+ */
+int EventLoop::accept(int fd, struct sockaddr_in *addr) {
+  socklen_t addrlen = sizeof(*addr);
+  return accept4(fd, reinterpret_cast<struct sockaddr *>(addr), addr != NULL ? &addrlen : NULL,
+                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+}
+
+/**
+ * @brief Appends what has been received on a connection to its buffer.
+ *
+ * @return Bytes added, 0 on EOF, -1 with errno set (EAGAIN when there is
+ *         nothing).
+ */
+ssize_t EventLoop::receive(int fd, InputBuffer &input) {
+  return input.readFrom(fd);
+}
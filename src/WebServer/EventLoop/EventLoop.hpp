@@ -0,0 +1,237 @@
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+//------------------------------------------------------------------------------
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/types.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define EVENT_LOOP_URING
+#endif
+#endif
+#endif
+#include <deque>
+#include <string>
+#include <vector>
+#include "WebServer/BufferPool/InputBuffer.hpp"
+
+// -----------------------------------------------------------------------------
+// IoEvent: readiness reported by an EventLoop for a single file descriptor.
+// -----------------------------------------------------------------------------
+enum IoEventFlags {
+  IO_READ  = 1,
+  IO_WRITE = 2,
+  IO_ERROR = 4
+};
+
+struct IoEvent {
+  int          fd;
+  unsigned int events;
+};
+
+// EventLoop: readiness notification backend used by WebServer::run
+//
+// Interest is registered once per descriptor and updated in O(1) with
+// modify(). wait() only returns descriptors that are ready, so the caller
+// never has to walk every connection on a wakeup.
+//
+// Backends may be edge-triggered (epoll): readiness is reported once per
+// transition, so callers must always drain a descriptor (recv/accept/send
+// until EAGAIN) before waiting again. Doing so is also correct for the
+// level-triggered select() fallback.
+//
+// Listening sockets and connections are registered with addListener() and
+// addConnection(), and accepted and read through accept() and receive().
+// By default these are readiness plus accept4/recvmsg; a backend that
+// completes the operations itself (io_uring) reports IO_READ once it holds
+// accepted sockets or received bytes, and hands them out from there.
+class EventLoop {
+ public:
+  virtual ~EventLoop() {}
+
+  virtual const char *name() const                           = 0;
+  virtual bool        add(int fd, unsigned int events)        = 0;
+  virtual bool        modify(int fd, unsigned int events)     = 0;
+  virtual void        remove(int fd)                          = 0;
+  virtual int         wait(std::vector<IoEvent> &ready, int timeout_ms) = 0;
+
+  virtual bool    addListener(int fd);
+  virtual bool    addConnection(int fd, unsigned int events);
+  virtual int     accept(int fd, struct sockaddr_in *addr);
+  virtual ssize_t receive(int fd, InputBuffer &input);
+
+  static EventLoop *create(const std::string &engine);
+};
+
+#ifdef __linux__
+// Edge-triggered epoll backend. No descriptor limit besides RLIMIT_NOFILE.
+class EpollEventLoop : public EventLoop {
+ public:
+  EpollEventLoop();
+  ~EpollEventLoop();
+
+  bool        isValid() const;
+  const char *name() const;
+  bool        add(int fd, unsigned int events);
+  bool        modify(int fd, unsigned int events);
+  void        remove(int fd);
+  int         wait(std::vector<IoEvent> &ready, int timeout_ms);
+
+ private:
+  int                              _epfd;
+  std::vector<struct epoll_event> _events;
+
+  EpollEventLoop(const EpollEventLoop &);
+  EpollEventLoop &operator=(const EpollEventLoop &);
+};
+#endif
+
+#ifdef EVENT_LOOP_URING
+// io_uring backend, driven by completions where the kernel allows it:
+//
+// - Listening sockets have a multishot accept request: the kernel accepts
+//   on its own and accept() hands out the sockets it already holds.
+// - Connections have a multishot recv request that picks its buffers from
+//   a ring of provided buffers (URING_RECV_BUFFERS of IO_BLOCK_SIZE), so
+//   receive() copies received bytes instead of making a recvmsg call. A
+//   connection holding URING_RECV_MAX_QUEUED unread buffers has its request
+//   cancelled until they are read, so a client that is not being read
+//   (a pending task, too much output) cannot drain the ring. One that
+//   finds the ring empty is read with recvmsg until a buffer comes back.
+// - Everything else (and connections waiting to write) has a multishot
+//   poll request, which stays armed across events like an edge-triggered
+//   epoll registration.
+//
+// Requests are queued in the submission ring and handed to the kernel
+// together with the wait: one io_uring_enter per loop iteration replaces
+// the epoll_ctl calls, the epoll_wait and the accept4/recvmsg calls.
+// Without provided buffer rings (kernel older than 5.19) or multishot recv
+// (6.0) the backend falls back to poll requests for the affected sockets.
+class UringEventLoop : public EventLoop {
+ public:
+  UringEventLoop();
+  ~UringEventLoop();
+
+  bool        isValid() const;
+  const char *name() const;
+  bool        add(int fd, unsigned int events);
+  bool        modify(int fd, unsigned int events);
+  void        remove(int fd);
+  int         wait(std::vector<IoEvent> &ready, int timeout_ms);
+
+  bool    addListener(int fd);
+  bool    addConnection(int fd, unsigned int events);
+  int     accept(int fd, struct sockaddr_in *addr);
+  ssize_t receive(int fd, InputBuffer &input);
+
+ private:
+  enum WatchKind {
+    WATCH_POLL,       // Solo poll
+    WATCH_LISTENER,   // accept multishot
+    WATCH_CONNECTION  // recv multishot; poll solo para escribir
+  };
+
+  // Datos recibidos en un buffer del anillo, aún sin entregar
+  struct Received {
+    unsigned short bid;
+    unsigned int   length;
+  };
+
+  struct Watch {
+    unsigned int         generation; // Distingue las peticiones de registros anteriores del fd
+    unsigned int         events;
+    bool                 active;
+    bool                 armed; // Hay una petición de poll en curso
+    size_t               ready; // Posición + 1 en el resultado de wait(), 0 si no está
+    int                  kind;
+    unsigned int         op_generation; // Lo mismo para la petición de accept o recv
+    bool                 op_inflight;   // La petición de accept o recv sigue en el kernel
+    bool                 op_paused;     // recv cancelado hasta que se lea lo recibido
+    bool                 starved;       // recv sin buffers: se lee con poll hasta que se libere uno
+    bool                 eof;
+    int                  error;
+    std::deque<Received> received;
+    std::deque<int>      accepted;
+
+    Watch()
+        : generation(0),
+          events(0),
+          active(false),
+          armed(false),
+          ready(0),
+          kind(WATCH_POLL),
+          op_generation(0),
+          op_inflight(false),
+          op_paused(false),
+          starved(false),
+          eof(false),
+          error(0) {}
+  };
+
+  int                  _ring_fd;
+  void                *_ring;
+  size_t               _ring_size;
+  struct io_uring_sqe *_sqes;
+  size_t               _sqes_size;
+  unsigned int         _sq_entries;
+  unsigned int        *_sq_head;
+  unsigned int        *_sq_tail;
+  unsigned int        *_sq_mask;
+  unsigned int        *_sq_array;
+  unsigned int        *_cq_head;
+  unsigned int        *_cq_tail;
+  unsigned int        *_cq_mask;
+  struct io_uring_cqe *_cqes;
+  std::vector<Watch>   _watches;
+  std::vector<int>     _rearm;    // Poll terminado por el kernel
+  std::vector<int>     _rearm_op; // accept o recv terminado por el kernel
+  std::vector<int>     _starved;  // recv terminado por falta de buffers
+  bool                 _accept;   // accept multishot disponible
+  bool                 _recv;     // recv multishot con buffers del anillo disponible
+  char                *_buffers;
+  struct io_uring_buf *_buf_ring;
+  unsigned short       _buf_tail;
+
+  struct io_uring_sqe *nextSqe();
+  bool                 insert(int fd, unsigned int events, int kind);
+  bool                 setupBuffers();
+  void                 releaseBuffer(unsigned short bid);
+  bool                 arm(int fd);
+  bool                 disarm(int fd);
+  bool                 armOp(int fd);
+  void                 cancelOp(int fd);
+  void                 rearmPending();
+  void                 complete(const struct io_uring_cqe &cqe, std::vector<IoEvent> &ready);
+  unsigned int         completePoll(Watch &watch, const struct io_uring_cqe &cqe, int fd);
+  unsigned int         completeAccept(Watch &watch, const struct io_uring_cqe &cqe, int fd);
+  unsigned int         completeRecv(Watch &watch, const struct io_uring_cqe &cqe, int fd);
+  void                 fallBackToPoll(int fd);
+  int                  submit(unsigned int min_complete, unsigned int flags, void *arg, size_t arg_size);
+
+  UringEventLoop(const UringEventLoop &);
+  UringEventLoop &operator=(const UringEventLoop &);
+};
+#endif
+
+// Portable level-triggered select() backend, limited to FD_SETSIZE.
+class SelectEventLoop : public EventLoop {
+ public:
+  SelectEventLoop();
+
+  const char *name() const;
+  bool        add(int fd, unsigned int events);
+  bool        modify(int fd, unsigned int events);
+  void        remove(int fd);
+  int         wait(std::vector<IoEvent> &ready, int timeout_ms);
+
+ private:
+  fd_set _read_set;
+  fd_set _write_set;
+  int    _max_fd;
+};
+
+#endif // EVENT_LOOP_HPP
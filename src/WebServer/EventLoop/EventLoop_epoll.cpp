@@ -0,0 +1,110 @@
+#include "EventLoop.hpp"
+#include "Logger/includes/Logger.hpp"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <unistd.h>
+#include <cstring>
+
+// Number of events fetched per epoll_wait call. Grows when it gets filled up.
+#define EPOLL_INITIAL_EVENTS 256
+
+static unsigned int toEpollEvents(unsigned int events) {
+  unsigned int result = EPOLLET | EPOLLRDHUP;
+  if (events & IO_READ)
+    result |= EPOLLIN;
+  if (events & IO_WRITE)
+    result |= EPOLLOUT;
+  return result;
+}
+
+EpollEventLoop::EpollEventLoop() : _epfd(epoll_create1(EPOLL_CLOEXEC)), _events(EPOLL_INITIAL_EVENTS) {
+  if (_epfd < 0) {
+    LOG_ERROR("epoll_create1 failed: " << strerror(errno));
+  }
+}
+
+EpollEventLoop::~EpollEventLoop() {
+  if (_epfd >= 0) {
+    close(_epfd);
+  }
+}
+
+bool EpollEventLoop::isValid() const {
+  return _epfd >= 0;
+}
+
+const char *EpollEventLoop::name() const {
+  return "epoll";
+}
+
+bool EpollEventLoop::add(int fd, unsigned int events) {
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events  = toEpollEvents(events);
+  ev.data.fd = fd;
+  if (epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+    LOG_ERROR("epoll_ctl(ADD) failed for fd " << fd << ": " << strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Replaces the interest set of a registered descriptor.
+ *
+ * EPOLL_CTL_MOD re-arms the edge-triggered notification, so a descriptor that
+ * is already writable when IO_WRITE is requested is reported on the next wait.
+ */
+bool EpollEventLoop::modify(int fd, unsigned int events) {
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events  = toEpollEvents(events);
+  ev.data.fd = fd;
+  if (epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+    LOG_ERROR("epoll_ctl(MOD) failed for fd " << fd << ": " << strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+void EpollEventLoop::remove(int fd) {
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+/**
+ * @brief Waits for readiness and appends one IoEvent per ready descriptor.
+ *
+ * @param ready Output vector, cleared before filling.
+ * @param timeout_ms Maximum wait in milliseconds, -1 to block.
+ * @return Number of ready descriptors, 0 on timeout, -1 on error (errno set).
+ */
+int EpollEventLoop::wait(std::vector<IoEvent> &ready, int timeout_ms) {
+  ready.clear();
+  int count = epoll_wait(_epfd, &_events[0], static_cast<int>(_events.size()), timeout_ms);
+  if (count <= 0) {
+    return count;
+  }
+  for (int i = 0; i < count; ++i) {
+    IoEvent      event;
+    unsigned int flags = _events[i].events;
+    event.fd           = _events[i].data.fd;
+    event.events       = 0;
+    if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+      event.events |= IO_READ;
+    if (flags & EPOLLOUT)
+      event.events |= IO_WRITE;
+    if (flags & EPOLLERR)
+      event.events |= IO_ERROR | IO_READ;
+    ready.push_back(event);
+  }
+  if (count == static_cast<int>(_events.size())) {
+    _events.resize(_events.size() * 2);
+  }
+  return count;
+}
+
+#endif // __linux__
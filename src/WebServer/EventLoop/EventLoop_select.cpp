@@ -0,0 +1,89 @@
+#include "EventLoop.hpp"
+#include "Logger/includes/Logger.hpp"
+
+#include <sys/time.h>
+
+SelectEventLoop::SelectEventLoop() : _max_fd(-1) {
+  FD_ZERO(&_read_set);
+  FD_ZERO(&_write_set);
+}
+
+const char *SelectEventLoop::name() const {
+  return "select";
+}
+
+bool SelectEventLoop::add(int fd, unsigned int events) {
+  if (fd < 0 || fd >= FD_SETSIZE) {
+    LOG_ERROR("File descriptor " << fd << " exceeds FD_SETSIZE (" << FD_SETSIZE << ")");
+    return false;
+  }
+  if (fd > _max_fd) {
+    _max_fd = fd;
+  }
+  return modify(fd, events);
+}
+
+bool SelectEventLoop::modify(int fd, unsigned int events) {
+  if (fd < 0 || fd >= FD_SETSIZE) {
+    return false;
+  }
+  if (events & IO_READ)
+    FD_SET(fd, &_read_set);
+  else
+    FD_CLR(fd, &_read_set);
+  if (events & IO_WRITE)
+    FD_SET(fd, &_write_set);
+  else
+    FD_CLR(fd, &_write_set);
+  return true;
+}
+
+void SelectEventLoop::remove(int fd) {
+  if (fd < 0 || fd >= FD_SETSIZE) {
+    return;
+  }
+  FD_CLR(fd, &_read_set);
+  FD_CLR(fd, &_write_set);
+  while (_max_fd >= 0 && !FD_ISSET(_max_fd, &_read_set) && !FD_ISSET(_max_fd, &_write_set)) {
+    --_max_fd;
+  }
+}
+
+/**
+ * @brief Waits for readiness with select(), level-triggered.
+ *
+ * @param ready Output vector, cleared before filling.
+ * @param timeout_ms Maximum wait in milliseconds, -1 to block.
+ * @return Number of ready descriptors, 0 on timeout, -1 on error (errno set).
+ */
+int SelectEventLoop::wait(std::vector<IoEvent> &ready, int timeout_ms) {
+  ready.clear();
+  fd_set read_fds  = _read_set;
+  fd_set write_fds = _write_set;
+
+  struct timeval  timeout;
+  struct timeval *timeout_ptr = NULL;
+  if (timeout_ms >= 0) {
+    timeout.tv_sec  = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    timeout_ptr     = &timeout;
+  }
+
+  int activity = select(_max_fd + 1, &read_fds, &write_fds, NULL, timeout_ptr);
+  if (activity <= 0) {
+    return activity;
+  }
+  for (int fd = 0; fd <= _max_fd; ++fd) {
+    IoEvent event;
+    event.fd     = fd;
+    event.events = 0;
+    if (FD_ISSET(fd, &read_fds))
+      event.events |= IO_READ;
+    if (FD_ISSET(fd, &write_fds))
+      event.events |= IO_WRITE;
+    if (event.events) {
+      ready.push_back(event);
+    }
+  }
+  return static_cast<int>(ready.size());
+}
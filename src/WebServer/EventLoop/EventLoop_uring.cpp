@@ -0,0 +1,759 @@
+#include "EventLoop.hpp"
+#include "Logger/includes/Logger.hpp"
+
+#ifdef EVENT_LOOP_URING
+
+#include <endian.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+// Tamaño de la cola de envíos (la de resultados es el doble)
+#define URING_ENTRIES 1024
+// Buffers del anillo de recv (potencia de dos), de IO_BLOCK_SIZE bytes
+#define URING_RECV_BUFFERS 256
+// Buffers sin leer a partir de los que se para el recv de una conexión
+#define URING_RECV_MAX_QUEUED 8
+// Grupo de buffers del anillo
+#define URING_BUFFER_GROUP 0
+// Bits de la generación en user_data
+#define URING_GENERATION_MASK 0xffffffU
+
+// Petición a la que corresponde un resultado, en el byte alto de user_data
+enum UringOp {
+  URING_OP_POLL   = 1,
+  URING_OP_ACCEPT = 2,
+  URING_OP_RECV   = 3
+};
+
+// Multishot poll (5.13) no tiene bit propio; IORING_FEAT_RSRC_TAGS es de la misma versión
+#define URING_REQUIRED_FEATURES \
+  (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG | IORING_FEAT_RSRC_TAGS)
+
+static unsigned int toPollEvents(unsigned int events) {
+  unsigned int result = POLLRDHUP;
+  if (events & IO_READ)
+    result |= POLLIN;
+  if (events & IO_WRITE)
+    result |= POLLOUT;
+#if __BYTE_ORDER == __BIG_ENDIAN
+  // poll32_events se guarda con las mitades de 16 bits intercambiadas
+  result = (result << 16) | (result >> 16);
+#endif
+  return result;
+}
+
+// user_data de una petición: operación en el byte alto, luego 24 bits de
+// generación y el fd en la mitad baja. 0 marca las peticiones internas
+// (cancelaciones), cuyo resultado se ignora.
+static uint64_t userData(unsigned int op, int fd, unsigned int generation) {
+  return (static_cast<uint64_t>(op) << 56) | (static_cast<uint64_t>(generation & URING_GENERATION_MASK) << 32) |
+         static_cast<uint32_t>(fd);
+}
+
+UringEventLoop::UringEventLoop()
+    : _ring_fd(-1),
+      _ring(MAP_FAILED),
+      _ring_size(0),
+      _sqes(NULL),
+      _sqes_size(0),
+      _sq_entries(0),
+      _sq_head(NULL),
+      _sq_tail(NULL),
+      _sq_mask(NULL),
+      _sq_array(NULL),
+      _cq_head(NULL),
+      _cq_tail(NULL),
+      _cq_mask(NULL),
+      _cqes(NULL),
+      _accept(false),
+      _recv(false),
+      _buffers(static_cast<char *>(MAP_FAILED)),
+      _buf_ring(static_cast<struct io_uring_buf *>(MAP_FAILED)),
+      _buf_tail(0) {
+  struct io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CLAMP;
+
+  _ring_fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+  if (_ring_fd < 0) {
+    LOG_ERROR("io_uring_setup failed: " << strerror(errno));
+    return;
+  }
+  if ((params.features & URING_REQUIRED_FEATURES) != URING_REQUIRED_FEATURES) {
+    LOG_ERROR("io_uring lacks multishot poll or extended waits (kernel older than 5.13)");
+    close(_ring_fd);
+    _ring_fd = -1;
+    return;
+  }
+
+  // Con IORING_FEAT_SINGLE_MMAP las dos colas comparten la misma proyección
+  _ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+                        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+  _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  _ring      = mmap(NULL, _ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+  void *sqes = mmap(NULL, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+  if (_ring == MAP_FAILED || sqes == MAP_FAILED) {
+    LOG_ERROR("io_uring mmap failed: " << strerror(errno));
+    if (sqes != MAP_FAILED)
+      munmap(sqes, _sqes_size);
+    close(_ring_fd);
+    _ring_fd = -1;
+    return;
+  }
+
+  char *ring  = static_cast<char *>(_ring);
+  _sqes       = static_cast<struct io_uring_sqe *>(sqes);
+  _sq_entries = params.sq_entries;
+  _sq_head    = reinterpret_cast<unsigned int *>(ring + params.sq_off.head);
+  _sq_tail    = reinterpret_cast<unsigned int *>(ring + params.sq_off.tail);
+  _sq_mask    = reinterpret_cast<unsigned int *>(ring + params.sq_off.ring_mask);
+  _sq_array   = reinterpret_cast<unsigned int *>(ring + params.sq_off.array);
+  _cq_head    = reinterpret_cast<unsigned int *>(ring + params.cq_off.head);
+  _cq_tail    = reinterpret_cast<unsigned int *>(ring + params.cq_off.tail);
+  _cq_mask    = reinterpret_cast<unsigned int *>(ring + params.cq_off.ring_mask);
+  _cqes       = reinterpret_cast<struct io_uring_cqe *>(ring + params.cq_off.cqes);
+  for (unsigned int i = 0; i < _sq_entries; ++i) {
+    _sq_array[i] = i;
+  }
+
+  _accept = _recv = setupBuffers();
+  if (!_recv) {
+    LOG_WARNING("io_uring without provided buffer rings (kernel older than 5.19): sockets are polled");
+  }
+}
+
+UringEventLoop::~UringEventLoop() {
+  // Conexiones aceptadas por el kernel que nadie ha recogido
+  for (size_t fd = 0; fd < _watches.size(); ++fd) {
+    for (size_t i = 0; i < _watches[fd].accepted.size(); ++i) {
+      close(_watches[fd].accepted[i]);
+    }
+  }
+  if (_ring_fd >= 0) {
+    // Cierra el anillo antes de liberar la memoria que el kernel aún usa
+    close(_ring_fd);
+  }
+  if (_buf_ring != MAP_FAILED) {
+    munmap(_buf_ring, URING_RECV_BUFFERS * sizeof(struct io_uring_buf));
+  }
+  if (_buffers != MAP_FAILED) {
+    munmap(_buffers, URING_RECV_BUFFERS * IO_BLOCK_SIZE);
+  }
+  if (_sqes != NULL) {
+    munmap(_sqes, _sqes_size);
+  }
+  if (_ring != MAP_FAILED) {
+    munmap(_ring, _ring_size);
+  }
+}
+
+/**
+ * @brief Registers the ring of provided buffers that recv requests take
+ *        their buffers from.
+ *
+ * @return false if the kernel does not support it.
+ */
+bool UringEventLoop::setupBuffers() {
+  _buffers  = static_cast<char *>(mmap(NULL, URING_RECV_BUFFERS * IO_BLOCK_SIZE, PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  _buf_ring = static_cast<struct io_uring_buf *>(mmap(NULL, URING_RECV_BUFFERS * sizeof(struct io_uring_buf),
+                                                      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (_buffers != MAP_FAILED && _buf_ring != MAP_FAILED) {
+    for (unsigned int bid = 0; bid < URING_RECV_BUFFERS; ++bid) {
+      releaseBuffer(static_cast<unsigned short>(bid));
+    }
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = reinterpret_cast<uint64_t>(_buf_ring);
+    reg.ring_entries = URING_RECV_BUFFERS;
+    reg.bgid         = URING_BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0) {
+      return true;
+    }
+  }
+  if (_buf_ring != MAP_FAILED) {
+    munmap(_buf_ring, URING_RECV_BUFFERS * sizeof(struct io_uring_buf));
+    _buf_ring = static_cast<struct io_uring_buf *>(MAP_FAILED);
+  }
+  if (_buffers != MAP_FAILED) {
+    munmap(_buffers, URING_RECV_BUFFERS * IO_BLOCK_SIZE);
+    _buffers = static_cast<char *>(MAP_FAILED);
+  }
+  return false;
+}
+
+/**
+ * @brief Gives a buffer back to the kernel.
+ *
+ * recv requests that stopped because the ring was empty are re-armed.
+ */
+void UringEventLoop::releaseBuffer(unsigned short bid) {
+  struct io_uring_buf *buf = &_buf_ring[_buf_tail & (URING_RECV_BUFFERS - 1)];
+  buf->addr                = reinterpret_cast<uint64_t>(_buffers + static_cast<size_t>(bid) * IO_BLOCK_SIZE);
+  buf->len                 = IO_BLOCK_SIZE;
+  buf->bid                 = bid;
+  ++_buf_tail;
+  // La cola del anillo ocupa el campo resv de la primera entrada
+  unsigned short *tail = reinterpret_cast<unsigned short *>(reinterpret_cast<char *>(_buf_ring) +
+                                                            offsetof(struct io_uring_buf, resv));
+  __atomic_store_n(tail, _buf_tail, __ATOMIC_RELEASE);
+
+  _rearm_op.insert(_rearm_op.end(), _starved.begin(), _starved.end());
+  _starved.clear();
+}
+
+bool UringEventLoop::isValid() const {
+  return _ring_fd >= 0;
+}
+
+const char *UringEventLoop::name() const {
+  return "io_uring";
+}
+
+/**
+ * @brief Queues a multishot poll for a descriptor.
+ *
+ * The request reaches the kernel with the next wait(); a descriptor that is
+ * already ready is reported by that wait.
+ */
+bool UringEventLoop::add(int fd, unsigned int events) {
+  return insert(fd, events, WATCH_POLL);
+}
+
+/**
+ * @brief Registers a descriptor of any kind and arms its poll request, if
+ *        the kind needs one.
+ */
+bool UringEventLoop::insert(int fd, unsigned int events, int kind) {
+  if (fd < 0) {
+    return false;
+  }
+  if (static_cast<size_t>(fd) >= _watches.size()) {
+    _watches.resize(fd + 1);
+  }
+  Watch &watch = _watches[fd];
+  if (watch.active) {
+    LOG_ERROR("io_uring: descriptor " << fd << " is already registered");
+    return false;
+  }
+  watch.active = true;
+  watch.events = events;
+  watch.kind   = kind;
+  return arm(fd);
+}
+
+/**
+ * @brief Queues a multishot accept for a listening socket.
+ */
+bool UringEventLoop::addListener(int fd) {
+  if (!_accept) {
+    return add(fd, IO_READ);
+  }
+  if (!insert(fd, 0, WATCH_LISTENER)) {
+    return false;
+  }
+  if (!armOp(fd)) {
+    remove(fd);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Queues a multishot recv for a connection, plus a poll request
+ *        while IO_WRITE is wanted.
+ */
+bool UringEventLoop::addConnection(int fd, unsigned int events) {
+  if (!_recv) {
+    return add(fd, events);
+  }
+  if (!insert(fd, events, WATCH_CONNECTION)) {
+    return false;
+  }
+  if (!armOp(fd)) {
+    remove(fd);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Hands out a connection accepted by the kernel.
+ *
+ * The multishot request cannot return addresses, so the one of the client
+ * is read with getpeername, and only when asked for.
+ */
+int UringEventLoop::accept(int fd, struct sockaddr_in *addr) {
+  if (fd < 0 || static_cast<size_t>(fd) >= _watches.size() || _watches[fd].kind != WATCH_LISTENER) {
+    return EventLoop::accept(fd, addr);
+  }
+  Watch &watch = _watches[fd];
+  if (watch.accepted.empty()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  int client = watch.accepted.front();
+  watch.accepted.pop_front();
+  if (addr != NULL) {
+    socklen_t addrlen = sizeof(*addr);
+    if (getpeername(client, reinterpret_cast<struct sockaddr *>(addr), &addrlen) != 0) {
+      std::memset(addr, 0, sizeof(*addr));
+    }
+  }
+  return client;
+}
+
+/**
+ * @brief Copies the bytes the kernel received on a connection to its
+ *        buffer and gives the buffers back to the ring.
+ *
+ * A recv request cancelled because too much was queued is armed again;
+ * while the ring has no free buffers the socket is read directly.
+ */
+ssize_t UringEventLoop::receive(int fd, InputBuffer &input) {
+  if (fd < 0 || static_cast<size_t>(fd) >= _watches.size() || _watches[fd].kind != WATCH_CONNECTION) {
+    return EventLoop::receive(fd, input);
+  }
+  Watch &watch = _watches[fd];
+  if (watch.received.empty() && watch.starved) {
+    return EventLoop::receive(fd, input);
+  }
+  if (watch.received.empty()) {
+    if (watch.error != 0) {
+      errno = watch.error;
+      return -1;
+    }
+    if (watch.eof) {
+      return 0;
+    }
+    errno = EAGAIN;
+    return -1;
+  }
+
+  ssize_t total = 0;
+  while (!watch.received.empty()) {
+    const Received &received = watch.received.front();
+    input.append(_buffers + static_cast<size_t>(received.bid) * IO_BLOCK_SIZE, received.length);
+    total += received.length;
+    releaseBuffer(received.bid);
+    watch.received.pop_front();
+  }
+  if (watch.op_paused) {
+    watch.op_paused = false;
+    if (!watch.op_inflight) {
+      armOp(fd);
+    }
+  }
+  return total;
+}
+
+/**
+ * @brief Replaces the poll request of a descriptor with one for the new
+ *        events, so a descriptor that is already writable when IO_WRITE is
+ *        requested is reported on the next wait (as with EPOLL_CTL_MOD).
+ */
+bool UringEventLoop::modify(int fd, unsigned int events) {
+  if (fd < 0 || static_cast<size_t>(fd) >= _watches.size() || !_watches[fd].active) {
+    return false;
+  }
+  _watches[fd].events = events;
+  return disarm(fd) && arm(fd);
+}
+
+/**
+ * @brief Cancels the requests of a descriptor.
+ *
+ * The kernel keeps a reference to the file until the cancellation is
+ * submitted with the next wait(), so a descriptor closed right after is
+ * fully released then. An accept or recv request is submitted right away,
+ * though: otherwise a number reused by the next accepted connection would
+ * be resolved to the new socket, and its first bytes would go to a stale
+ * request. What was received and not read is dropped, and results still
+ * on their way are recognised as stale by their generation.
+ */
+void UringEventLoop::remove(int fd) {
+  if (fd < 0 || static_cast<size_t>(fd) >= _watches.size() || !_watches[fd].active) {
+    return;
+  }
+  Watch &watch = _watches[fd];
+  disarm(fd);
+  if (watch.op_inflight) {
+    cancelOp(fd);
+    submit(0, 0, NULL, 0);
+  }
+  ++watch.op_generation;
+  watch.op_inflight = false;
+  watch.op_paused   = false;
+  watch.starved     = false;
+  watch.eof         = false;
+  watch.error       = 0;
+  while (!watch.received.empty()) {
+    releaseBuffer(watch.received.front().bid);
+    watch.received.pop_front();
+  }
+  for (size_t i = 0; i < watch.accepted.size(); ++i) {
+    close(watch.accepted[i]);
+  }
+  watch.accepted.clear();
+  watch.kind   = WATCH_POLL;
+  watch.active = false;
+}
+
+/**
+ * @brief Submits the queued requests and waits for readiness.
+ *
+ * Completions for the same descriptor are merged into one IoEvent, and
+ * completions of cancelled or replaced requests are dropped.
+ *
+ * @param ready Output vector, cleared before filling.
+ * @param timeout_ms Maximum wait in milliseconds, -1 to block.
+ * @return Number of ready descriptors, 0 on timeout, -1 on error (errno set).
+ */
+int UringEventLoop::wait(std::vector<IoEvent> &ready, int timeout_ms) {
+  ready.clear();
+
+  struct __kernel_timespec     ts;
+  struct io_uring_getevents_arg arg;
+  std::memset(&ts, 0, sizeof(ts));
+  std::memset(&arg, 0, sizeof(arg));
+  if (timeout_ms >= 0) {
+    ts.tv_sec  = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    arg.ts     = reinterpret_cast<uint64_t>(&ts);
+  }
+  // Peticiones que el kernel terminó en la vuelta anterior
+  rearmPending();
+
+  if (submit(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)) < 0 && errno != ETIME) {
+    return -1;
+  }
+
+  unsigned int head = *_cq_head;
+  unsigned int tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    complete(_cqes[head & *_cq_mask], ready);
+  }
+  __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+
+  for (size_t i = 0; i < ready.size(); ++i) {
+    _watches[ready[i].fd].ready = 0;
+  }
+  return static_cast<int>(ready.size());
+}
+
+/**
+ * @brief Arms again the requests the kernel has finished (overflow, a
+ *        cancelled recv, an empty buffer ring...) that are still wanted.
+ */
+void UringEventLoop::rearmPending() {
+  for (size_t i = 0; i < _rearm.size(); ++i) {
+    int fd = _rearm[i];
+    if (_watches[fd].active && !_watches[fd].armed) {
+      arm(fd);
+    }
+  }
+  _rearm.clear();
+  for (size_t i = 0; i < _rearm_op.size(); ++i) {
+    Watch &watch = _watches[_rearm_op[i]];
+    if (watch.active && watch.starved) {
+      watch.starved = false;
+      disarm(_rearm_op[i]);
+      arm(_rearm_op[i]);
+    }
+    if (watch.active && watch.kind != WATCH_POLL && !watch.op_inflight && !watch.op_paused && !watch.eof &&
+        watch.error == 0) {
+      armOp(_rearm_op[i]);
+    }
+  }
+  _rearm_op.clear();
+}
+
+/**
+ * @brief Takes the next free submission entry, submitting the queue if it
+ *        is full.
+ *
+ * @return The cleared entry, NULL if the ring stays full.
+ */
+struct io_uring_sqe *UringEventLoop::nextSqe() {
+  unsigned int tail = *_sq_tail;
+  if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) {
+    submit(0, 0, NULL, 0);
+    if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) {
+      LOG_ERROR("io_uring submission queue is full");
+      return NULL;
+    }
+  }
+  struct io_uring_sqe *sqe = &_sqes[tail & *_sq_mask];
+  std::memset(sqe, 0, sizeof(*sqe));
+  __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+  return sqe;
+}
+
+/**
+ * @brief Queues the poll request of a descriptor. A connection whose reads
+ *        come from recv only needs one to wait for IO_WRITE, or to read
+ *        from the socket while the buffer ring is empty.
+ */
+bool UringEventLoop::arm(int fd) {
+  Watch       &watch  = _watches[fd];
+  unsigned int events = watch.kind == WATCH_POLL ? watch.events : (watch.events & IO_WRITE);
+  if (watch.starved) {
+    events |= IO_READ;
+  }
+  if (events == 0) {
+    return true;
+  }
+  struct io_uring_sqe *sqe = nextSqe();
+  if (sqe == NULL) {
+    return false;
+  }
+  ++watch.generation;
+  sqe->opcode        = IORING_OP_POLL_ADD;
+  sqe->fd            = fd;
+  sqe->len           = IORING_POLL_ADD_MULTI;
+  sqe->poll32_events = toPollEvents(events);
+  sqe->user_data     = userData(URING_OP_POLL, fd, watch.generation);
+  watch.armed        = true;
+  return true;
+}
+
+bool UringEventLoop::disarm(int fd) {
+  Watch &watch = _watches[fd];
+  if (watch.armed) {
+    struct io_uring_sqe *sqe = nextSqe();
+    if (sqe == NULL) {
+      return false;
+    }
+    sqe->opcode    = IORING_OP_POLL_REMOVE;
+    sqe->fd        = -1;
+    sqe->addr      = userData(URING_OP_POLL, fd, watch.generation);
+    sqe->user_data = 0;
+    watch.armed    = false;
+  }
+  // Lo que llegue todavía de la petición anterior se descarta
+  ++watch.generation;
+  return true;
+}
+
+/**
+ * @brief Queues the multishot accept or recv request of a descriptor.
+ */
+bool UringEventLoop::armOp(int fd) {
+  Watch               &watch = _watches[fd];
+  struct io_uring_sqe *sqe   = nextSqe();
+  if (sqe == NULL) {
+    return false;
+  }
+  ++watch.op_generation;
+  sqe->fd = fd;
+  if (watch.kind == WATCH_LISTENER) {
+    sqe->opcode       = IORING_OP_ACCEPT;
+    sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data    = userData(URING_OP_ACCEPT, fd, watch.op_generation);
+  } else {
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = userData(URING_OP_RECV, fd, watch.op_generation);
+  }
+  watch.op_inflight = true;
+  return true;
+}
+
+/**
+ * @brief Cancels the accept or recv request of a descriptor. Its results
+ *        keep arriving until the kernel ends it, and are still accepted.
+ */
+void UringEventLoop::cancelOp(int fd) {
+  Watch               &watch = _watches[fd];
+  struct io_uring_sqe *sqe   = nextSqe();
+  if (sqe == NULL) {
+    return;
+  }
+  unsigned int op = watch.kind == WATCH_LISTENER ? URING_OP_ACCEPT : URING_OP_RECV;
+  sqe->opcode     = IORING_OP_ASYNC_CANCEL;
+  sqe->fd         = -1;
+  sqe->addr       = userData(op, fd, watch.op_generation);
+  sqe->user_data  = 0;
+}
+
+void UringEventLoop::complete(const struct io_uring_cqe &cqe, std::vector<IoEvent> &ready) {
+  if (cqe.user_data == 0) {
+    return;
+  }
+  unsigned int op         = static_cast<unsigned int>(cqe.user_data >> 56);
+  int          fd         = static_cast<int>(cqe.user_data & 0xffffffffU);
+  unsigned int generation = static_cast<unsigned int>(cqe.user_data >> 32) & URING_GENERATION_MASK;
+  bool         known      = static_cast<size_t>(fd) < _watches.size() && _watches[fd].active;
+
+  unsigned int events = 0;
+  if (op == URING_OP_POLL) {
+    if (!known || (_watches[fd].generation & URING_GENERATION_MASK) != generation) {
+      return;
+    }
+    events = completePoll(_watches[fd], cqe, fd);
+  } else if (!known || (_watches[fd].op_generation & URING_GENERATION_MASK) != generation) {
+    // Resultado de una petición anterior: lo que trae se devuelve
+    if (op == URING_OP_RECV && (cqe.flags & IORING_CQE_F_BUFFER)) {
+      releaseBuffer(static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+    } else if (op == URING_OP_ACCEPT && cqe.res >= 0) {
+      close(cqe.res);
+    }
+    return;
+  } else if (op == URING_OP_ACCEPT) {
+    events = completeAccept(_watches[fd], cqe, fd);
+  } else {
+    events = completeRecv(_watches[fd], cqe, fd);
+  }
+  if (events == 0) {
+    return;
+  }
+
+  Watch &watch = _watches[fd];
+  if (watch.ready == 0) {
+    IoEvent event;
+    event.fd     = fd;
+    event.events = events;
+    ready.push_back(event);
+    watch.ready = ready.size();
+  } else {
+    ready[watch.ready - 1].events |= events;
+  }
+}
+
+unsigned int UringEventLoop::completePoll(Watch &watch, const struct io_uring_cqe &cqe, int fd) {
+  unsigned int events = 0;
+  if (!(cqe.flags & IORING_CQE_F_MORE)) {
+    watch.armed = false;
+    // Un error se notifica una vez y no se vuelve a armar
+    if (cqe.res >= 0) {
+      _rearm.push_back(fd);
+    }
+  }
+  if (cqe.res < 0) {
+    events = IO_ERROR | IO_READ;
+  } else {
+    if (cqe.res & (POLLIN | POLLRDHUP | POLLHUP))
+      events |= IO_READ;
+    if (cqe.res & POLLOUT)
+      events |= IO_WRITE;
+    if (cqe.res & POLLERR)
+      events |= IO_ERROR | IO_READ;
+  }
+  return events;
+}
+
+unsigned int UringEventLoop::completeAccept(Watch &watch, const struct io_uring_cqe &cqe, int fd) {
+  bool more = cqe.flags & IORING_CQE_F_MORE;
+  if (!more) {
+    watch.op_inflight = false;
+  }
+  if (cqe.res >= 0) {
+    watch.accepted.push_back(cqe.res);
+    if (!more) {
+      _rearm_op.push_back(fd);
+    }
+    return IO_READ;
+  }
+  if (cqe.res == -EINVAL && !more) {
+    LOG_WARNING("io_uring without multishot accept: listening sockets are polled");
+    _accept = false;
+    fallBackToPoll(fd);
+    return IO_READ;
+  }
+  if (cqe.res != -ECANCELED) {
+    LOG_ERROR("io_uring accept failed: " << strerror(-cqe.res));
+  }
+  if (!more) {
+    _rearm_op.push_back(fd);
+  }
+  return 0;
+}
+
+unsigned int UringEventLoop::completeRecv(Watch &watch, const struct io_uring_cqe &cqe, int fd) {
+  bool         more   = cqe.flags & IORING_CQE_F_MORE;
+  unsigned int events = 0;
+
+  if (!more) {
+    watch.op_inflight = false;
+  }
+  if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER)) {
+    Received received;
+    received.bid    = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    received.length = cqe.res;
+    watch.received.push_back(received);
+    // Nadie lee esta conexión: se para antes de que se quede con el anillo
+    if (watch.received.size() >= URING_RECV_MAX_QUEUED && !watch.op_paused) {
+      watch.op_paused = true;
+      if (watch.op_inflight) {
+        cancelOp(fd);
+      }
+    }
+    events = IO_READ;
+  } else if (cqe.res == 0) {
+    watch.eof = true;
+    events    = IO_READ;
+  } else if (cqe.res == -ENOBUFS) {
+    if (!more) {
+      // Mientras no haya buffers se lee del socket al avisar el poll
+      watch.starved = true;
+      _starved.push_back(fd);
+      disarm(fd);
+      arm(fd);
+    }
+    return 0;
+  } else if (cqe.res == -EINVAL && !more && watch.received.empty()) {
+    LOG_WARNING("io_uring without multishot recv: connections are polled");
+    _recv = false;
+    fallBackToPoll(fd);
+    return IO_READ;
+  } else if (cqe.res < 0 && cqe.res != -ECANCELED) {
+    watch.error = -cqe.res;
+    events      = IO_READ | IO_ERROR;
+  }
+  if (!more) {
+    _rearm_op.push_back(fd);
+  }
+  return events;
+}
+
+/**
+ * @brief Turns a listener or a connection into a plain poll watch, for a
+ *        kernel that rejected its accept or recv request.
+ */
+void UringEventLoop::fallBackToPoll(int fd) {
+  Watch &watch = _watches[fd];
+  disarm(fd);
+  watch.kind = WATCH_POLL;
+  if (watch.events == 0) {
+    watch.events = IO_READ;
+  }
+  watch.events |= IO_READ;
+  arm(fd);
+}
+
+/**
+ * @brief Hands the queued submissions to the kernel.
+ *
+ * @param min_complete Completions to wait for (with IORING_ENTER_GETEVENTS).
+ * @return What io_uring_enter returned.
+ */
+int UringEventLoop::submit(unsigned int min_complete, unsigned int flags, void *arg, size_t arg_size) {
+  unsigned int pending = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+  if (pending == 0 && min_complete == 0) {
+    return 0;
+  }
+  return syscall(__NR_io_uring_enter, _ring_fd, pending, min_complete, flags, arg, arg_size);
+}
+
+#endif // EVENT_LOOP_URING
@@ -35,11 +35,11 @@ std::string HttpUtils::findIndexFile(const std::string &dir_path, const std::vec
  * @param request_path The request path to check.
  * @return true if the request path is valid, false otherwise.
  */
-bool HttpUtils::isValidRequest(const std::string &request_path) {
+bool HttpUtils::isValidRequest(const ArenaString &request_path) {
   if (request_path.empty() || request_path[0] != '/') {
     return false;
   }
-  for (std::string::const_iterator it = request_path.begin(); it != request_path.end(); ++it) {
+  for (ArenaString::const_iterator it = request_path.begin(); it != request_path.end(); ++it) {
     if (!isalnum(*it) && *it != '/' && *it != '-' && *it != '_' && *it != '.' && *it != '~' && *it != '?' &&
         *it != '#' && *it != ' ') {
       LOG_WARNING("Invalid character in request path: " << *it);
@@ -47,7 +47,7 @@ bool HttpUtils::isValidRequest(const std::string &request_path) {
     }
   }
   size_t pos = 0;
-  while ((pos = request_path.find("..", pos)) != std::string::npos) {
+  while ((pos = request_path.find("..", pos)) != ArenaString::npos) {
     if (pos == 0 || request_path[pos - 1] == '/') {
       size_t next_pos = pos + 2;
       if (next_pos == request_path.length() || request_path[next_pos] == '/') {
@@ -59,185 +59,104 @@ bool HttpUtils::isValidRequest(const std::string &request_path) {
   return true;
 }
 
-std::string HttpUtils::checkRedirect(const std::string &request_path, const LocationConfig &config) {
+ArenaString HttpUtils::checkRedirect(const ArenaString &request_path, const LocationConfig &config) {
   std::map<std::string, std::string>::const_iterator it;
   for (it = config.redirects.begin(); it != config.redirects.end(); ++it) {
     const std::string &from = it->first;
     const std::string &to   = it->second;
-    if (request_path == from ||
-        (from.length() > 0 && from[from.length() - 1] == '/' && request_path.compare(0, from.length(), from) == 0)) {
-      if (from == request_path) {
-        return to;
-      } else {
-        return to + request_path.substr(from.length());
-      }
+    if (request_path.compare(0, from.length(), from.data(), from.length()) != 0) {
+      continue;
+    }
+    if (request_path.length() == from.length()) {
+      return ArenaString(to.data(), to.size());
+    }
+    if (from.length() > 0 && from[from.length() - 1] == '/') {
+      ArenaString url(to.data(), to.size());
+      url.append(request_path, from.length(), ArenaString::npos);
+      return url;
     }
   }
   return "";
 }
 
-// Cambiar la definición del miembro estático
-std::map<int, FileState *> HttpUtils::file_states;
-
-SocketResult HttpUtils::sendChunkedFileNonBlocking(int client_socket, bool keep_alive, const LocationConfig &config) {
-  
-
-  if (!hasFileState(client_socket)) {
-    return initializeFileState(client_socket, config.root_path + "/file.txt", keep_alive, config);
-  }
-
-  FileState &state = getFileState(client_socket);
-
-  if (!state.headers_sent) {
-    LOG_DEBUG("Sending headers for socket: " << client_socket);
-    std::string headers = "HTTP/1.1 200 OK\r\n";
-    headers += "Content-Type: " + getContentType(state.filename) + "\r\n";
-    headers += "Transfer-Encoding: chunked\r\n";
-    headers += keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
-    headers += "\r\n";
-
-    ssize_t sent = send(client_socket, headers.c_str(), headers.length(), MSG_DONTWAIT | MSG_NOSIGNAL);
-    if (sent == -1) {
-      LOG_ERROR("Failed to send headers for socket: " << client_socket);
-      removeFileState(client_socket);
-      return SOCKET_ERROR;
-    }
-    state.headers_sent = true;
-    LOG_DEBUG("Headers sent successfully for socket: " << client_socket);
-    return SOCKET_WOULD_BLOCK;
-  }
-
-  if (state.bytes_sent < state.file_size) {
-    if (state.buffer_pos >= state.buffer_len) {
-      LOG_DEBUG("Reading new block of file for socket: " << client_socket);
-      state.file->read(state.buffer, sizeof(state.buffer));
-      state.buffer_len = state.file->gcount();
-      state.buffer_pos = 0;
-      LOG_DEBUG("Reading " << state.buffer_len << " bytes from file");
-    }
+OpenFileCache                HttpUtils::file_cache;
+ResponseCache                HttpUtils::response_cache;
+std::vector<OutputQueue *>   HttpUtils::outputs;
+std::map<int, RequestTask *> HttpUtils::started_tasks;
 
-    size_t remaining = state.buffer_len - state.buffer_pos;
-    LOG_DEBUG("Sending chunk of " << remaining << " bytes for socket: " << client_socket);
-    SocketResult result = sendChunk(client_socket, state.buffer + state.buffer_pos, remaining);
-
-    if (result == SOCKET_WOULD_BLOCK) {
-      LOG_WARNING("Chunk not sent completely, WOULD_BLOCK");
-      return SOCKET_WOULD_BLOCK;
-    } else if (result != SOCKET_OK) {
-      LOG_ERROR("Error sending chunk for socket: " << client_socket);
-      removeFileState(client_socket);
-      return result;
-    }
-
-    state.buffer_pos += remaining;
-    state.bytes_sent += remaining;
-    LOG_DEBUG("Chunk sent successfully. Total sent: " << state.bytes_sent << " of " << state.file_size);
-    return SOCKET_WOULD_BLOCK;
-  }
-
-  LOG_DEBUG("Sending final chunk for socket: " << client_socket);
-  SocketResult result = sendChunk(client_socket, NULL, 0);
-  if (result == SOCKET_WOULD_BLOCK) {
-    LOG_DEBUG("Final chunk not sent completely, WOULD_BLOCK");
-    return SOCKET_WOULD_BLOCK;
-  }
-  LOG_DEBUG("Transfer complete for socket: " << client_socket);
-  removeFileState(client_socket);
-  return result;
+/**
+ * @brief The open file cache of this process, used for static files.
+ */
+OpenFileCache &HttpUtils::getFileCache() {
+  return file_cache;
 }
 
 /**
- * @brief Sends a chunk to the client.
- *
- * @param client_socket The socket to send the chunk to.
- * @param data The data to send.
- * @param length The length of the data to send.
- * @return The result of the send operation.
+ * @brief The cache of complete responses for small files of this process.
  */
-SocketResult HttpUtils::sendChunk(int client_socket, const char *data, size_t length) {
- 
-
-  std::ostringstream chunk_header;
-  chunk_header << std::hex << length << "\r\n";
-  std::string header = chunk_header.str();
-
-
-  if (length > 0) {
-    LOG_DEBUG("Sending chunk data of length: " << length);
-    ssize_t sent = send(client_socket, data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
-
+ResponseCache &HttpUtils::getResponseCache() {
+  return response_cache;
+}
 
-    if (sent == -1) {
-      LOG_ERROR("Failed to send chunk data for socket: " << client_socket);
-      return SOCKET_ERROR;
-    }
-    LOG_DEBUG("Sent " << sent << " bytes of chunk data");
+/**
+ * @brief Registers the output queue of a connection, where its responses go.
+ */
+void HttpUtils::attachOutput(int client_socket, OutputQueue *output) {
+  if (static_cast<size_t>(client_socket) >= outputs.size()) {
+    outputs.resize(client_socket + 1, NULL);
   }
+  outputs[client_socket] = output;
+}
 
-  LOG_DEBUG("Sending chunk trailer");
-  if (send(client_socket, "", 0, MSG_DONTWAIT | MSG_NOSIGNAL) == -1) {
-    LOG_ERROR("Failed to send chunk trailer for socket: " << client_socket);
-    return SOCKET_ERROR;
+void HttpUtils::detachOutput(int client_socket) {
+  if (client_socket >= 0 && static_cast<size_t>(client_socket) < outputs.size()) {
+    outputs[client_socket] = NULL;
   }
-
-  LOG_DEBUG("Chunk sent successfully for socket: " << client_socket);
-  return SOCKET_OK;
 }
 
-SocketResult HttpUtils::initializeFileState(int                   client_socket,
-                                            const std::string    &filename,
-                                            bool                  keep_alive,
-                                            const LocationConfig &config) {
-  LOG_DEBUG("Initializing FileState for socket: " << client_socket << " with file: " << filename);
-
-  FileState *state = new FileState();
-  state->file      = new std::ifstream(filename.c_str(), std::ios::binary);
-  if (!state->file->is_open()) {
-    LOG_ERROR("Failed to open file: " << filename << " for socket: " << client_socket);
-    delete state;
-    return sendErrorResponse(client_socket, 500, keep_alive, config);
+/**
+ * @brief The output queue of a connection, NULL if none is registered.
+ */
+OutputQueue *HttpUtils::getOutput(int client_socket) {
+  if (client_socket < 0 || static_cast<size_t>(client_socket) >= outputs.size()) {
+    return NULL;
   }
-
-  state->file->seekg(0, std::ios::end);
-  state->file_size = state->file->tellg();
-  state->file->seekg(0, std::ios::beg);
-
-  state->bytes_sent   = 0;
-  state->headers_sent = false;
-  state->buffer_pos   = 0;
-  state->buffer_len   = 0;
-  state->filename     = filename;
-
-  file_states[client_socket] = state;
-
-  LOG_DEBUG("FileState initialized for socket: " << client_socket << ". File size: " << state->file_size);
-  return SOCKET_OK;
+  return outputs[client_socket];
 }
 
-bool HttpUtils::hasFileState(int client_socket) {
-  return file_states.find(client_socket) != file_states.end();
+/**
+ * @brief Records the status code of the response being queued on a
+ *        connection, for the access log.
+ */
+void HttpUtils::setStatus(int client_socket, int status_code) {
+  OutputQueue *output = getOutput(client_socket);
+  if (output != NULL) {
+    output->setStatus(status_code);
+  }
 }
 
-FileState &HttpUtils::getFileState(int client_socket) {
-  return *file_states[client_socket];
+/**
+ * @brief Hands the rest of a request to the event loop.
+ *
+ * Called by a handler that would otherwise block; the handler then returns
+ * and the event loop picks the task up with takeTask().
+ */
+void HttpUtils::startTask(RequestTask *task) {
+  delete started_tasks[task->clientSocket()];
+  started_tasks[task->clientSocket()] = task;
 }
 
-void HttpUtils::removeFileState(int client_socket) {
-  LOG_DEBUG("Removing FileState for socket: " << client_socket);
-  std::map<int, FileState *>::iterator it = file_states.find(client_socket);
-  if (it != file_states.end()) {
-    delete it->second;
-    file_states.erase(it);
-    LOG_DEBUG("FileState removed successfully for socket: " << client_socket);
-  } else {
-    LOG_DEBUG("FILE STATE NOT FOUND: " << client_socket);
+/**
+ * @brief The task started by the last request of a connection, if any.
+ *
+ * @return The task, owned by the caller from now on, or NULL.
+ */
+RequestTask *HttpUtils::takeTask(int client_socket) {
+  std::map<int, RequestTask *>::iterator it = started_tasks.find(client_socket);
+  if (it == started_tasks.end()) {
+    return NULL;
   }
+  RequestTask *task = it->second;
+  started_tasks.erase(it);
+  return task;
 }
-
-bool HttpUtils::isMethodAllowed(const std::vector<std::string> &allowed_methods, const std::string &method) {
-  for (std::vector<std::string>::const_iterator it = allowed_methods.begin(); it != allowed_methods.end(); ++it) {
-    if (*it == method)
-      return true;
-  }
-  return false;
-}
\ No newline at end of file
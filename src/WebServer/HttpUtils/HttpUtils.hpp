@@ -17,31 +17,42 @@
 #include "../src/Logger/includes/Logger.hpp"
 #include "CommonDefinitions.hpp"
 #include "RequestParser/RequestParser.hpp"
+#include "WebServer/Clock/Clock.hpp"
+#include "WebServer/OpenFileCache/OpenFileCache.hpp"
+#include "WebServer/RequestTask/RequestTask.hpp"
+#include "WebServer/ResponseCache/ResponseCache.hpp"
+#include "WebServer/ResponseHead/ResponseHead.hpp"
 //------------------------------------------------------------------------------
+#include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <signal.h>
+#include <sys/sendfile.h>
 #include <stdlib.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 #include <cstring>
+#include <algorithm>
 #include <ctime>
 #include <fstream>
 #include <string>
 #include <vector>
 
+// Read size of the buffered path used when sendfile is off or unsupported
+#define FILE_SEND_BUFFER 16384
+
 class HttpUtils {
   //------------------------PUBLIC METHODS------------------------------------
  public:
   // VOID METHODS
-  static void removeFileState(int client_socket);
+  static void         startTask(RequestTask *task);
+  static RequestTask *takeTask(int client_socket);
   // -----------------------BOOLEAN METHODS-----------------------------------
-  static bool isMethodAllowed(const std::vector<std::string> &allowed_methods,
-                              const std::string              &method);
   static bool fileExists(const std::string &filename);
-  static bool isDirectory(const std::string &path);
-  static bool isValidRequest(const std::string &request_path);
-  static bool hasFileState(int client_socket);
+  static bool isDirectory(const char *path);
+  static bool isValidRequest(const ArenaString &request_path);
   static bool isCgiScript(const std::string    &filepath,
                           const LocationConfig &config);
   static bool findCgiExecutable(const std::string    &filepath,
@@ -69,14 +80,17 @@ class HttpUtils {
  public:
   static std::string constructFilePath(const std::string &root_path,
                                        const std::string &location_path,
-                                       const std::string &request_path);
+                                       const ArenaString &request_path);
+  static ArenaString buildFilePath(const std::string &root_path,
+                                   const std::string &location_path,
+                                   const ArenaString &request_path);
   static std::string findIndexFile(const std::string              &dir_path,
                                    const std::vector<std::string> &index_files);
   static std::string getContentType(const std::string &filename);
-  static std::string getStatusMessage(int status_code);
-  static std::string getCurrentDate();
+  static const char *getStatusMessage(int status_code);
+  static const std::string &getCurrentDate();
   static std::string intToString(int number);
-  static std::string checkRedirect(const std::string    &request_path,
+  static ArenaString checkRedirect(const ArenaString    &request_path,
                                    const LocationConfig &config);
   // -----------------------SOCKET METHODS-------------------------------------
   static SocketResult sendResponse(int                client_socket,
@@ -84,15 +98,25 @@ class HttpUtils {
                                    const std::string &content,
                                    int                status_code,
                                    bool               keep_alive);
-
-  static void setFileState(int client_socket, FileState *state);
+  static SocketResult sendResponse(int                client_socket,
+                                   const std::string &content_type,
+                                   const char        *content,
+                                   size_t             content_length,
+                                   int                status_code,
+                                   bool               keep_alive);
 
   static SocketResult sendFile(int                   client_socket,
                                const std::string    &filename,
                                bool                  keep_alive,
                                const LocationConfig &config, int status_code);
+  static SocketResult sendCachedFile(int                   client_socket,
+                                     CachedFile           *file,
+                                     bool                  keep_alive,
+                                     const LocationConfig &config,
+                                     int                   status_code);
   static SocketResult sendHead(int                   client_socket,
-                               const std::string    &filename,
+                               const char           *filename,
+                               size_t                filename_length,
                                bool                  keep_alive,
                                const LocationConfig &config);
   static SocketResult sendErrorResponse(int                   client_socket,
@@ -103,32 +127,47 @@ class HttpUtils {
                                            const std::string &redirect_url,
                                            int                status_code,
                                            bool               keep_alive);
+  static SocketResult sendRedirectResponse(int         client_socket,
+                                           const char *redirect_url,
+                                           size_t      redirect_url_length,
+                                           int         status_code,
+                                           bool        keep_alive);
+
 
-  static SocketResult sendFileContent(int client_socket);
-  static SocketResult sendChunkedFileNonBlocking(int  client_socket,
-                                                 bool keep_alive,
-                                                 const LocationConfig &config);
+  static OpenFileCache &getFileCache();
+  static ResponseCache &getResponseCache();
 
-  static FileState &getFileState(int client_socket);
+  static void         attachOutput(int client_socket, OutputQueue *output);
+  static void         detachOutput(int client_socket);
+  static OutputQueue *getOutput(int client_socket);
+  static void         setStatus(int client_socket, int status_code);
+  static bool         sendData(int client_socket, const char *data, size_t length);
 
  private:
-  static bool sendData(int client_socket, const char *data, size_t length);
-  static std::string generateResponseHeaders(const std::string &content_type,
-                                             size_t             content_length,
-                                             int                status_code,
-                                             bool               keep_alive);
+  static void writeHead(std::string       &out,
+                        const std::string &content_type,
+                        size_t             content_length,
+                        int                status_code,
+                        bool               keep_alive);
+  static void writeFileHead(std::string &out, const CachedFile *file, int status_code, bool keep_alive);
 
-  static SocketResult sendChunk(int         client_socket,
-                                const char *data,
-                                size_t      length);
-  static SocketResult initializeFileState(int                   client_socket,
-                                          const std::string    &filename,
-                                          bool                  keep_alive,
-                                          const LocationConfig &config);
+  static SocketResult sendSmallFile(int                   client_socket,
+                                    CachedFile           *file,
+                                    bool                  keep_alive,
+                                    const LocationConfig &config,
+                                    int                   status_code);
+  static SocketResult sendCachedResponse(int                   client_socket,
+                                         CachedFile           *file,
+                                         const CachedResponse &response,
+                                         bool                  keep_alive,
+                                         const LocationConfig &config);
 
   //------------------------PRIVATE ATTRIBUTES--------------------------------
  private:
-  static std::map<int, FileState *> file_states;
+  static OpenFileCache                file_cache;
+  static ResponseCache                response_cache;
+  static std::vector<OutputQueue *>   outputs;
+  static std::map<int, RequestTask *> started_tasks;
 };
 
 #endif // HTTP_UTILS_HPP
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "HttpUtils.hpp"
+#include "WebServer/RequestTask/CgiTask.hpp"
 
 bool HttpUtils::isCgiScript(const std::string &filepath, const LocationConfig &config) {
   
@@ -93,47 +94,18 @@ SocketResult HttpUtils::executeCgiChild(int                  pipefd[2],
   exit(1);
 }
 
+/**
+ * @brief Hands the script's output over to a CgiTask.
+ *
+ * The worker does not wait for the script: the task reads the pipe and
+ * sends the response when the event loop reports it readable.
+ */
 SocketResult
 HttpUtils::executeCgiParent(int client_socket, int pipefd[2], pid_t pid, bool keep_alive, const LocationConfig &config) {
   // Proceso padre
-  LOG_DEBUG("Parent process waiting");
+  LOG_DEBUG("Parent process, CGI output read by the event loop");
   close(pipefd[1]); // Cerrar extremo de escritura
 
-  char        buffer[4096];
-  std::string response;
-  ssize_t     bytes_read;
-
-  // Configurar tiempo límite
-  const int TIMEOUT_SECONDS = 1;
-  time_t    start_time      = time(NULL);
-
-  while ((bytes_read = read(pipefd[0], buffer, sizeof(buffer))) > 0) {
-    response.append(buffer, bytes_read);
-
-    if (difftime(time(NULL), start_time) > TIMEOUT_SECONDS) {
-      LOG_WARNING("CGI Timeout reached");
-      kill(pid, SIGTERM);
-      return HttpUtils::sendErrorResponse(client_socket, 408, keep_alive, config);
-    }
-  }
-  close(pipefd[0]);
-
-  int   status;
-  pid_t result = waitpid(pid, &status, WNOHANG);
-
-  if (result == 0) {
-    // El proceso hijo aún está en ejecución, lo terminamos
-    kill(pid, SIGKILL);
-    waitpid(pid, &status, 0);
-    LOG_WARNING("CGI Execution Timeout");
-    return HttpUtils::sendErrorResponse(client_socket, 408, keep_alive, config);
-  } else if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-    // El script se ejecutó correctamente
-    LOG_DEBUG("CGI Execution Success");
-    return HttpUtils::sendResponse(client_socket, "text/html", response, 200, keep_alive);
-  } else {
-    // Hubo un error en la ejecución del script
-    LOG_WARNING("CGI Execution Error");
-    return HttpUtils::sendErrorResponse(client_socket, 500, keep_alive, config);
-  }
-}
\ No newline at end of file
+  startTask(new CgiTask(client_socket, pid, pipefd[0], keep_alive, config));
+  return SOCKET_OK;
+}
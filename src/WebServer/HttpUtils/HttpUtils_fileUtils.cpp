@@ -23,9 +23,9 @@
  * @return false If the path is not a directory or if an error occurs
  * while trying to access the path.
  */
-bool HttpUtils::isDirectory(const std::string &path) {
+bool HttpUtils::isDirectory(const char *path) {
   struct stat statbuf;
-  if (stat(path.c_str(), &statbuf) != 0) {
+  if (stat(path, &statbuf) != 0) {
     return false;
   }
   return S_ISDIR(statbuf.st_mode);
@@ -3,6 +3,11 @@
 /**
  * Sends an HTTP response to the client.
  *
+ * The head is built in the head buffer of the connection and sent together
+ * with the body in one gathered write, or queued behind the responses still
+ * pending; what the socket does not take is queued and sent by the event
+ * loop as the socket accepts it.
+ *
  * @param client_socket The socket connected to the client.
  * @param content_type The MIME type of the content.
  * @param content The body of the response.
@@ -16,29 +21,40 @@ SocketResult HttpUtils::sendResponse(int                client_socket,
                                      const std::string &content,
                                      int                status_code,
                                      bool               keep_alive) {
-  LOG_DEBUG("Starting to send response on socket: " << client_socket << ", status: " << status_code);
+  return sendResponse(client_socket, content_type, content.data(), content.size(), status_code, keep_alive);
+}
 
-  std::string headers       = generateResponseHeaders(content_type, content.length(), status_code, keep_alive);
-  std::string full_response = headers + content;
+/**
+ * Same, for a body that is not a std::string, e.g. one built in the
+ * RequestArena.
+ */
+SocketResult HttpUtils::sendResponse(int                client_socket,
+                                     const std::string &content_type,
+                                     const char        *content,
+                                     size_t             content_length,
+                                     int                status_code,
+                                     bool               keep_alive) {
+  LOG_DEBUG("Queueing response on socket: " << client_socket << ", status: " << status_code);
+  OutputQueue *output = getOutput(client_socket);
+  if (output == NULL) {
+    LOG_ERROR("No output queue for socket " << client_socket);
+    return SOCKET_ERROR;
+  }
+  output->setStatus(status_code);
 
-  size_t total_sent = 0;
-  size_t bytes_left = full_response.length();
+  std::string &head = output->headBuffer();
+  writeHead(head, content_type, content_length, status_code, keep_alive);
 
-  while (total_sent < full_response.length()) {
-    ssize_t bytes_sent = send(client_socket, full_response.c_str() + total_sent, bytes_left, MSG_DONTWAIT | MSG_NOSIGNAL);
-    if (bytes_sent > 0) {
-      total_sent += bytes_sent;
-      bytes_left -= bytes_sent;
-    } else if (bytes_sent == 0) {
-      LOG_INFO("Connection closed while sending response on socket: " << client_socket);
-      return SOCKET_CLOSED;
-    } else {
-      LOG_ERROR("Error sending response on socket " << client_socket);
-      return SOCKET_ERROR;
-    }
+  struct iovec iov[2];
+  iov[0].iov_base = const_cast<char *>(head.data());
+  iov[0].iov_len  = head.size();
+  iov[1].iov_base = const_cast<char *>(content);
+  iov[1].iov_len  = content_length;
+  if (output->appendGather(client_socket, iov, 2) != SOCKET_OK) {
+    return SOCKET_ERROR;
   }
-  LOG_SUCCESS("Finished sending response on socket: " << client_socket << " with status: " << status_code);
-  
+  LOG_SUCCESS("Queued response on socket: " << client_socket << " with status: " << status_code);
+
   return SOCKET_OK;
 }
 
@@ -51,54 +67,166 @@ SocketResult HttpUtils::sendResponse(int                client_socket,
  * @param config The location configuration.
  * @return SOCKET_OK if successful, SOCKET_ERROR or error response otherwise.
  */
-
-void HttpUtils::setFileState(int client_socket, FileState *state) {
-  file_states[client_socket] = state;
-}
-
 SocketResult
 HttpUtils::sendFile(int client_socket, const std::string &filename, bool keep_alive, const LocationConfig &config, int status_code) {
   LOG_DEBUG("Sending file on socket: " << client_socket << " (write), file: " << filename);
+  return sendCachedFile(client_socket, file_cache.lookup(filename), keep_alive, config, status_code);
+}
 
-  // Comprobar si ya existe un estado para este socket
-  if (hasFileState(client_socket)) {
-    return sendFileContent(client_socket);
-  }
-
-  // Si no existe un estado, inicializar uno nuevo
-  std::ifstream *file = new std::ifstream(filename.c_str(), std::ios::binary);
-  if (!file->is_open()) {
-    LOG_ERROR("Failed to open file: " << filename);
-    delete file;
+/**
+ * Sends a file resolved by the open file cache as an HTTP response.
+ *
+ * The headers and the file are queued on the connection; the file is sent
+ * from the descriptor held by the cache entry, which stays pinned until the
+ * transfer ends, so a hot file costs no open/stat.
+ *
+ * @param client_socket The socket connected to the client.
+ * @param file The cache entry of the file.
+ * @param keep_alive Whether to keep the connection alive.
+ * @param config The location configuration.
+ * @param status_code The HTTP status code of the response.
+ * @return SOCKET_OK if successful, SOCKET_ERROR or error response otherwise.
+ */
+SocketResult HttpUtils::sendCachedFile(int                   client_socket,
+                                       CachedFile           *file,
+                                       bool                  keep_alive,
+                                       const LocationConfig &config,
+                                       int                   status_code) {
+  if (file->error != 0 || file->is_directory) {
+    LOG_ERROR("Failed to open file: " << file->key);
     return sendErrorResponse(client_socket, 500, keep_alive, config);
   }
+  setStatus(client_socket, status_code);
+  if (response_cache.accepts(file->size)) {
+    return sendSmallFile(client_socket, file, keep_alive, config, status_code);
+  }
 
-  file->seekg(0, std::ios::end);
-  size_t file_size = file->tellg();
-  file->seekg(0, std::ios::beg);
+  OutputQueue *output = getOutput(client_socket);
+  if (output == NULL) {
+    LOG_ERROR("Failed to send headers for file: " << file->path);
+    return SOCKET_ERROR;
+  }
+  std::string &head = output->headBuffer();
+  writeFileHead(head, file, status_code, keep_alive);
+  // El cuerpo sale con sendfile: la cabecera se encola delante
+  output->append(head);
+  output->appendFile(file_cache, file, 0, config.sendfile);
+  return SOCKET_OK;
+}
 
-  std::string content_type = getContentType(filename);
-  std::string headers      = generateResponseHeaders(content_type, file_size, status_code, keep_alive);
+/**
+ * Sends a small file from the response cache, building its response on a miss.
+ *
+ * @param client_socket The socket connected to the client.
+ * @param file The cache entry of the file, no larger than the cache limit.
+ * @param keep_alive Whether to keep the connection alive.
+ * @param config The location configuration.
+ * @param status_code The HTTP status code of the response.
+ * @return SOCKET_OK if successful, SOCKET_ERROR or error response otherwise.
+ */
+SocketResult HttpUtils::sendSmallFile(int                   client_socket,
+                                      CachedFile           *file,
+                                      bool                  keep_alive,
+                                      const LocationConfig &config,
+                                      int                   status_code) {
+  const CachedResponse *response = response_cache.lookup(file->path, status_code, file->generation);
+  if (response != NULL) {
+    LOG_DEBUG("Response cache hit: " << file->path);
+    return sendCachedResponse(client_socket, file, *response, keep_alive, config);
+  }
 
-  FileState *state    = new FileState();
-  state->file         = file;
-  state->file_size    = file_size;
-  state->bytes_sent   = 0;
-  state->headers_sent = false;
+  std::string body(file->size, '\0');
+  size_t      got = 0;
+  while (got < file->size) {
+    ssize_t bytes_read = pread(file->fd, &body[got], file->size - got, got);
+    if (bytes_read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes_read <= 0) {
+      LOG_ERROR("Failed to read file: " << file->path);
+      return sendErrorResponse(client_socket, 500, keep_alive, config);
+    }
+    got += bytes_read;
+  }
 
-  setFileState(client_socket, state);
+  // Cabecera sin Date ni Connection, que se añaden en cada envío
+  std::string  head;
+  ResponseHead builder(head);
+  builder.status(status_code);
+  builder.header("Content-Type", file->content_type);
+  builder.contentLength(file->size);
+  builder.server();
+  builder.header("ETag", file->etag);
+  response = response_cache.insert(file->path, status_code, file->generation, head, body);
+  return sendCachedResponse(client_socket, file, *response, keep_alive, config);
+}
 
-  // Enviar los headers
-  if (!sendData(client_socket, headers.c_str(), headers.length())) {
-    LOG_ERROR("Failed to send headers for file: " << filename);
-    removeFileState(client_socket);
+/**
+ * Sends a cached response with one gathered write.
+ *
+ * Only the Date and Connection headers are added per request, both from
+ * strings that are already formatted. The write
+ * is attempted right away when the connection can send directly;
+ * whatever the socket does not take is queued: a small body as a copy, a
+ * larger one as a range of the file pinned in the open file cache (the
+ * cached response itself may be evicted before the queue is flushed).
+ *
+ * @param client_socket The socket connected to the client.
+ * @param file The cache entry the response was built from.
+ * @param response The cached response.
+ * @param keep_alive Whether to keep the connection alive.
+ * @param config The location configuration.
+ * @return SOCKET_OK when sent or queued, SOCKET_ERROR otherwise.
+ */
+SocketResult HttpUtils::sendCachedResponse(int                   client_socket,
+                                           CachedFile           *file,
+                                           const CachedResponse &response,
+                                           bool                  keep_alive,
+                                           const LocationConfig &config) {
+  const std::string &date       = Clock::dateHeader();
+  const char        *connection = keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+  struct iovec iov[4];
+  iov[0].iov_base = const_cast<char *>(response.head.data());
+  iov[0].iov_len  = response.head.size();
+  iov[1].iov_base = const_cast<char *>(date.data());
+  iov[1].iov_len  = date.size();
+  iov[2].iov_base = const_cast<char *>(connection);
+  iov[2].iov_len  = strlen(connection);
+  iov[3].iov_base = const_cast<char *>(response.body.data());
+  iov[3].iov_len  = response.body.size();
+
+  OutputQueue *output = getOutput(client_socket);
+  if (output == NULL) {
+    LOG_ERROR("No output queue for socket " << client_socket);
     return SOCKET_ERROR;
   }
 
-  state->headers_sent = true;
+  size_t  head_length = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+  ssize_t sent        = 0;
+  if (output->canSendDirect()) {
+    sent = output->sendDirect(client_socket, iov, 4);
+    if (sent < 0) {
+      return SOCKET_ERROR;
+    }
+    if (static_cast<size_t>(sent) == head_length + response.body.size()) {
+      return SOCKET_OK;
+    }
+  }
 
-  // Intentar enviar el contenido del archivo
-  return sendFileContent(client_socket);
+  // Un cuerpo pequeño se copia, y sale junto a las respuestas que lo rodean
+  if (response.body.size() <= OUTPUT_QUEUE_SPARE_MAX) {
+    output->appendRest(iov, 4, sent);
+    return SOCKET_OK;
+  }
+  size_t body_sent = 0;
+  if (static_cast<size_t>(sent) < head_length) {
+    output->appendRest(iov, 3, sent);
+  } else {
+    body_sent = sent - head_length;
+  }
+  output->appendFile(file_cache, file, body_sent, config.sendfile);
+  return SOCKET_OK;
 }
 
 /**
@@ -112,18 +240,22 @@ HttpUtils::sendFile(int client_socket, const std::string &filename, bool keep_al
  */
 SocketResult
 HttpUtils::sendErrorResponse(int client_socket, int status_code, bool keep_alive, const LocationConfig &config) {
+  // error_pages solo contiene las páginas que se pueden servir
   std::map<int, std::string>::const_iterator it = config.error_pages.find(status_code);
 
-  std::ifstream test_file(it->second.c_str());
-
-  if (it != config.error_pages.end() && it->second.substr(it->second.find_last_of('.') + 1) == "html" && test_file.is_open()) {
-    return sendFile(client_socket, it->second, keep_alive, config, status_code);
+  CachedFile *page = NULL;
+  if (it != config.error_pages.end()) {
+    page = file_cache.lookup(it->second);
+  }
+  if (page != NULL && page->error == 0 && !page->is_directory) {
+    return sendCachedFile(client_socket, page, keep_alive, config, status_code);
   } else {
-    std::string error_message;
+    ArenaString error_message;
     error_message = "<html><body><h1>";
     error_message += getStatusMessage(status_code);
     error_message += "</h1></body></html>";
-    return sendResponse(client_socket, "text/html", error_message, status_code, keep_alive);
+    return sendResponse(
+        client_socket, "text/html", error_message.data(), error_message.size(), status_code, keep_alive);
   }
 }
 /**
@@ -137,137 +269,147 @@ HttpUtils::sendErrorResponse(int client_socket, int status_code, bool keep_alive
  */
 SocketResult
 HttpUtils::sendRedirectResponse(int client_socket, const std::string &redirect_url, int status_code, bool keep_alive) {
-  std::ostringstream oss;
-  oss << status_code;
-  std::string status_code_str = oss.str();
-  std::string headers         = "HTTP/1.1 " + status_code_str + " " + getStatusMessage(status_code) + "\r\n";
-  headers += "Location: " + redirect_url + "\r\n";
-  headers += "Content-Length: 0\r\n";
-  headers += keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
-  headers += "\r\n";
+  return sendRedirectResponse(client_socket, redirect_url.data(), redirect_url.size(), status_code, keep_alive);
+}
 
-  if (!sendData(client_socket, headers.c_str(), headers.length())) {
+/**
+ * Same, for a URL that is not a std::string, e.g. one built in the
+ * RequestArena.
+ */
+SocketResult HttpUtils::sendRedirectResponse(int         client_socket,
+                                             const char *redirect_url,
+                                             size_t      redirect_url_length,
+                                             int         status_code,
+                                             bool        keep_alive) {
+  OutputQueue *output = getOutput(client_socket);
+  if (output == NULL) {
     LOG_ERROR("Error sending redirect response");
     return SOCKET_ERROR;
   }
-
-  return SOCKET_OK;
+  output->setStatus(status_code);
+
+  std::string &head = output->headBuffer();
+  ResponseHead builder(head);
+  builder.status(status_code);
+  builder.header("Location", redirect_url, redirect_url_length);
+  builder.contentLength(0);
+  builder.connection(keep_alive);
+  builder.end();
+
+  struct iovec iov[1];
+  iov[0].iov_base = const_cast<char *>(head.data());
+  iov[0].iov_len  = head.size();
+  return output->appendGather(client_socket, iov, 1);
 }
 
 /**
- * Generates HTTP response headers.
+ * Writes the head of a response with a body in memory.
  *
+ * @param out The string to append to, usually OutputQueue::headBuffer().
  * @param content_type The MIME type of the content.
  * @param content_length The length of the content in bytes.
  * @param status_code The HTTP status code.
  * @param keep_alive Whether to keep the connection alive.
- * @return A string containing the generated headers.
  */
-std::string HttpUtils::generateResponseHeaders(const std::string &content_type,
-                                               size_t             content_length,
-                                               int                status_code,
-                                               bool               keep_alive) {
-  std::ostringstream headers;
-  headers << "HTTP/1.1 " << status_code << " " << getStatusMessage(status_code) << "\r\n";
-  headers << "Content-Type: " << content_type << "\r\n";
-  headers << "Content-Length: " << content_length << "\r\n";
-  headers << "Server: AJX Server/" << AJXWEBSERVER_VERSION << "\r\n";
-  headers << "Date: " << getCurrentDate() << "\r\n";
-  headers << "Connection: " << (keep_alive ? "keep-alive" : "close") << "\r\n";
-  headers << "\r\n"; // Línea vacía para separar los headers del cuerpo
-  return headers.str();
+void HttpUtils::writeHead(std::string       &out,
+                          const std::string &content_type,
+                          size_t             content_length,
+                          int                status_code,
+                          bool               keep_alive) {
+  ResponseHead builder(out);
+  builder.status(status_code);
+  builder.header("Content-Type", content_type);
+  builder.contentLength(content_length);
+  builder.server();
+  builder.date();
+  builder.connection(keep_alive);
+  builder.end(); // Línea vacía para separar los headers del cuerpo
+}
+
+/**
+ * Writes the head of a response whose body is a file of the open file cache.
+ *
+ * GET and HEAD share it, so both answer with the same headers.
+ *
+ * @param out The string to append to, usually OutputQueue::headBuffer().
+ * @param file The cache entry of the file.
+ * @param status_code The HTTP status code.
+ * @param keep_alive Whether to keep the connection alive.
+ */
+void HttpUtils::writeFileHead(std::string &out, const CachedFile *file, int status_code, bool keep_alive) {
+  ResponseHead builder(out);
+  builder.status(status_code);
+  builder.header("Content-Type", file->content_type);
+  builder.contentLength(file->size);
+  builder.server();
+  // En el mismo orden que las respuestas de la ResponseCache
+  builder.header("ETag", file->etag);
+  builder.date();
+  builder.connection(keep_alive);
+  builder.end();
 }
 
 /**
- * Sends data over a socket.
+ * Queues data on the output of a connection.
  *
- * @param client_socket The socket to send data over.
- * @param data The data to send.
+ * @param client_socket The socket of the connection.
+ * @param data The data to send; it is copied.
  * @param length The length of the data in bytes.
- * @return true if all data was sent successfully, false otherwise.
+ * @return false if the socket has no output queue.
  */
 bool HttpUtils::sendData(int client_socket, const char *data, size_t length) {
-  size_t total_sent = 0;
-  while (total_sent < length) {
-    ssize_t sent = send(client_socket, data + total_sent, length - total_sent, MSG_DONTWAIT | MSG_NOSIGNAL);
-    if (sent < 0) {
-      LOG_ERROR("Error sending data");
-      return false;
-    }
-    total_sent += sent;
+  OutputQueue *output = getOutput(client_socket);
+  if (output == NULL) {
+    LOG_ERROR("No output queue for socket " << client_socket);
+    return false;
   }
+  output->append(data, length);
   return true;
 }
 
 /**
- * Sends the content of a file over a socket.
+ * Sends the head GET would send for a file, without the body.
  *
- * @param client_socket The socket to send data over.
- * @param file_state The state of the file being sent.
- * @return SOCKET_OK if successful, SOCKET_ERROR or SOCKET_CLOSED otherwise.
+ * The file is resolved through the open file cache, like GET does, so a hot
+ * file costs no open/stat and the headers come from the cache entry. A
+ * directory answers with the head of its index file, or 403 without one.
+ *
+ * @param client_socket The socket connected to the client.
+ * @param filename The path to the file.
+ * @param filename_length The length of the path.
+ * @param keep_alive Whether to keep the connection alive.
+ * @param config The location configuration.
+ * @return SOCKET_OK if successful, SOCKET_ERROR or error response otherwise.
  */
-SocketResult HttpUtils::sendFileContent(int client_socket) {
-  FileState &state = getFileState(client_socket);
-
-  char buffer[4096];
-  state.file->read(buffer, sizeof(buffer));
-  std::streamsize bytes_read = state.file->gcount();
-
-  if (bytes_read > 0) {
-    ssize_t sent = send(client_socket, buffer, bytes_read, MSG_DONTWAIT | MSG_NOSIGNAL);
-    if (sent > 0) {
-      state.bytes_sent += sent;
-      LOG_DEBUG("Sent " << sent << " bytes. Total sent: " << state.bytes_sent << " / " << state.file_size);
-
-      if (state.bytes_sent >= state.file_size) {
-        LOG_DEBUG("File sending completed for socket: " << client_socket);
-        removeFileState(client_socket);
-        return SOCKET_OK;
-      }
-      return SOCKET_WOULD_BLOCK;
-    } else if (sent == 0) {
-      LOG_ERROR("Connection closed while sending file content on socket: " << client_socket);
-      removeFileState(client_socket);
-      return SOCKET_CLOSED;
-    } else {
-      LOG_ERROR("Error sending file content on socket " << client_socket << ": ");
-      removeFileState(client_socket);
-      return SOCKET_ERROR;
-    }
+SocketResult HttpUtils::sendHead(int                   client_socket,
+                                 const char           *filename,
+                                 size_t                filename_length,
+                                 bool                  keep_alive,
+                                 const LocationConfig &config) {
+  CachedFile *file = file_cache.lookup(filename, filename_length);
+  if (file->error == EACCES) {
+    return sendErrorResponse(client_socket, 403, keep_alive, config);
   }
-
-  if (state.file->eof()) {
-    if (state.bytes_sent < state.file_size) {
-      LOG_ERROR("Unexpected EOF. Bytes sent: " << state.bytes_sent << ", File size: " << state.file_size);
-    }
-    removeFileState(client_socket);
-    return SOCKET_OK;
+  if (file->error != 0) {
+    return sendErrorResponse(client_socket, 404, keep_alive, config);
   }
-
-  return SOCKET_WOULD_BLOCK;
-}
-
-SocketResult
-HttpUtils::sendHead(int client_socket, const std::string &filename, bool keep_alive, const LocationConfig &config) {
-  LOG_DEBUG("Sending file on socket: " << client_socket << " (write), file: " << filename);
-
-  std::ifstream file(filename.c_str(), std::ios::binary);
-  if (!file.is_open()) {
-    LOG_ERROR("Failed to open file: " << filename);
-    return sendErrorResponse(client_socket, 500, keep_alive, config);
+  if (file->is_directory) {
+    // Como GET, la cabecera del index; el listado no se genera solo para medirlo
+    file = file_cache.findIndex(file, config.index_files);
+    if (file == NULL) {
+      return sendErrorResponse(client_socket, 403, keep_alive, config);
+    }
   }
 
-  file.seekg(0, std::ios::end);
-  size_t file_size = file.tellg();
-  file.seekg(0, std::ios::beg);
-
-  std::string content_type = getContentType(filename);
-  std::string headers      = generateResponseHeaders(content_type, file_size, 200, keep_alive);
-
-  if (!sendData(client_socket, headers.c_str(), headers.length())) {
-    LOG_ERROR("Failed to send headers for file: " << filename);
+  OutputQueue *output = getOutput(client_socket);
+  if (output == NULL) {
+    LOG_ERROR("Failed to send headers for file: " << file->path);
     return SOCKET_ERROR;
   }
+  output->setStatus(200);
+  std::string &head = output->headBuffer();
+  writeFileHead(head, file, 200, keep_alive);
+  output->append(head);
 
   LOG_SUCCESS("Headers sent successfully for HEAD request on socket: " << client_socket);
 
@@ -62,62 +62,22 @@ std::string HttpUtils::getContentType(const std::string &filename) {
  * @brief Retrieves the status message corresponding to an HTTP status code.
  *
  * @param status_code The HTTP status code.
- * @return std::string The corresponding status message.
+ * @return const char* The corresponding status message, from the status
+ *         line table of ResponseHead.
  */
-std::string HttpUtils::getStatusMessage(int status_code) {
-  switch (status_code) {
-    case 200:
-      return "OK";
-    case 204:
-      return "No Content";
-    case 301:
-      return "Moved Permanently";
-    case 302:
-      return "Found";
-    case 303:
-      return "See Other";
-    case 307:
-      return "Temporary Redirect";
-    case 308:
-      return "Permanent Redirect";
-    case 400:
-      return "Bad Request";
-    case 403:
-      return "Forbidden";
-    case 404:
-      return "Not Found";
-    case 405:
-      return "Method Not Allowed";
-    case 408:
-      return "Request Timeout";
-    case 411:
-      return "Length Required";
-    case 413:
-      return "Payload Too Large";
-    case 414:
-      return "URI Too Long";
-    case 500:
-      return "Internal Server Error";
-    case 501:
-      return "Not Implemented";
-    case 505:
-      return "HTTP Version Not Supported";
-    default:
-      return "Unknown Status";
-  }
+const char *HttpUtils::getStatusMessage(int status_code) {
+  return ResponseHead::reason(status_code);
 }
 
 /**
  * @brief Gets the current date and time in the format required for HTTP headers.
  *
+ * The string is formatted once per second by the Clock of the event loop.
+ *
  * @return std::string The current date and time in the format "Day, DD Mon YYYY HH:MM:SS GMT".
  */
-std::string HttpUtils::getCurrentDate() {
-  time_t    now = time(0);
-  struct tm tm  = *gmtime(&now);
-  char      buf[100];
-  strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
-  return std::string(buf);
+const std::string &HttpUtils::getCurrentDate() {
+  return Clock::httpDate();
 }
 
 /**
@@ -126,34 +86,59 @@ std::string HttpUtils::getCurrentDate() {
  * @param root_path The root path of the server.
  * @param location_path The location path of the server.
  * @param request_path The request path of the client.
- * @return std::string The constructed file path.
+ * @return std::string The constructed file path, resolved with realpath if it exists.
  */
 std::string HttpUtils::constructFilePath(const std::string &root_path,
                                          const std::string &location_path,
-                                         const std::string &request_path) {
-  std::string file_path = root_path;
- 
-  if (!file_path.empty() && file_path[file_path.length() - 1] != '/') {
-    file_path += '/';
-  }
-  std::string relative_path = request_path;
-  if (request_path.compare(0, location_path.length(), location_path) == 0) {
-    relative_path = request_path.substr(location_path.length());
+                                         const ArenaString &request_path) {
+  ArenaString built = buildFilePath(root_path, location_path, request_path);
+  std::string file_path(built.data(), built.size());
+  char        resolved_path[PATH_MAX];
+  if (realpath(file_path.c_str(), resolved_path) != NULL) {
+    file_path = resolved_path;
   }
 
-  if (!relative_path.empty() && relative_path[0] == '/') {
-    relative_path = relative_path.substr(1);
+  LOG_DEBUG("Constructed file path: " << file_path);
+  return file_path;
+}
+
+/**
+ * @brief Builds the file path for a request without touching the file system.
+ *
+ * Used as the key of the open file cache, which resolves it only on a miss.
+ *
+ * @param root_path The root path of the server.
+ * @param location_path The location path of the server.
+ * @param request_path The request path of the client.
+ * The relative part is delimited in place and appended once, so the only
+ * allocation is the result, in the RequestArena of the request.
+ *
+ * @return ArenaString The file path, not resolved.
+ */
+ArenaString HttpUtils::buildFilePath(const std::string &root_path,
+                                     const std::string &location_path,
+                                     const ArenaString &request_path) {
+  const char *relative = request_path.data();
+  size_t      length   = request_path.length();
+
+  if (request_path.compare(0, location_path.length(), location_path.data(), location_path.length()) == 0) {
+    relative += location_path.length();
+    length -= location_path.length();
   }
-  if (!relative_path.empty() && relative_path[relative_path.length() - 1] == '/' && relative_path.find('.') == std::string::npos) {
-    relative_path = relative_path.substr(0, relative_path.length() - 1);
+  if (length > 0 && relative[0] == '/') {
+    ++relative;
+    --length;
   }
- 
-  file_path += relative_path;
-  char resolved_path[PATH_MAX];
-  if (realpath(file_path.c_str(), resolved_path) != NULL) {
-    file_path = resolved_path;
+  if (length > 0 && relative[length - 1] == '/' && std::memchr(relative, '.', length) == NULL) {
+    --length;
   }
 
-  LOG_DEBUG("Constructed file path: " << file_path);
+  ArenaString file_path;
+  file_path.reserve(root_path.length() + 1 + length);
+  file_path.append(root_path.data(), root_path.length());
+  if (!file_path.empty() && file_path[file_path.length() - 1] != '/') {
+    file_path += '/';
+  }
+  file_path.append(relative, length);
   return file_path;
 }
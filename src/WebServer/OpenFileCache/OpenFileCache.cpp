@@ -0,0 +1,368 @@
+#include "OpenFileCache.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "Logger/includes/Logger.hpp"
+#include "WebServer/Clock/Clock.hpp"
+#include "WebServer/HttpUtils/HttpUtils.hpp"
+
+// Entradas mínimas: una petición usa varias a la vez (directorio e index)
+#define OPEN_FILE_CACHE_MIN_ENTRIES 16
+
+#define OPEN_FILE_CACHE_EVENTS                                                                                      \
+  (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | \
+   IN_MOVE_SELF | IN_ONLYDIR)
+
+static std::string dirName(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  if (slash == std::string::npos)
+    return ".";
+  return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+static std::string baseName(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+OpenFileCache::OpenFileCache() : _max_entries(OPEN_FILE_CACHE_MIN_ENTRIES), _valid_ms(0), _inotify_fd(-1), _generation(0) {
+  _lru.prev = _lru.next = &_lru;
+}
+
+OpenFileCache::~OpenFileCache() {
+  clear();
+  if (_inotify_fd != -1) {
+    close(_inotify_fd);
+  }
+}
+
+/**
+ * @brief Sets the cache limits and starts watching for changes.
+ *
+ * Must be called in the process that serves the requests (after fork), as
+ * the inotify descriptor is not shared between workers.
+ *
+ * @param max_entries Paths kept; 0 disables the cache (every lookup goes
+ *                    to the file system).
+ * @param valid_ms Maximum age of an entry.
+ */
+void OpenFileCache::configure(size_t max_entries, unsigned int valid_ms) {
+  clear();
+  if (max_entries == 0) {
+    _max_entries = OPEN_FILE_CACHE_MIN_ENTRIES;
+    _valid_ms    = 0;
+    if (_inotify_fd != -1) {
+      close(_inotify_fd);
+      _inotify_fd = -1;
+    }
+    return;
+  }
+  _max_entries = std::max(max_entries, static_cast<size_t>(OPEN_FILE_CACHE_MIN_ENTRIES));
+  _valid_ms    = valid_ms;
+  if (_inotify_fd == -1) {
+    _inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify_fd == -1) {
+      LOG_WARNING("inotify not available, open file cache relies on its validity time: " << strerror(errno));
+    }
+  }
+}
+
+/**
+ * @brief The inotify descriptor to watch for reads, -1 if there is none.
+ */
+int OpenFileCache::watchFd() const {
+  return _inotify_fd;
+}
+
+/**
+ * @brief Drops the entries affected by the pending inotify events.
+ */
+void OpenFileCache::processEvents() {
+  union {
+    struct inotify_event event;
+    char                 bytes[4096];
+  } buffer;
+
+  while (_inotify_fd != -1) {
+    ssize_t length = read(_inotify_fd, buffer.bytes, sizeof(buffer.bytes));
+    if (length <= 0) {
+      if (length < 0 && errno == EINTR)
+        continue;
+      return;
+    }
+    for (ssize_t offset = 0; offset < length;) {
+      const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(buffer.bytes + offset);
+      offset += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        LOG_DEBUG("inotify queue overflow, clearing the open file cache");
+        clear();
+      } else if (event->mask & IN_IGNORED) {
+        // El kernel ha quitado la vigilancia (directorio borrado)
+        invalidateWatch(event->wd, "");
+        _watches.erase(event->wd);
+      } else {
+        invalidateWatch(event->wd, event->len > 0 ? std::string(event->name) : std::string());
+      }
+    }
+  }
+}
+
+void OpenFileCache::clear() {
+  while (_lru.next != &_lru) {
+    invalidate(_lru.next);
+  }
+}
+
+/**
+ * @brief Resolves a path, from the cache if it holds a valid entry.
+ *
+ * @param key The file path as built from the request, not resolved.
+ * @return The entry, never NULL; check error before using it. It stays
+ *         valid until the next lookup() unless pinned with acquire().
+ */
+CachedFile *OpenFileCache::lookup(const std::string &key) {
+  return lookup(key.data(), key.size());
+}
+
+/**
+ * @brief Same, for a key that is not a std::string (one built in the
+ *        RequestArena); it is copied into a buffer kept between lookups,
+ *        so a hit does not allocate.
+ */
+CachedFile *OpenFileCache::lookup(const char *key, size_t length) {
+  _probe.assign(key, length);
+
+  unsigned long      now_ms = Clock::monotonicMs();
+  EntryMap::iterator it     = _entries.find(_probe);
+
+  if (it != _entries.end()) {
+    CachedFile *file = it->second;
+    if (now_ms - file->loaded_ms < _valid_ms) {
+      touch(file);
+      return file;
+    }
+    invalidate(file);
+  }
+  return load(_probe, now_ms);
+}
+
+/**
+ * @brief Resolves the index file of a directory.
+ *
+ * The result is stored in the directory entry, so it is only searched
+ * again when the directory changes or the index list is different.
+ *
+ * @return The index file, NULL if none of index_files exists.
+ */
+CachedFile *OpenFileCache::findIndex(CachedFile *directory, const std::vector<std::string> &index_files) {
+  std::string index_key;
+  for (std::vector<std::string>::const_iterator it = index_files.begin(); it != index_files.end(); ++it) {
+    index_key += *it + '\n';
+  }
+  if (directory->index_key == index_key) {
+    return directory->index_path.empty() ? NULL : lookup(directory->index_path);
+  }
+
+  // Las búsquedas pueden expulsar el directorio de la caché
+  acquire(directory);
+  CachedFile *found = NULL;
+  for (std::vector<std::string>::const_iterator it = index_files.begin(); it != index_files.end(); ++it) {
+    CachedFile *file = lookup(directory->path + "/" + *it);
+    if (file->error == 0 && !file->is_directory) {
+      found = file;
+      break;
+    }
+  }
+  directory->index_key  = index_key;
+  directory->index_path = found ? found->key : "";
+  release(directory);
+  return found;
+}
+
+/**
+ * @brief Pins an entry so its descriptor stays open while it is in use.
+ */
+void OpenFileCache::acquire(CachedFile *file) {
+  ++file->refs;
+}
+
+void OpenFileCache::release(CachedFile *file) {
+  if (--file->refs == 0 && file->stale) {
+    destroy(file);
+  }
+}
+
+size_t OpenFileCache::size() const {
+  return _entries.size();
+}
+
+/**
+ * @brief Resolves a path on the file system and adds it to the cache.
+ */
+CachedFile *OpenFileCache::load(const std::string &key, unsigned long now_ms) {
+  CachedFile *file   = new CachedFile();
+  file->key          = key;
+  file->error        = 0;
+  file->is_directory = false;
+  file->fd           = -1;
+  file->size         = 0;
+  file->mtime        = 0;
+  file->loaded_ms    = now_ms;
+  file->generation   = ++_generation;
+  file->refs         = 0;
+  file->stale        = false;
+  file->parent_wd    = -1;
+  file->self_wd      = -1;
+
+  char resolved[PATH_MAX];
+  if (realpath(key.c_str(), resolved) == NULL) {
+    file->error = errno;
+    file->path  = key;
+  } else {
+    file->path = resolved;
+    struct stat st;
+    int         fd = open(resolved, O_RDONLY | O_CLOEXEC);
+    if (fd == -1 || fstat(fd, &st) == -1) {
+      file->error = errno;
+      if (fd != -1)
+        close(fd);
+    } else {
+      file->is_directory = S_ISDIR(st.st_mode);
+      file->size         = st.st_size;
+      file->mtime        = st.st_mtime;
+      if (file->is_directory) {
+        close(fd);
+      } else {
+        char etag[64];
+        snprintf(etag, sizeof(etag), "\"%lx-%lx\"", static_cast<unsigned long>(st.st_mtime),
+                 static_cast<unsigned long>(st.st_size));
+        file->fd           = fd;
+        file->content_type = HttpUtils::getContentType(file->path);
+        file->etag         = etag;
+      }
+    }
+  }
+
+  if (_inotify_fd != -1) {
+    file->parent_wd = addWatch(dirName(file->path), file);
+    if (file->is_directory)
+      file->self_wd = addWatch(file->path, file);
+  }
+
+  _entries[key] = file;
+  file->prev    = &_lru;
+  file->next    = _lru.next;
+  _lru.next->prev = file;
+  _lru.next       = file;
+
+  while (_entries.size() > _max_entries && _lru.prev != file) {
+    invalidate(_lru.prev);
+  }
+  return file;
+}
+
+/**
+ * @brief Removes an entry from the cache; it is freed once unpinned.
+ */
+void OpenFileCache::invalidate(CachedFile *file) {
+  EntryMap::iterator it = _entries.find(file->key);
+  if (it != _entries.end() && it->second == file) {
+    _entries.erase(it);
+  }
+  unlink(file);
+  removeWatch(file->parent_wd, file);
+  removeWatch(file->self_wd, file);
+  file->parent_wd = file->self_wd = -1;
+  if (file->refs > 0) {
+    file->stale = true;
+  } else {
+    destroy(file);
+  }
+}
+
+/**
+ * @brief Invalidates the entries affected by a change in a watched directory.
+ *
+ * @param wd The watch that reported the change.
+ * @param name The entry that changed, empty for the directory itself.
+ */
+void OpenFileCache::invalidateWatch(int wd, const std::string &name) {
+  WatchMap::iterator watch = _watches.find(wd);
+  if (watch == _watches.end()) {
+    return;
+  }
+  std::vector<CachedFile *> victims;
+  for (std::set<CachedFile *>::iterator it = watch->second.begin(); it != watch->second.end(); ++it) {
+    // El propio directorio cambia con cualquier cambio en su contenido (index)
+    if (name.empty() || (*it)->self_wd == wd || baseName((*it)->path) == name) {
+      victims.push_back(*it);
+    }
+  }
+  for (size_t i = 0; i < victims.size(); ++i) {
+    invalidate(victims[i]);
+  }
+}
+
+int OpenFileCache::addWatch(const std::string &dir, CachedFile *file) {
+  int wd = inotify_add_watch(_inotify_fd, dir.c_str(), OPEN_FILE_CACHE_EVENTS);
+  if (wd < 0) {
+    return -1;
+  }
+  _watches[wd].insert(file);
+  return wd;
+}
+
+void OpenFileCache::removeWatch(int wd, CachedFile *file) {
+  if (wd < 0) {
+    return;
+  }
+  WatchMap::iterator watch = _watches.find(wd);
+  if (watch == _watches.end()) {
+    return;
+  }
+  watch->second.erase(file);
+  if (watch->second.empty()) {
+    inotify_rm_watch(_inotify_fd, wd);
+    _watches.erase(watch);
+  }
+}
+
+/**
+ * @brief Moves an entry to the most recently used end.
+ */
+void OpenFileCache::touch(CachedFile *file) {
+  if (_lru.next == file) {
+    return;
+  }
+  unlink(file);
+  file->prev      = &_lru;
+  file->next      = _lru.next;
+  _lru.next->prev = file;
+  _lru.next       = file;
+}
+
+void OpenFileCache::unlink(CachedFile *file) {
+  if (file->prev == NULL) {
+    return;
+  }
+  file->prev->next = file->next;
+  file->next->prev = file->prev;
+  file->prev       = NULL;
+  file->next       = NULL;
+}
+
+void OpenFileCache::destroy(CachedFile *file) {
+  if (file->fd != -1) {
+    close(file->fd);
+  }
+  delete file;
+}
@@ -0,0 +1,92 @@
+#ifndef OPEN_FILE_CACHE_HPP
+#define OPEN_FILE_CACHE_HPP
+
+//------------------------------------------------------------------------------
+#include <sys/types.h>
+#include <cstddef>
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Result of resolving a path, shared by every request for that path
+struct CachedFile {
+  std::string   key;          // Ruta pedida (sin resolver)
+  std::string   path;         // Ruta resuelta con realpath
+  int           error;        // 0, o errno de open (ENOENT, EACCES...)
+  bool          is_directory;
+  int           fd;           // Abierto mientras está en la caché (solo ficheros)
+  size_t        size;
+  time_t        mtime;
+  std::string   content_type;
+  std::string   etag;
+  std::string   index_key;    // Lista de index usada para resolver index_path
+  std::string   index_path;   // Index del directorio, vacío si no hay
+  unsigned long loaded_ms;
+  unsigned long generation;   // Distinto en cada carga, aunque la ruta se repita
+  int           refs;         // Transferencias en curso que usan fd
+  bool          stale;        // Fuera de la caché, se libera con refs == 0
+  int           parent_wd;
+  int           self_wd;
+  CachedFile   *prev;
+  CachedFile   *next;
+};
+
+// OpenFileCache: open file descriptors and metadata for static serving
+//
+// Like nginx's open_file_cache: the first request for a path resolves it
+// (realpath, open, fstat, content type, ETag, directory index) and later
+// requests reuse the result without touching the file system, up to
+// max_entries paths in LRU order. Missing files are cached too.
+//
+// Entries are dropped when inotify reports a change in their directory, and
+// in any case once they are older than valid_ms, which bounds staleness for
+// changes inotify cannot see (e.g. a symlink in the middle of the path).
+//
+// An entry handed to a file transfer is pinned with acquire() and its
+// descriptor stays open until release(), even if it is invalidated.
+class OpenFileCache {
+ public:
+  OpenFileCache();
+  ~OpenFileCache();
+
+  void configure(size_t max_entries, unsigned int valid_ms);
+  int  watchFd() const;
+  void processEvents();
+  void clear();
+
+  CachedFile *lookup(const std::string &key);
+  CachedFile *lookup(const char *key, size_t length);
+  CachedFile *findIndex(CachedFile *directory, const std::vector<std::string> &index_files);
+  void        acquire(CachedFile *file);
+  void        release(CachedFile *file);
+  size_t      size() const;
+
+ private:
+  typedef std::map<std::string, CachedFile *>    EntryMap;
+  typedef std::map<int, std::set<CachedFile *> > WatchMap;
+
+  EntryMap      _entries;
+  std::string   _probe; // Clave de búsqueda; conserva su capacidad
+  WatchMap      _watches;
+  CachedFile    _lru; // Cabecera: _lru.next es el más reciente
+  size_t        _max_entries;
+  unsigned int  _valid_ms;
+  int           _inotify_fd;
+  unsigned long _generation;
+
+  CachedFile *load(const std::string &key, unsigned long now_ms);
+  void        invalidate(CachedFile *file);
+  void        invalidateWatch(int wd, const std::string &name);
+  int         addWatch(const std::string &dir, CachedFile *file);
+  void        removeWatch(int wd, CachedFile *file);
+  void        touch(CachedFile *file);
+  void        unlink(CachedFile *file);
+  static void destroy(CachedFile *file);
+
+  OpenFileCache(const OpenFileCache &);
+  OpenFileCache &operator=(const OpenFileCache &);
+};
+
+#endif // OPEN_FILE_CACHE_HPP
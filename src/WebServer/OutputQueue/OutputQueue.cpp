@@ -0,0 +1,360 @@
+#include "OutputQueue.hpp"
+
+#include <errno.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include "Logger/includes/Logger.hpp"
+
+// Lectura de ficheros cuando sendfile está desactivado o no se admite
+#define OUTPUT_QUEUE_READ_BUFFER 16384
+
+OutputQueue::OutputQueue() : _pending(0), _total(0), _status(0), _corked(false) {}
+
+OutputQueue::~OutputQueue() {
+  clear();
+}
+
+/**
+ * @brief Appends a copy of data.
+ */
+void OutputQueue::append(const char *data, size_t length) {
+  if (length == 0)
+    return;
+  if (_segments.empty() || _segments.back().kind != SEG_BUFFER) {
+    _segments.push_back(Segment());
+    _segments.back().buffer.swap(_spare);
+  }
+  _segments.back().buffer.append(data, length);
+  _pending += length;
+  _total += length;
+}
+
+void OutputQueue::append(const std::string &data) {
+  append(data.data(), data.size());
+}
+
+/**
+ * @brief Appends memory without copying it.
+ *
+ * @param data Must stay valid and unchanged until it is sent.
+ */
+void OutputQueue::appendStatic(const char *data, size_t length) {
+  if (length == 0)
+    return;
+  _segments.push_back(Segment());
+  Segment &segment = _segments.back();
+  segment.kind     = SEG_STATIC;
+  segment.data     = data;
+  segment.length   = length;
+  _pending += length;
+  _total += length;
+}
+
+/**
+ * @brief Appends the rest of a file, from offset to its cached size.
+ *
+ * The entry is pinned until the range is sent or the queue is cleared, so
+ * its descriptor stays open even if the cache drops it meanwhile.
+ */
+void OutputQueue::appendFile(OpenFileCache &cache, CachedFile *file, size_t offset, bool use_sendfile) {
+  if (offset >= file->size)
+    return;
+  cache.acquire(file);
+  _segments.push_back(Segment());
+  Segment &segment     = _segments.back();
+  segment.kind         = SEG_FILE;
+  segment.cache        = &cache;
+  segment.file         = file;
+  segment.offset       = offset;
+  segment.length       = file->size;
+  segment.use_sendfile = use_sendfile;
+  _pending += file->size - offset;
+  _total += file->size - offset;
+}
+
+/**
+ * @brief Appends copies of the pieces of a response, leaving out the first
+ *        skip bytes (already sent).
+ */
+void OutputQueue::appendRest(const struct iovec *iov, size_t count, size_t skip) {
+  for (size_t i = 0; i < count; ++i) {
+    if (skip >= iov[i].iov_len) {
+      skip -= iov[i].iov_len;
+      continue;
+    }
+    append(static_cast<const char *>(iov[i].iov_base) + skip, iov[i].iov_len - skip);
+    skip = 0;
+  }
+}
+
+/**
+ * @brief Sends the pieces of a response with one gathered write, or queues
+ *        them behind what is already pending or while the queue is corked.
+ *
+ * Only the part the socket does not take is copied into the queue; the
+ * pieces can be released as soon as this returns.
+ *
+ * @return SOCKET_OK when sent or queued, SOCKET_ERROR if the write failed.
+ */
+SocketResult OutputQueue::appendGather(int socket, const struct iovec *iov, size_t count) {
+  size_t sent = 0;
+  if (canSendDirect()) {
+    ssize_t result = sendDirect(socket, iov, count);
+    if (result < 0) {
+      return SOCKET_ERROR;
+    }
+    sent = result;
+  }
+  appendRest(iov, count, sent);
+  return SOCKET_OK;
+}
+
+/**
+ * @brief Writes pieces straight to the socket, bypassing the queue.
+ *
+ * Only valid while canSendDirect(). The bytes sent count in total().
+ *
+ * @return The bytes sent (0 if the socket would block), -1 on error.
+ */
+ssize_t OutputQueue::sendDirect(int socket, const struct iovec *iov, size_t count) {
+  // writev no admite MSG_NOSIGNAL: sendmsg hace la misma escritura agrupada
+  struct msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov    = const_cast<struct iovec *>(iov);
+  message.msg_iovlen = count;
+
+  ssize_t sent;
+  do {
+    sent = sendmsg(socket, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return 0;
+    LOG_ERROR("Error sending response on socket " << socket << ": " << strerror(errno));
+    return -1;
+  }
+  _total += sent;
+  return sent;
+}
+
+/**
+ * @brief Whether a response can be written straight to the socket: nothing
+ *        is queued before it and the queue is not corked.
+ */
+bool OutputQueue::canSendDirect() const {
+  return _segments.empty() && !_corked;
+}
+
+/**
+ * @brief Queues the responses that follow instead of writing them, until
+ *        uncork(); the caller flushes them together.
+ */
+void OutputQueue::cork() {
+  _corked = true;
+}
+
+void OutputQueue::uncork() {
+  _corked = false;
+}
+
+/**
+ * @brief Empty scratch string for building a response head; it keeps its
+ *        capacity between responses. Its content is not sent unless it is
+ *        passed to appendGather() or append().
+ */
+std::string &OutputQueue::headBuffer() {
+  _head.clear();
+  return _head;
+}
+
+/**
+ * @brief Sends as much of the queue as the socket takes.
+ *
+ * @return SOCKET_OK when the queue is empty, SOCKET_WOULD_BLOCK if it must
+ *         be resumed on write readiness, SOCKET_ERROR or SOCKET_CLOSED if
+ *         the connection has to be closed.
+ */
+SocketResult OutputQueue::flush(int socket) {
+  while (!_segments.empty()) {
+    SocketResult result;
+    if (_segments.front().kind == SEG_FILE) {
+      result = flushFile(socket, _segments.front());
+      if (result == SOCKET_OK)
+        popFront();
+    } else {
+      result = flushMemory(socket);
+    }
+    if (result != SOCKET_OK)
+      return result;
+  }
+  return SOCKET_OK;
+}
+
+bool OutputQueue::empty() const {
+  return _segments.empty();
+}
+
+/**
+ * @brief Bytes waiting to be sent.
+ */
+size_t OutputQueue::pending() const {
+  return _pending;
+}
+
+/**
+ * @brief Bytes of response queued or written directly since the connection
+ *        was opened; the difference between two reads is a response size.
+ */
+size_t OutputQueue::total() const {
+  return _total;
+}
+
+/**
+ * @brief Records the status code of the response being queued.
+ */
+void OutputQueue::setStatus(int status) {
+  _status = status;
+}
+
+int OutputQueue::status() const {
+  return _status;
+}
+
+/**
+ * @brief Drops everything pending and unpins the files.
+ */
+void OutputQueue::clear() {
+  while (!_segments.empty()) {
+    popFront();
+  }
+  _pending = 0;
+}
+
+/**
+ * @brief Sends the memory segments at the front with one gathered write.
+ *
+ * sendmsg is used instead of writev so the write can carry MSG_NOSIGNAL.
+ */
+SocketResult OutputQueue::flushMemory(int socket) {
+  struct iovec iov[OUTPUT_QUEUE_IOV];
+  size_t       count = 0;
+  size_t       total = 0;
+
+  for (std::deque<Segment>::iterator it = _segments.begin();
+       it != _segments.end() && it->kind != SEG_FILE && count < OUTPUT_QUEUE_IOV;
+       ++it) {
+    const char *base   = it->kind == SEG_BUFFER ? it->buffer.data() : it->data;
+    size_t      length = it->kind == SEG_BUFFER ? it->buffer.size() : it->length;
+    iov[count].iov_base = const_cast<char *>(base + it->offset);
+    iov[count].iov_len  = length - it->offset;
+    total += iov[count].iov_len;
+    ++count;
+  }
+
+  struct msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov    = iov;
+  message.msg_iovlen = count;
+
+  ssize_t sent;
+  do {
+    sent = sendmsg(socket, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return SOCKET_WOULD_BLOCK;
+    LOG_ERROR("Error sending response on socket " << socket << ": " << strerror(errno));
+    return SOCKET_ERROR;
+  }
+  consume(sent);
+  // Envío parcial: el buffer del socket está lleno
+  return static_cast<size_t>(sent) < total ? SOCKET_WOULD_BLOCK : SOCKET_OK;
+}
+
+/**
+ * @brief Sends a file range with sendfile(2), or pread() and send() when
+ *        sendfile is off or the file system does not support it.
+ */
+SocketResult OutputQueue::flushFile(int socket, Segment &segment) {
+  while (segment.offset < segment.length) {
+    size_t  remaining = segment.length - segment.offset;
+    ssize_t sent;
+
+    if (segment.use_sendfile) {
+      off_t offset = segment.offset;
+      sent         = sendfile(socket, segment.file->fd, &offset, remaining);
+      if (sent < 0 && (errno == EINVAL || errno == ENOSYS)) {
+        LOG_DEBUG("sendfile not supported, using buffered reads on socket: " << socket);
+        segment.use_sendfile = false;
+        continue;
+      }
+      if (sent == 0) {
+        // El fichero se ha acortado: la respuesta ya no cuadra con Content-Length
+        LOG_ERROR("Unexpected EOF. Bytes sent: " << segment.offset << ", File size: " << segment.length);
+        return SOCKET_ERROR;
+      }
+    } else {
+      char    buffer[OUTPUT_QUEUE_READ_BUFFER];
+      ssize_t bytes_read;
+      do {
+        bytes_read = pread(segment.file->fd, buffer, std::min(remaining, sizeof(buffer)), segment.offset);
+      } while (bytes_read < 0 && errno == EINTR);
+      if (bytes_read <= 0) {
+        LOG_ERROR("Unexpected EOF. Bytes sent: " << segment.offset << ", File size: " << segment.length);
+        return SOCKET_ERROR;
+      }
+      // Los bytes no aceptados se vuelven a leer en la siguiente llamada
+      sent = send(socket, buffer, bytes_read, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+
+    if (sent > 0) {
+      segment.offset += sent;
+      _pending -= sent;
+    } else if (sent < 0 && errno == EINTR) {
+      // Interrumpido por una señal: con epoll en modo edge no llegaría otro
+      // aviso, así que se reintenta aquí como en sendDirect
+      continue;
+    } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return SOCKET_WOULD_BLOCK;
+    } else {
+      LOG_ERROR("Error sending file content on socket " << socket << ": " << strerror(errno));
+      return SOCKET_ERROR;
+    }
+  }
+  return SOCKET_OK;
+}
+
+/**
+ * @brief Advances the memory segments at the front by sent bytes.
+ */
+void OutputQueue::consume(size_t sent) {
+  _pending -= sent;
+  while (sent > 0) {
+    Segment &front     = _segments.front();
+    size_t   length    = front.kind == SEG_BUFFER ? front.buffer.size() : front.length;
+    size_t   remaining = length - front.offset;
+    if (sent < remaining) {
+      front.offset += sent;
+      return;
+    }
+    sent -= remaining;
+    popFront();
+  }
+}
+
+void OutputQueue::popFront() {
+  Segment &front = _segments.front();
+  if (front.kind == SEG_FILE) {
+    front.cache->release(front.file);
+  } else if (front.kind == SEG_BUFFER && front.buffer.capacity() <= OUTPUT_QUEUE_SPARE_MAX &&
+             front.buffer.capacity() > _spare.capacity()) {
+    // La memoria se reutiliza para el próximo buffer
+    front.buffer.clear();
+    _spare.swap(front.buffer);
+  }
+  _segments.pop_front();
+}
@@ -0,0 +1,101 @@
+#ifndef OUTPUT_QUEUE_HPP
+#define OUTPUT_QUEUE_HPP
+
+//------------------------------------------------------------------------------
+#include "SocketResult.hpp"
+#include "WebServer/OpenFileCache/OpenFileCache.hpp"
+//------------------------------------------------------------------------------
+#include <sys/uio.h>
+#include <cstddef>
+#include <deque>
+#include <string>
+
+// Maximum number of memory segments gathered in one write
+#define OUTPUT_QUEUE_IOV 64
+// Largest buffer kept for reuse once its segment has been sent
+#define OUTPUT_QUEUE_SPARE_MAX 16384
+
+// OutputQueue: pending output of one connection
+//
+// Responses are appended as a chain of segments: copied buffers, static
+// slices (memory that outlives the queue, e.g. literals) and file ranges
+// pinned in the OpenFileCache. flush() sends consecutive memory segments
+// with one gathered write and file ranges with sendfile(2), until the queue
+// is empty or the socket would block; it is resumed on write readiness.
+//
+// Small appends are coalesced into the last buffer, so a response built
+// from several pieces still costs a single iovec. The storage of a sent
+// buffer is kept for the next one, and headBuffer() is a scratch string for
+// response heads that keeps its capacity, so a connection in steady state
+// queues responses without allocating.
+//
+// appendGather() sends a response given as pieces (head and body) with one
+// gathered write when nothing is queued before it, and only copies into the
+// queue what the socket does not take. While the queue is corked (more
+// pipelined requests follow in the same read) responses are only queued,
+// so the whole batch goes out with the one flush() that follows it.
+class OutputQueue {
+ public:
+  OutputQueue();
+  ~OutputQueue();
+
+  void append(const char *data, size_t length);
+  void append(const std::string &data);
+  void appendStatic(const char *data, size_t length);
+  void appendFile(OpenFileCache &cache, CachedFile *file, size_t offset, bool use_sendfile);
+  void appendRest(const struct iovec *iov, size_t count, size_t skip);
+
+  SocketResult appendGather(int socket, const struct iovec *iov, size_t count);
+  ssize_t      sendDirect(int socket, const struct iovec *iov, size_t count);
+  bool         canSendDirect() const;
+  void         cork();
+  void         uncork();
+  std::string &headBuffer();
+
+  SocketResult flush(int socket);
+  bool         empty() const;
+  size_t       pending() const;
+  void         clear();
+
+  size_t total() const;
+  void   setStatus(int status);
+  int    status() const;
+
+ private:
+  enum Kind {
+    SEG_BUFFER, // Copia propia
+    SEG_STATIC, // Memoria ajena que no cambia
+    SEG_FILE    // Rango de un fichero de la OpenFileCache
+  };
+
+  struct Segment {
+    Kind           kind;
+    std::string    buffer;
+    const char    *data;
+    size_t         length;
+    size_t         offset; // Bytes ya enviados (o posición en el fichero)
+    OpenFileCache *cache;
+    CachedFile    *file;
+    bool           use_sendfile;
+
+    Segment() : kind(SEG_BUFFER), data(NULL), length(0), offset(0), cache(NULL), file(NULL), use_sendfile(false) {}
+  };
+
+  std::deque<Segment> _segments;
+  size_t              _pending;
+  size_t              _total;  // Bytes de respuesta desde que se abrió la conexión
+  int                 _status; // Código de la última respuesta
+  bool                _corked; // Siguen más respuestas de la misma lectura
+  std::string         _spare;  // Memoria del último buffer enviado
+  std::string         _head;
+
+  SocketResult flushMemory(int socket);
+  SocketResult flushFile(int socket, Segment &segment);
+  void         consume(size_t sent);
+  void         popFront();
+
+  OutputQueue(const OutputQueue &);
+  OutputQueue &operator=(const OutputQueue &);
+};
+
+#endif // OUTPUT_QUEUE_HPP
@@ -0,0 +1,122 @@
+#include "RequestArena.hpp"
+
+#include <cstdlib>
+#include "Logger/includes/Logger.hpp"
+
+// Alineación de cada asignación (IoBlock::data ya viene alineado a esto)
+#define ARENA_ALIGN IO_BLOCK_ALIGN
+// Lo que pase de aquí va al heap para no desperdiciar el resto del bloque
+#define ARENA_LARGE (IO_BLOCK_SIZE / 4)
+
+#ifdef WEBSERVER_DEBUG
+// Asignaciones en el heap, para las estadísticas de cada petición. Una
+// cuenta por hilo: solo se lee la del bucle de eventos, no la del hilo que
+// escribe el log. Lo que reserva el Logger al formatear no cuenta.
+static __thread unsigned long heap_allocations = 0;
+
+void *operator new(std::size_t size) throw(std::bad_alloc) {
+  if (LogFormatting::depth == 0)
+    ++heap_allocations;
+  void *p = std::malloc(size > 0 ? size : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) throw() {
+  std::free(p);
+}
+#endif
+
+RequestArena *RequestArena::_current = NULL;
+
+RequestArena::RequestArena(BufferPool &pool) : _pool(pool), _used(IO_BLOCK_SIZE), _allocations(0), _bytes(0) {}
+
+RequestArena::~RequestArena() {
+  reset();
+}
+
+/**
+ * @brief Returns size bytes aligned to ARENA_ALIGN, valid until reset().
+ */
+void *RequestArena::allocate(size_t size) {
+  size = (size + ARENA_ALIGN - 1) & ~static_cast<size_t>(ARENA_ALIGN - 1);
+  ++_allocations;
+  _bytes += size;
+
+  if (size > ARENA_LARGE) {
+    void *p = std::malloc(size);
+    if (p == NULL)
+      throw std::bad_alloc();
+    _large.push_back(p);
+    return p;
+  }
+  if (_used + size > IO_BLOCK_SIZE) {
+    _blocks.push_back(_pool.acquire());
+    _used = 0;
+  }
+  void *p = _blocks.back()->data + _used;
+  _used += size;
+  return p;
+}
+
+/**
+ * @brief Frees everything allocated since the last reset.
+ *
+ * The vectors keep their capacity, so a request of the usual size does not
+ * allocate anything once the first ones have been handled.
+ */
+void RequestArena::reset() {
+  for (size_t i = 0; i < _blocks.size(); ++i) {
+    _pool.release(_blocks[i]);
+  }
+  for (size_t i = 0; i < _large.size(); ++i) {
+    std::free(_large[i]);
+  }
+  _blocks.clear();
+  _large.clear();
+  _used        = IO_BLOCK_SIZE;
+  _allocations = 0;
+  _bytes       = 0;
+}
+
+/**
+ * @brief Allocations made since the last reset.
+ */
+size_t RequestArena::allocations() const {
+  return _allocations;
+}
+
+/**
+ * @brief Bytes handed out since the last reset.
+ */
+size_t RequestArena::bytes() const {
+  return _bytes;
+}
+
+/**
+ * @brief The arena of the Scope being run, NULL outside of one.
+ */
+RequestArena *RequestArena::current() {
+  return _current;
+}
+
+RequestArena::Scope::Scope(RequestArena &arena) : _arena(&arena), _previous(_current) {
+  _current = &arena;
+#ifdef WEBSERVER_DEBUG
+  if (_previous != _arena)
+    heap_allocations = 0;
+#endif
+}
+
+RequestArena::Scope::~Scope() {
+  _current = _previous;
+  if (_previous == _arena)
+    return;
+#ifdef WEBSERVER_DEBUG
+  unsigned long heap = heap_allocations;
+  LOG_DEBUG("Request allocations: " << _arena->allocations() << " in the arena (" << _arena->bytes() << " bytes), "
+                                    << heap << " on the heap");
+#endif
+  _arena->reset();
+}
@@ -0,0 +1,132 @@
+#ifndef REQUEST_ARENA_HPP
+#define REQUEST_ARENA_HPP
+
+//------------------------------------------------------------------------------
+#include "WebServer/BufferPool/BufferPool.hpp"
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// RequestArena: bump allocator for the memory of one request
+//
+// Allocations are carved from BufferPool blocks by moving a pointer and are
+// never freed one by one: the whole arena is reset when the request has
+// been handled, giving its blocks back to the pool. Requests bigger than a
+// quarter of a block get their own heap allocation, freed with the reset.
+//
+// Code running inside a Scope allocates from the arena through
+// ArenaAllocator (ArenaString, ArenaStringMap). Objects using it must not
+// outlive the Scope; outside of one they fall back to the heap.
+class RequestArena {
+ public:
+  explicit RequestArena(BufferPool &pool);
+  ~RequestArena();
+
+  void  *allocate(size_t size);
+  void   reset();
+  size_t allocations() const;
+  size_t bytes() const;
+
+  static RequestArena *current();
+
+  // Makes an arena the current one; it is reset when the outermost Scope
+  // that uses it ends.
+  class Scope {
+   public:
+    explicit Scope(RequestArena &arena);
+    ~Scope();
+
+   private:
+    RequestArena *_arena;
+    RequestArena *_previous;
+
+    Scope(const Scope &);
+    Scope &operator=(const Scope &);
+  };
+
+ private:
+  BufferPool            &_pool;
+  std::vector<IoBlock *> _blocks;
+  std::vector<void *>    _large;
+  size_t                 _used; // Bytes usados del último bloque
+  size_t                 _allocations;
+  size_t                 _bytes;
+
+  static RequestArena *_current;
+
+  RequestArena(const RequestArena &);
+  RequestArena &operator=(const RequestArena &);
+};
+
+// STL allocator that takes its memory from the current RequestArena, or
+// from the heap when there is none. deallocate() is a no-op for arena
+// memory: it goes away with the reset.
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T              value_type;
+  typedef T             *pointer;
+  typedef const T       *const_pointer;
+  typedef T             &reference;
+  typedef const T       &const_reference;
+  typedef std::size_t    size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind {
+    typedef ArenaAllocator<U> other;
+  };
+
+  ArenaAllocator() throw() : _arena(RequestArena::current()) {}
+  ArenaAllocator(const ArenaAllocator &other) throw() : _arena(other._arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) throw() : _arena(other.arena()) {}
+  ~ArenaAllocator() throw() {}
+
+  pointer allocate(size_type n, const void * = 0) {
+    if (_arena != NULL)
+      return static_cast<pointer>(_arena->allocate(n * sizeof(T)));
+    return static_cast<pointer>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(pointer p, size_type) {
+    if (_arena == NULL)
+      ::operator delete(p);
+  }
+
+  size_type max_size() const throw() { return static_cast<size_type>(-1) / sizeof(T); }
+
+  void construct(pointer p, const T &value) { new (p) T(value); }
+  void destroy(pointer p) { p->~T(); }
+
+  pointer       address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+
+  RequestArena *arena() const { return _arena; }
+
+ private:
+  RequestArena *_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() != b.arena();
+}
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> > ArenaString;
+typedef std::map<ArenaString,
+                 ArenaString,
+                 std::less<ArenaString>,
+                 ArenaAllocator<std::pair<const ArenaString, ArenaString> > >
+    ArenaStringMap;
+
+#endif // REQUEST_ARENA_HPP
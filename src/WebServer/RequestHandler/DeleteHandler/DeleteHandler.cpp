@@ -37,13 +37,14 @@ DeleteHandler::DeleteHandler(int client_socket, const LocationConfig &loc_config
  * @return SocketResult indicating the result of the operation.
  */
 SocketResult DeleteHandler::handle_delete_request() {
-  if (!HttpUtils::isMethodAllowed(_del_location_config.allowed_methods, "DELETE")) {
+  if (!_del_location_config.allows(HTTP_METHOD_DELETE)) {
     return HttpUtils::sendErrorResponse(_del_client_socket, 405, _del_keep_alive, _del_location_config);
   }
 
-  std::string path          = _del_request.getPath();
-  std::string relative_path = path.substr(_del_location_config.location_path.length());
-  std::string full_path     = _del_location_config.root_path + relative_path;
+  const ArenaString &path          = _del_request.getPath();
+  ArenaString        relative_path = path.substr(_del_location_config.location_path.length());
+  std::string        full_path     = _del_location_config.root_path;
+  full_path.append(relative_path.data(), relative_path.size());
 
   if (!HttpUtils::fileExists(full_path)) {
     return HttpUtils::sendErrorResponse(_del_client_socket, 400, _del_keep_alive, _del_location_config);
@@ -38,17 +38,17 @@ GetHandler::~GetHandler() {
  */
 SocketResult
 GetHandler::handle_get(int client_socket, const RequestParser &parser, const LocationConfig &config, bool keep_alive) {
-  if (!HttpUtils::isMethodAllowed(config.allowed_methods, "GET")) {
+  if (!config.allows(HTTP_METHOD_GET)) {
     return HttpUtils::sendErrorResponse(client_socket, 405, keep_alive, config);
   }
 
   if (!config.return_code_path.empty()) {
-    short int   return_code = config.return_code_path.begin()->first;
-    std::string return_path = config.return_code_path.begin()->second;
+    short int          return_code = config.return_code_path.begin()->first;
+    const std::string &return_path = config.return_code_path.begin()->second;
     LOG_DEBUG("return_code: " << return_code << " return_path: " << return_path);
     return HttpUtils::sendRedirectResponse(client_socket, return_path, return_code, keep_alive);
   }
-  std::string file_path = HttpUtils::constructFilePath(config.root_path, config.location_path, parser.getPath());
+  ArenaString file_path = HttpUtils::buildFilePath(config.root_dir, config.location_path, parser.getPath());
   LOG_DEBUG("Full file path: " << file_path);
 
   if (!HttpUtils::isValidRequest(parser.getPath())) {
@@ -56,25 +56,27 @@ GetHandler::handle_get(int client_socket, const RequestParser &parser, const Loc
     return HttpUtils::sendErrorResponse(client_socket, 400, keep_alive, config);
   }
 
-  std::string redirect_url = HttpUtils::checkRedirect(parser.getPath(), config);
+  ArenaString redirect_url = HttpUtils::checkRedirect(parser.getPath(), config);
   if (!redirect_url.empty()) {
-    return HttpUtils::sendRedirectResponse(client_socket, redirect_url, 301, keep_alive);
+    return HttpUtils::sendRedirectResponse(client_socket, redirect_url.data(), redirect_url.size(), 301, keep_alive);
   }
 
-  if (access(file_path.c_str(), F_OK) != 0) {
-    return HttpUtils::sendErrorResponse(client_socket, 404, keep_alive, config); 
+  // realpath, open y fstat solo cuando la ruta no está en la caché
+  CachedFile *file = HttpUtils::getFileCache().lookup(file_path.data(), file_path.size());
+  if (file->error == EACCES) {
+    return HttpUtils::sendErrorResponse(client_socket, 403, keep_alive, config);
   }
-  if (access(file_path.c_str(), R_OK) != 0) {
-    return HttpUtils::sendErrorResponse(client_socket, 403, keep_alive, config); 
+  if (file->error != 0) {
+    return HttpUtils::sendErrorResponse(client_socket, 404, keep_alive, config);
   }
 
-  if (HttpUtils::isDirectory(file_path)) {
-    return handleDirectory(client_socket, file_path, parser.getPath(), keep_alive, config);
+  if (file->is_directory) {
+    return handleDirectory(client_socket, file, parser.getPath(), keep_alive, config);
   }
-  if (HttpUtils::isCgiScript(file_path, config)) {
+  if (HttpUtils::isCgiScript(file->path, config)) {
     LOG_DEBUG("Executing CGI script");
-    return HttpUtils::executeCgiScript(client_socket, file_path, parser, keep_alive, config);
+    return HttpUtils::executeCgiScript(client_socket, file->path, parser, keep_alive, config);
   } else {
-    return handleFile(client_socket, file_path, keep_alive, config);
+    return handleFile(client_socket, file, keep_alive, config);
   }
 }
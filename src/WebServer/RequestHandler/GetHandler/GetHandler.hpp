@@ -43,38 +43,37 @@ class GetHandler {
 
  private:
   SocketResult handleDirectory(int                   client_socket,
-                               const std::string    &file_path,
-                               const std::string    &request_path,
+                               CachedFile           *directory,
+                               const ArenaString    &request_path,
                                bool                  keep_alive,
                                const LocationConfig &config);
   SocketResult handleFile(int                   client_socket,
-                          const std::string    &file_path,
+                          CachedFile           *file,
                           bool                  keep_alive,
                           const LocationConfig &config);
   SocketResult sendDirectoryListing(int                   client_socket,
-                                    const std::string    &dir_path,
-                                    const std::string    &request_path,
+                                    const ArenaString    &dir_path,
+                                    const ArenaString    &request_path,
                                     bool                  keep_alive,
                                     const LocationConfig &config);
 
  public:
  private:
-  std::string generateDirectoryContent(DIR                  *dir,
-                                       const std::string    &dir_path,
-                                       const std::string    &request_path,
+  ArenaString generateDirectoryContent(DIR                  *dir,
+                                       const ArenaString    &dir_path,
+                                       const ArenaString    &request_path,
                                        const LocationConfig &config,
                                        bool                  delete_allowed);
 
  private:
   bool isCgiScript(const std::string &filepath, const LocationConfig &config);
 
-  void        collectDirectoryEntries(DIR                      *dir,
-                                      const std::string        &dir_path,
-                                      std::vector<std::string> &directories,
-                                      std::vector<std::string> &files);
-  std::string generateSortedEntries(const std::vector<std::string> &entries,
-                                    const std::string              &dir_path,
-                                    const std::string    &request_path,
+  typedef std::vector<ArenaString, ArenaAllocator<ArenaString> > EntryNames;
+
+  void        collectDirectoryEntries(DIR *dir, const ArenaString &dir_path, EntryNames &directories, EntryNames &files);
+  ArenaString generateSortedEntries(const EntryNames     &entries,
+                                    const ArenaString    &dir_path,
+                                    const ArenaString    &request_path,
                                     const LocationConfig &config,
                                     bool                  is_directory,
                                     size_t                max_length,
@@ -23,7 +23,7 @@
  * it sends a 403 Forbidden error response.
  *
  * @param client_socket The socket connected to the client.
- * @param file_path The path of the directory to be handled.
+ * @param directory The open file cache entry of the directory to be handled.
  * @param request_path The original request path from the client.
  * @param keep_alive Indicates whether to keep the connection alive after the response.
  * @param config The location configuration containing settings for the directory handling.
@@ -31,15 +31,17 @@
  */
 
 SocketResult GetHandler::handleDirectory(int                   client_socket,
-                                         const std::string    &file_path,
-                                         const std::string    &request_path,
+                                         CachedFile           *directory,
+                                         const ArenaString    &request_path,
                                          bool                  keep_alive,
                                          const LocationConfig &config) {
-  std::string index_file = HttpUtils::findIndexFile(file_path, config.index_files);
-  if (!index_file.empty()) {
-    return HttpUtils::sendFile(client_socket, index_file, keep_alive, config, 200);
+  // La ruta se copia: buscar el index puede invalidar la entrada del directorio
+  ArenaString dir_path(directory->path.data(), directory->path.size());
+  CachedFile *index_file = HttpUtils::getFileCache().findIndex(directory, config.index_files);
+  if (index_file != NULL) {
+    return HttpUtils::sendCachedFile(client_socket, index_file, keep_alive, config, 200);
   } else if (config.autoindex) {
-    return sendDirectoryListing(client_socket, file_path, request_path, keep_alive, config);
+    return sendDirectoryListing(client_socket, dir_path, request_path, keep_alive, config);
   } else {
     return HttpUtils::sendErrorResponse(client_socket, 403, keep_alive, config);
   }
@@ -63,12 +65,12 @@ SocketResult GetHandler::handleDirectory(int                   client_socket,
  */
 
 SocketResult GetHandler::sendDirectoryListing(int                   client_socket,
-                                              const std::string    &dir_path,
-                                              const std::string    &request_path,
+                                              const ArenaString    &dir_path,
+                                              const ArenaString    &request_path,
                                               bool                  keep_alive,
                                               const LocationConfig &config) {
-  bool        delete_allowed = HttpUtils::isMethodAllowed(config.allowed_methods, "DELETE");
-  std::string response       = HttpGenerator::generate_HTMLHeader2(request_path, delete_allowed);
+  bool        delete_allowed = config.allows(HTTP_METHOD_DELETE);
+  ArenaString response       = HttpGenerator::generate_HTMLHeader2(request_path, delete_allowed);
 
   DIR *dir = opendir(dir_path.c_str());
   if (dir == NULL) {
@@ -88,19 +90,19 @@ SocketResult GetHandler::sendDirectoryListing(int                   client_socke
 
   response += HttpGenerator::generate_HTMLFooter();
 
-  return HttpUtils::sendResponse(client_socket, "text/html", response, 200, keep_alive);
+  return HttpUtils::sendResponse(client_socket, "text/html", response.data(), response.size(), 200, keep_alive);
 }
 
-std::string GetHandler::generateDirectoryContent(DIR                  *dir,
-                                                 const std::string    &dir_path,
-                                                 const std::string    &request_path,
+ArenaString GetHandler::generateDirectoryContent(DIR                  *dir,
+                                                 const ArenaString    &dir_path,
+                                                 const ArenaString    &request_path,
                                                  const LocationConfig &config,
                                                  bool                  delete_allowed) {
-  std::string              content;
-  std::vector<std::string> directories;
-  std::vector<std::string> files;
-   std::string new_request_path;
-  const size_t             MAX_CONTENT_LENGTH = 1000000; // ESTO???
+  ArenaString  content;
+  EntryNames   directories;
+  EntryNames   files;
+  ArenaString  new_request_path;
+  const size_t MAX_CONTENT_LENGTH = 1000000; // ESTO???
   // mirar si quitar
   if (request_path.length() > 1 && request_path[request_path.length() - 1] == '/') {
     new_request_path = request_path.substr(0, request_path.length() - 1);
@@ -153,16 +155,16 @@ std::string GetHandler::generateDirectoryContent(DIR                  *dir,
  * @param files A reference to the vector where file entries will be stored.
  */
 
-void GetHandler::collectDirectoryEntries(DIR                      *dir,
-                                         const std::string        &dir_path,
-                                         std::vector<std::string> &directories,
-                                         std::vector<std::string> &files) {
+void GetHandler::collectDirectoryEntries(DIR               *dir,
+                                         const ArenaString &dir_path,
+                                         EntryNames        &directories,
+                                         EntryNames        &files) {
   struct dirent *ent;
   while ((ent = readdir(dir)) != NULL) {
-    std::string name = ent->d_name;
+    ArenaString name = ent->d_name;
     if (name != "." && name != "..") {
-      std::string full_path = dir_path + "/" + name;
-      if (HttpUtils::isDirectory(full_path)) {
+      ArenaString full_path = dir_path + "/" + name;
+      if (HttpUtils::isDirectory(full_path.c_str())) {
         directories.push_back(name);
       } else {
         files.push_back(name);
@@ -184,18 +186,18 @@ void GetHandler::collectDirectoryEntries(DIR                      *dir,
  * @param files A reference to the vector where file entries will be stored.
  */
 
-std::string GetHandler::generateSortedEntries(const std::vector<std::string> &entries,
-                                              const std::string              &dir_path,
-                                              const std::string              &request_path,
-                                              const LocationConfig           &config,
-                                              bool                            is_directory,
-                                              size_t                          max_length,
-                                              bool                            delete_allowed) {
-  std::string              content;
-  std::vector<std::string> sorted_entries = entries;
+ArenaString GetHandler::generateSortedEntries(const EntryNames     &entries,
+                                              const ArenaString    &dir_path,
+                                              const ArenaString    &request_path,
+                                              const LocationConfig &config,
+                                              bool                  is_directory,
+                                              size_t                max_length,
+                                              bool                  delete_allowed) {
+  ArenaString content;
+  EntryNames  sorted_entries = entries;
   std::sort(sorted_entries.begin(), sorted_entries.end());
 
-  for (std::vector<std::string>::const_iterator it = sorted_entries.begin(); it != sorted_entries.end(); ++it) {
+  for (EntryNames::const_iterator it = sorted_entries.begin(); it != sorted_entries.end(); ++it) {
     if (content.length() + it->length() > max_length) {
       content +=
           "<tr><td colspan=\"4\">... (Listing truncated due to "
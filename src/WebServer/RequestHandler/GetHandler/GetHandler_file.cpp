@@ -21,13 +21,13 @@
  * an error status.
  *
  * @param client_socket The socket connected to the client.
- * @param file_path The path of the file to be sent.
+ * @param file The open file cache entry of the file to be sent.
  * @param keep_alive Indicates whether to keep the connection alive after the response.
  * @param config The location configuration containing settings for the file transfer.
  * @return SOCKET_OK if the file was sent successfully, SOCKET_ERROR otherwise.
  */
 
 SocketResult
-GetHandler::handleFile(int client_socket, const std::string &file_path, bool keep_alive, const LocationConfig &config) {
-  return HttpUtils::sendFile(client_socket, file_path, keep_alive, config, 200);
+GetHandler::handleFile(int client_socket, CachedFile *file, bool keep_alive, const LocationConfig &config) {
+  return HttpUtils::sendCachedFile(client_socket, file, keep_alive, config, 200);
 }
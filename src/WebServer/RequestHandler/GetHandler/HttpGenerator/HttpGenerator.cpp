@@ -14,9 +14,9 @@
 #include "Logger/includes/Logger.hpp"
 #include "WebServer/RequestHandler/GetHandler/GetHandler.hpp"
 #include "CommonDefinitions.hpp"
-std::string HttpGenerator::generate_HTMLHeader2(const std::string &request_path, bool delete_allowed) {
+ArenaString HttpGenerator::generate_HTMLHeader2(const ArenaString &request_path, bool delete_allowed) {
   LOG_DEBUG("Delete allowed: " << delete_allowed);
-  std::string header =
+  ArenaString header =
       "<html>\n"
       "<head>\n"
       "    <title>Directory Explorer</title>\n"
@@ -64,35 +64,34 @@ std::string HttpGenerator::generate_HTMLHeader2(const std::string &request_path,
   return header;
 }
 
-std::string HttpGenerator::generateEntryHtml(const std::string &dir_path,
-                                             const std::string &request_path,
-                                             const std::string &name,
+ArenaString HttpGenerator::generateEntryHtml(const ArenaString &dir_path,
+                                             const ArenaString &request_path,
+                                             const ArenaString &name,
                                              bool               is_dir,
                                              const std::string &location_path,
                                              bool               delete_allowed) {
-  if (request_path == location_path) {
-    if (request_path.substr(request_path.size() - location_path.size()) == location_path) {
-      if (name == "..") {
-        return "";
-      }
-      LOG_DEBUG("Location path: " + location_path);
-      LOG_DEBUG("Name: " + name);
-      LOG_DEBUG("Dir path: " + dir_path);
-      LOG_DEBUG("Request path: " + request_path);
+  if (request_path.compare(location_path.c_str()) == 0) {
+    if (name == "..") {
+      return "";
     }
+    LOG_DEBUG("Location path: " + location_path);
+    LOG_DEBUG("Name: " + name);
+    LOG_DEBUG("Dir path: " + dir_path);
+    LOG_DEBUG("Request path: " + request_path);
   }
 
-  std::string entry = "<tr>";
+  ArenaString entry = "<tr>";
 
   // Añadir icono
-  std::string icon_class = getFileIconClass(name, is_dir);
-  entry += "<td class='icon-column'><i class='" + icon_class + "'></i></td>";
+  entry += "<td class='icon-column'><i class='";
+  entry += getFileIconClass(name, is_dir);
+  entry += "'></i></td>";
 
   // Generar el enlace
   entry += generateLinkHtml(request_path, name);
 
   // tipo de archivo
-  entry += "<td>" + std::string(is_dir ? "Directory" : "File") + "</td>";
+  entry += is_dir ? "<td>Directory</td>" : "<td>File</td>";
 
   // Tamaño y fecha de modificación
   if (name != "..") {
@@ -101,7 +100,7 @@ std::string HttpGenerator::generateEntryHtml(const std::string &dir_path,
     entry += "<td>-</td><td>-</td>";
   }
   if (delete_allowed && name != "..") {
-    std::string deletefile = generateHref(request_path, name);
+    ArenaString deletefile = generateHref(request_path, name);
     entry += "<td><button onclick=\"deleteFile('" + deletefile +
              "')\" style=\"background: none; border: none; cursor: pointer;\"><i "
              "class=\"fas fa-trash-alt\" style=\"color: red;\"></i></button></td>";
@@ -110,14 +109,14 @@ std::string HttpGenerator::generateEntryHtml(const std::string &dir_path,
   return entry + "</tr>\n";
 }
 
-std::string HttpGenerator::getFileIconClass(const std::string &name, bool is_dir) {
+const char *HttpGenerator::getFileIconClass(const ArenaString &name, bool is_dir) {
   if (is_dir) {
     return "fas fa-folder";
   }
 
   size_t dot_pos = name.find_last_of('.');
-  if (dot_pos != std::string::npos) {
-    std::string ext = name.substr(dot_pos + 1);
+  if (dot_pos != ArenaString::npos) {
+    ArenaString ext = name.substr(dot_pos + 1);
     if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "gif") {
       return "fas fa-image";
     } else if (ext == "html" || ext == "htm") {
@@ -131,46 +130,52 @@ std::string HttpGenerator::getFileIconClass(const std::string &name, bool is_dir
   return "fas fa-file"; // Icono por defecto para archivos desconocidos
 }
 
-std::string HttpGenerator::generateLinkHtml(const std::string &request_path, const std::string &name) {
-  std::string href         = generateHref(request_path, name);
-  std::string display_name = (name == "..") ? "Parent Directory" : name;
-
-  return "<td><a href=\"" + href + "\">" + display_name + "</a></td>";
+ArenaString HttpGenerator::generateLinkHtml(const ArenaString &request_path, const ArenaString &name) {
+  ArenaString link = "<td><a href=\"";
+  link += generateHref(request_path, name);
+  link += "\">";
+  if (name == "..")
+    link += "Parent Directory";
+  else
+    link += name;
+  link += "</a></td>";
+  return link;
 }
 
-std::string HttpGenerator::generateHref(const std::string &request_path, const std::string &name) {
+ArenaString HttpGenerator::generateHref(const ArenaString &request_path, const ArenaString &name) {
   if (name == "..") {
     size_t last_slash = request_path.find_last_of('/');
-    return (last_slash != std::string::npos && last_slash > 0) ? request_path.substr(0, last_slash) : "/";
+    return (last_slash != ArenaString::npos && last_slash > 0) ? request_path.substr(0, last_slash) : "/";
   }
 
-  std::string href = (request_path[request_path.length() - 1] != '/') ? request_path + "/" + name : request_path + name;
+  ArenaString href = (request_path[request_path.length() - 1] != '/') ? request_path + "/" + name : request_path + name;
   return href;
 }
 
-std::string HttpGenerator::generateFileInfoHtml(const std::string &full_path, bool is_dir) {
+ArenaString HttpGenerator::generateFileInfoHtml(const ArenaString &full_path, bool is_dir) {
   struct stat st;
   if (stat(full_path.c_str(), &st) != 0) {
     return "<td>-</td><td>-</td>";
   }
 
-  std::string size_html;
-  if (is_dir) {
-    size_html = "-";
-  } else {
-    std::ostringstream oss;
-    oss << st.st_size;
-    size_html = oss.str();
+  char size_buf[32] = "-";
+  if (!is_dir) {
+    snprintf(size_buf, sizeof(size_buf), "%ld", static_cast<long>(st.st_size));
   }
 
   char date_buf[64];
   strftime(date_buf, sizeof(date_buf), "%Y-%m-%d %H:%M:%S", localtime(&st.st_mtime));
 
-  return "<td>" + size_html + "</td><td>" + std::string(date_buf) + "</td>";
+  ArenaString info = "<td>";
+  info += size_buf;
+  info += "</td><td>";
+  info += date_buf;
+  info += "</td>";
+  return info;
 }
 
-std::string HttpGenerator::generate_HTMLFooter() {
-  std::string footer =
+const char *HttpGenerator::generate_HTMLFooter() {
+  return
       "</table>\n"
       "<footer>\n"
       "    <p style=\"margin: 0;\">Powered by AJXWebserver &copy; 2024</p>\n"
@@ -180,8 +185,7 @@ std::string HttpGenerator::generate_HTMLFooter() {
       "        <a href=\"mailto:xamayuel@proton.me\" style=\"color: #4CAF50; "
       "text-decoration: none;\">Support</a>\n"
       "    </p>\n"
-      "      <p style=\"font-size: 12px; margin: 5px 0 0 0;\">Version " +
-      std::string(AJXWEBSERVER_VERSION) +
+      "      <p style=\"font-size: 12px; margin: 5px 0 0 0;\">Version " AJXWEBSERVER_VERSION
       " | "
       "Built with <span style=\"color: #e25555; font-size: 16px; "
       "display: inline-block; transform: scale(1.5, 1.3); margin: 0 "
@@ -190,5 +194,4 @@ std::string HttpGenerator::generate_HTMLFooter() {
       "</footer>\n"
       "</body>\n"
       "</html>";
-  return footer;
 }
\ No newline at end of file
@@ -13,28 +13,32 @@
 #ifndef HTTP_GENERATOR_HPP
 #define HTTP_GENERATOR_HPP
 
+#include "WebServer/RequestArena/RequestArena.hpp"
+
 #include <sys/stat.h>
-#include <sstream>
+#include <cstdio>
+#include <ctime>
 #include <string>
 
+// The listing is built in the RequestArena of the request
 class HttpGenerator {
  public:
-  static std::string generate_HTMLHeader2(const std::string &request_path,
+  static ArenaString generate_HTMLHeader2(const ArenaString &request_path,
                                           bool               delete_allowed);
-  static std::string generateEntryHtml(const std::string &dir_path,
-                                       const std::string &request_path,
-                                       const std::string &name,
+  static ArenaString generateEntryHtml(const ArenaString &dir_path,
+                                       const ArenaString &request_path,
+                                       const ArenaString &name,
                                        bool               is_dir,
                                        const std::string &location_path,
                                        bool               delete_allowed);
-  static std::string getFileIconClass(const std::string &name, bool is_dir);
-  static std::string generateLinkHtml(const std::string &request_path,
-                                      const std::string &name);
-  static std::string generateHref(const std::string &request_path,
-                                  const std::string &name);
-  static std::string generateFileInfoHtml(const std::string &full_path,
+  static const char *getFileIconClass(const ArenaString &name, bool is_dir);
+  static ArenaString generateLinkHtml(const ArenaString &request_path,
+                                      const ArenaString &name);
+  static ArenaString generateHref(const ArenaString &request_path,
+                                  const ArenaString &name);
+  static ArenaString generateFileInfoHtml(const ArenaString &full_path,
                                           bool               is_dir);
-  static std::string generate_HTMLFooter();
+  static const char *generate_HTMLFooter();
 };
 
 #endif
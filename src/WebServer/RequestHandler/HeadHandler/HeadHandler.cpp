@@ -27,9 +27,13 @@ HeadHandler::~HeadHandler() {}
 //                               PROCESS HEAD
 //-----------------------------------------------------------------------------
 SocketResult HeadHandler::processHead() {
-  if (!HttpUtils::isMethodAllowed(_head_location_config.allowed_methods, "HEAD")) {
+  if (!_head_location_config.allows(HTTP_METHOD_HEAD)) {
     return HttpUtils::sendErrorResponse(_head_client_socket, 405, _head_keep_alive, _head_location_config);
   }
 
-  return HttpUtils::sendHead(_head_client_socket, _head_request.getPath(), _head_keep_alive, _head_location_config);
+  // La misma ruta que resolvería GET
+  ArenaString file_path = HttpUtils::buildFilePath(
+      _head_location_config.root_dir, _head_location_config.location_path, _head_request.getPath());
+  return HttpUtils::sendHead(
+      _head_client_socket, file_path.data(), file_path.size(), _head_keep_alive, _head_location_config);
 }
@@ -0,0 +1,323 @@
+#include "MultipartParser.hpp"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Logger/includes/Logger.hpp"
+
+// Relleno permitido tras un delimitador antes del CRLF (RFC 2046 5.1.1)
+#define MULTIPART_MAX_PADDING 256
+
+static bool writeAll(int fd, const char *data, size_t length) {
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    length -= written;
+  }
+  return true;
+}
+
+/**
+ * @brief Value of a parameter (name="value") in the part headers.
+ *
+ * The parameter must start the header block or follow ';', ' ' or a tab,
+ * so "name" does not match inside "filename".
+ *
+ * @param found Set to whether the parameter is present.
+ */
+static std::string headerParam(const std::string &header, const char *param, bool &found) {
+  std::string key = std::string(param) + "=\"";
+  size_t      pos = 0;
+
+  found = false;
+  while ((pos = header.find(key, pos)) != std::string::npos) {
+    if (pos == 0 || header[pos - 1] == ';' || header[pos - 1] == ' ' || header[pos - 1] == '\t') {
+      size_t start = pos + key.size();
+      size_t end   = header.find('"', start);
+      if (end == std::string::npos)
+        return "";
+      found = true;
+      return header.substr(start, end - start);
+    }
+    pos += key.size();
+  }
+  return "";
+}
+
+/**
+ * @param boundary The boundary parameter of the Content-Type, without "--".
+ * @param upload_dir Existing directory where files are stored.
+ */
+MultipartParser::MultipartParser(const std::string &boundary, const std::string &upload_dir)
+    : _state(S_PREAMBLE)
+    , _delimiter("\r\n--" + boundary)
+    , _upload_dir(upload_dir)
+    , _buffer("\r\n") // El primer delimitador puede no ir precedido de CRLF
+    , _error(0)
+    , _is_file(false)
+    , _fd(-1) {
+  // Tabla de saltos de Boyer-Moore-Horspool
+  size_t length = _delimiter.size();
+  for (int i = 0; i < 256; ++i) {
+    _skip[i] = length;
+  }
+  for (size_t i = 0; i + 1 < length; ++i) {
+    _skip[static_cast<unsigned char>(_delimiter[i])] = length - 1 - i;
+  }
+}
+
+MultipartParser::~MultipartParser() {
+  discardPart();
+}
+
+/**
+ * @brief Finds the delimiter in data.
+ *
+ * @return Offset of the first match, std::string::npos if there is none.
+ */
+size_t MultipartParser::search(const char *data, size_t length) const {
+  const size_t pattern_length = _delimiter.size();
+  const char  *pattern        = _delimiter.data();
+
+  if (length < pattern_length)
+    return std::string::npos;
+  size_t pos = 0;
+  while (pos <= length - pattern_length) {
+    unsigned char last = data[pos + pattern_length - 1];
+    if (last == static_cast<unsigned char>(pattern[pattern_length - 1]) &&
+        std::memcmp(data + pos, pattern, pattern_length - 1) == 0) {
+      return pos;
+    }
+    pos += _skip[last];
+  }
+  return std::string::npos;
+}
+
+bool MultipartParser::fail(int code) {
+  _state = S_ERROR;
+  _error = code;
+  discardPart();
+  return false;
+}
+
+/**
+ * @brief Parses the headers of a part and prepares to receive its content.
+ */
+bool MultipartParser::startPart(const std::string &header) {
+  bool has_name;
+
+  _name     = headerParam(header, "name", has_name);
+  _filename = headerParam(header, "filename", _is_file);
+  _value.clear();
+
+  // Solo el nombre: el cliente no puede escribir fuera de upload_path
+  size_t slash = _filename.find_last_of("/\\");
+  if (slash != std::string::npos)
+    _filename = _filename.substr(slash + 1);
+  if (_filename == "." || _filename == "..")
+    _filename.clear();
+  return true;
+}
+
+/**
+ * @brief Stores the next piece of the current part.
+ *
+ * The temporary file of a file part is created with its first byte, so
+ * empty file inputs do not leave anything behind.
+ */
+bool MultipartParser::writePart(const char *data, size_t length) {
+  if (length == 0)
+    return true;
+  if (!_is_file) {
+    if (_value.size() + length > MULTIPART_MAX_FIELD) {
+      LOG_ERROR("POST ERROR - Form field too large: " << _name);
+      return fail(413);
+    }
+    _value.append(data, length);
+    return true;
+  }
+  if (_filename.empty())
+    return true;
+  if (_fd == -1) {
+    std::string       path = _upload_dir + "/.upload_XXXXXX";
+    std::vector<char> temp(path.begin(), path.end());
+    temp.push_back('\0');
+    _fd = mkstemp(&temp[0]);
+    if (_fd == -1) {
+      LOG_ERROR("Failed to create upload file in " << _upload_dir << ": " << strerror(errno));
+      return fail(500);
+    }
+    _temp_path = &temp[0];
+    // mkstemp crea el fichero con 0600; se deja legible como el resto de subidas
+    fchmod(_fd, 0644);
+  }
+  if (!writeAll(_fd, data, length)) {
+    LOG_ERROR("Failed to write to file: " << _temp_path << ": " << strerror(errno));
+    return fail(500);
+  }
+  return true;
+}
+
+/**
+ * @brief Completes the current part; a file is renamed to its final name.
+ */
+bool MultipartParser::endPart() {
+  if (!_is_file) {
+    if (!_name.empty())
+      _fields[_name] = _value;
+    return true;
+  }
+  if (_fd == -1)
+    return true;
+  close(_fd);
+  _fd = -1;
+
+  std::string path = _upload_dir + "/" + _filename;
+  if (std::rename(_temp_path.c_str(), path.c_str()) != 0) {
+    LOG_ERROR("Failed to write to file: " << path << ": " << strerror(errno));
+    unlink(_temp_path.c_str());
+    return fail(500);
+  }
+  LOG_INFO("File saved successfully: " << path);
+  _files.push_back(path);
+  _fields["File name"] = _filename;
+  return true;
+}
+
+/**
+ * @brief Removes the temporary file of an unfinished part.
+ */
+void MultipartParser::discardPart() {
+  if (_fd != -1) {
+    close(_fd);
+    _fd = -1;
+    unlink(_temp_path.c_str());
+  }
+}
+
+/**
+ * @brief Parses the next piece of the body.
+ *
+ * @param data Body bytes, in order.
+ * @param length Number of bytes; any split is accepted.
+ * @return false on error, see errorCode().
+ */
+bool MultipartParser::feed(const char *data, size_t length) {
+  if (_state == S_ERROR)
+    return false;
+  if (_state == S_DONE)
+    return true; // Epílogo, se ignora
+  _buffer.append(data, length);
+
+  while (true) {
+    switch (_state) {
+      case S_PREAMBLE:
+      case S_PART_DATA: {
+        size_t pos = search(_buffer.data(), _buffer.size());
+        if (pos == std::string::npos) {
+          // Se guarda solo lo que aún puede ser el inicio de un delimitador
+          size_t keep = _delimiter.size() - 1;
+          if (_buffer.size() > keep) {
+            size_t ready = _buffer.size() - keep;
+            if (_state == S_PART_DATA && !writePart(_buffer.data(), ready))
+              return false;
+            _buffer.erase(0, ready);
+          }
+          return true;
+        }
+        if (_state == S_PART_DATA && (!writePart(_buffer.data(), pos) || !endPart()))
+          return false;
+        _buffer.erase(0, pos + _delimiter.size());
+        _state = S_DELIMITER;
+        break;
+      }
+
+      case S_DELIMITER: {
+        if (_buffer.size() < 2)
+          return true;
+        if (_buffer[0] == '-' && _buffer[1] == '-') {
+          _state = S_DONE;
+          _buffer.clear();
+          return true;
+        }
+        size_t eol = _buffer.find("\r\n");
+        if (eol == std::string::npos) {
+          if (_buffer.size() > MULTIPART_MAX_PADDING)
+            return fail(400);
+          return true;
+        }
+        if (_buffer.find_first_not_of(" \t") < eol)
+          return fail(400);
+        _buffer.erase(0, eol + 2);
+        _state = S_PART_HEADER;
+        break;
+      }
+
+      case S_PART_HEADER: {
+        size_t end = std::string::npos;
+        size_t skip = 0;
+        if (_buffer.compare(0, 2, "\r\n") == 0) {
+          end  = 0; // Parte sin cabeceras
+          skip = 2;
+        } else if ((end = _buffer.find("\r\n\r\n")) != std::string::npos) {
+          skip = end + 4;
+        } else {
+          if (_buffer.size() > MULTIPART_MAX_PART_HEADER)
+            return fail(400);
+          return true;
+        }
+        if (!startPart(_buffer.substr(0, end)))
+          return false;
+        _buffer.erase(0, skip);
+        _state = S_PART_DATA;
+        break;
+      }
+
+      case S_DONE:
+        return true;
+      case S_ERROR:
+        return false;
+    }
+  }
+}
+
+/**
+ * @brief Checks that the body ended with the closing delimiter.
+ *
+ * An unfinished file part is removed.
+ */
+bool MultipartParser::finish() {
+  if (_state == S_DONE)
+    return true;
+  if (_state != S_ERROR) {
+    LOG_ERROR("POST ERROR - Truncated multipart body");
+    fail(400);
+  }
+  return false;
+}
+
+/**
+ * @brief HTTP status for the error that stopped the parser, 0 if none.
+ */
+int MultipartParser::errorCode() const {
+  return _error;
+}
+
+const std::map<std::string, std::string> &MultipartParser::fields() const {
+  return _fields;
+}
+
+/**
+ * @brief Paths of the files stored, in order.
+ */
+const std::vector<std::string> &MultipartParser::files() const {
+  return _files;
+}
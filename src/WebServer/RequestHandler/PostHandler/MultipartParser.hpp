@@ -0,0 +1,69 @@
+#ifndef MULTIPART_PARSER_HPP
+#define MULTIPART_PARSER_HPP
+
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// Maximum size of the headers of one part
+#define MULTIPART_MAX_PART_HEADER 8192
+// Maximum size of the value of a text field
+#define MULTIPART_MAX_FIELD 65536
+
+// MultipartParser: incremental multipart/form-data parser
+//
+// feed() accepts the body in pieces of any size and only keeps the bytes
+// that may still be the start of a delimiter, so memory does not depend on
+// the size of the parts. Delimiters are searched with Boyer-Moore-Horspool.
+//
+// File parts are written as they arrive to a temporary file in the upload
+// directory, which is renamed to its final name once the part is complete.
+// Text fields are kept in memory, up to MULTIPART_MAX_FIELD bytes each.
+class MultipartParser {
+ public:
+  MultipartParser(const std::string &boundary, const std::string &upload_dir);
+  ~MultipartParser();
+
+  bool feed(const char *data, size_t length);
+  bool finish();
+
+  int                                       errorCode() const;
+  const std::map<std::string, std::string> &fields() const;
+  const std::vector<std::string>           &files() const;
+
+ private:
+  enum State {
+    S_PREAMBLE,    // Antes del primer delimitador
+    S_DELIMITER,   // Tras un delimitador: "--" o CRLF
+    S_PART_HEADER, // Cabeceras de la parte
+    S_PART_DATA,   // Contenido de la parte
+    S_DONE,        // Delimitador final leído
+    S_ERROR
+  };
+
+  State                              _state;
+  std::string                        _delimiter;
+  size_t                             _skip[256];
+  std::string                        _upload_dir;
+  std::string                        _buffer;
+  int                                _error;
+  bool                               _is_file;
+  std::string                        _name;
+  std::string                        _filename;
+  std::string                        _value;
+  std::string                        _temp_path;
+  int                                _fd;
+  std::map<std::string, std::string> _fields;
+  std::vector<std::string>           _files;
+
+  size_t search(const char *data, size_t length) const;
+  bool   fail(int code);
+  bool   startPart(const std::string &header);
+  bool   writePart(const char *data, size_t length);
+  bool   endPart();
+  void   discardPart();
+};
+
+#endif // MULTIPART_PARSER_HPP
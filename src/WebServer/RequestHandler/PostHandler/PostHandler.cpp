@@ -1,11 +1,16 @@
 // PostHandler.cpp
 #include "PostHandler.hpp"
 
-PostHandler::PostHandler(int client_socket, const LocationConfig &loc_config, RequestParser &request, bool keep_alive)
+PostHandler::PostHandler(int                   client_socket,
+                         const LocationConfig &loc_config,
+                         RequestParser        &request,
+                         bool                  keep_alive,
+                         MultipartParser      *upload)
     : _post_client_socket(client_socket)
     , _post_location_config(loc_config)
     , _post_request(request)
-    , _post_keep_alive(keep_alive) {
+    , _post_keep_alive(keep_alive)
+    , _post_upload(upload) {
   LOG_DEBUG("PostHandler constructor called");
 }
 
@@ -14,7 +19,7 @@ PostHandler::~PostHandler() {
 }
 
 SocketResult PostHandler::processPost() {
-  if (!HttpUtils::isMethodAllowed(_post_location_config.allowed_methods, "POST")) {
+  if (!_post_location_config.allows(HTTP_METHOD_POST)) {
     return HttpUtils::sendErrorResponse(_post_client_socket, 405, _post_keep_alive, _post_location_config);
   }
   std::string file_path = HttpUtils::constructFilePath(
@@ -27,19 +32,19 @@ SocketResult PostHandler::processPost() {
   }
 
   // METER REDIRECCIONES?
-  std::string contentType = _post_request.getHeader("Content-Type");
+  const ArenaString &contentType = _post_request.getHeader("Content-Type");
 
   if (contentType.empty()) {
     LOG_ERROR("POST ERROR - NO CONTENT-TYPE");
     return HttpUtils::sendErrorResponse(_post_client_socket, 400, _post_keep_alive, _post_location_config);
   }
-  if (contentType.find("multipart/form-data") != std::string::npos) {
+  if (contentType.find("multipart/form-data") != ArenaString::npos) {
     std::string boundary = extractBoundary(contentType);
     if (boundary.empty()) {
       LOG_ERROR("POST ERROR - No boundary found in multipart request");
       return HttpUtils::sendErrorResponse(_post_client_socket, 400, _post_keep_alive, _post_location_config);
     }
-    return processMultipartData(_post_client_socket, _post_request.getBody(), boundary);
+    return processMultipartData(_post_client_socket);
   } else {
     LOG_ERROR("POST ERROR - UNSUPPORTED CONTENT-TYPE: " << contentType);
     std::string errorMessage =
@@ -49,102 +54,92 @@ SocketResult PostHandler::processPost() {
   }
 }
 
-SocketResult PostHandler::processMultipartData(int clientSocket, const std::string &data, const std::string &boundary) {
-  std::vector<std::string> parts = splitMultipartBody(data, boundary);
-
-  bool                               fileUploaded = false;
-  std::map<std::string, std::string> formFields;
-  unsigned int                       max_body_size = _post_location_config.client_max_body_size;
-
-  if (data.size() > max_body_size) {
-    return HttpUtils::sendErrorResponse(clientSocket, 413, _post_keep_alive, _post_location_config);
+/**
+ * @brief Creates the parser that receives a multipart upload as it arrives.
+ *
+ * Called when the request header is complete. The event loop feeds every
+ * piece of body to the parser, which writes each file part straight to
+ * upload_path, so the body is never stored and read back.
+ *
+ * @param loc_config The location of the request.
+ * @param request The request, parsed without its body.
+ * @return A parser owned by the caller, or NULL if the body is not an
+ *         upload this handler stores (CGI, other content types, POST not
+ *         allowed...).
+ */
+MultipartParser *PostHandler::startUpload(const LocationConfig &loc_config, const RequestParser &request) {
+  if (!loc_config.allows(HTTP_METHOD_POST)) {
+    return NULL;
   }
-
-  for (std::vector<std::string>::const_iterator it = parts.begin(); it != parts.end(); ++it) {
-    if (isFilePart(*it)) {
-      std::string filename = extractFilename(*it);
-      std::string content  = extractContent(*it);
-
-      if (!filename.empty() && !content.empty()) {
-        if (saveUploadedFile(filename, content)) {
-          fileUploaded = true;
-        }
-        formFields["File name"] = filename;
-      }
-    } else {
-      std::pair<std::string, std::string> field = processTextPart(*it);
-      if (!field.first.empty()) {
-        formFields[field.first] = field.second;
-      }
-    }
-    LOG_DEBUG("File uploaded: " << fileUploaded);
+  std::string file_path =
+      HttpUtils::constructFilePath(loc_config.root_path, loc_config.location_path, request.getPath());
+  if (HttpUtils::isCgiScript(file_path, loc_config)) {
+    return NULL;
   }
-
-  std::string responseMessage = generateResponseMessage(formFields);
-  return HttpUtils::sendResponse(clientSocket, "text/html", responseMessage, 200, _post_keep_alive);
-}
-
-std::string PostHandler::extractBoundary(const std::string &contentType) {
-  size_t boundaryPos = contentType.find("boundary=");
-  if (boundaryPos != std::string::npos) {
-    return "--" + contentType.substr(boundaryPos + 9);
+  const ArenaString &contentType = request.getHeader("Content-Type");
+  if (contentType.find("multipart/form-data") == ArenaString::npos) {
+    return NULL;
   }
-  return "";
-}
-
-std::vector<std::string> PostHandler::splitMultipartBody(const std::string &body, const std::string &boundary) {
-  std::vector<std::string> parts;
-  size_t                   pos         = 0;
-  size_t                   boundaryLen = boundary.length();
-
-  while ((pos = body.find(boundary, pos)) != std::string::npos) {
-    size_t start = pos + boundaryLen + 2; // +2 for CRLF
-    size_t end   = body.find(boundary, start);
-
-    if (end == std::string::npos)
-      break;
-
-    parts.push_back(body.substr(start, end - start - 2)); // -2 to remove CRLF
-    pos = end;
+  std::string boundary = extractBoundary(contentType);
+  if (boundary.empty()) {
+    return NULL;
   }
 
-  return parts;
-}
-
-bool PostHandler::isFilePart(const std::string &part) {
-  return part.find("filename=") != std::string::npos;
-}
-
-std::string PostHandler::extractFilename(const std::string &part) {
-  size_t filenamePos = part.find("filename=\"");
-  if (filenamePos != std::string::npos) {
-    size_t filenameEnd = part.find("\"", filenamePos + 10);
-    return part.substr(filenamePos + 10, filenameEnd - (filenamePos + 10));
+  std::string uploadPath = loc_config.upload_path;
+  if (uploadPath.empty()) {
+    uploadPath = "./uploads/";
   }
-  return "";
+  mkdir(uploadPath.c_str(), 0777);
+  return new MultipartParser(boundary, uploadPath);
 }
 
-std::string PostHandler::extractFieldName(const std::string &part) {
-  size_t namePos = part.find("name=\"");
-  if (namePos != std::string::npos) {
-    size_t nameEnd = part.find("\"", namePos + 6);
-    return part.substr(namePos + 6, nameEnd - (namePos + 6));
+/**
+ * @brief Completes a multipart/form-data upload and answers it.
+ *
+ * The parts were already parsed and stored while the body was received;
+ * this only checks that the body ended properly.
+ *
+ * @param clientSocket The client socket.
+ * @return The result of sending the response.
+ */
+SocketResult PostHandler::processMultipartData(int clientSocket) {
+  if (_post_upload == NULL) {
+    // Solo ocurre sin cuerpo: el parser se crea si la cabecera anuncia uno
+    LOG_ERROR("POST ERROR - Truncated multipart body");
+    return HttpUtils::sendErrorResponse(clientSocket, 400, _post_keep_alive, _post_location_config);
   }
-  return "";
-}
-
-std::string PostHandler::extractContent(const std::string &part) {
-  size_t headerEnd = part.find("\r\n\r\n");
-  if (headerEnd != std::string::npos) {
-    return part.substr(headerEnd + 4);
+  if (!_post_upload->finish()) {
+    return HttpUtils::sendErrorResponse(
+        clientSocket, _post_upload->errorCode(), _post_keep_alive, _post_location_config);
   }
-  return "";
+  LOG_DEBUG("Files uploaded: " << _post_upload->files().size());
+
+  std::string responseMessage = generateResponseMessage(_post_upload->fields());
+  return HttpUtils::sendResponse(clientSocket, "text/html", responseMessage, 200, _post_keep_alive);
 }
 
-std::pair<std::string, std::string> PostHandler::processTextPart(const std::string &part) {
-  std::string name  = extractFieldName(part);
-  std::string value = extractContent(part);
-  return std::make_pair(name, value);
+/**
+ * @brief Extracts the boundary parameter from a multipart Content-Type.
+ *
+ * @return The boundary, without quotes, or an empty string.
+ */
+std::string PostHandler::extractBoundary(const ArenaString &contentType) {
+  size_t start = contentType.find("boundary=");
+  if (start == ArenaString::npos) {
+    return "";
+  }
+  start += 9;
+  size_t end;
+  if (start < contentType.size() && contentType[start] == '"') {
+    end = contentType.find('"', ++start);
+    if (end == ArenaString::npos) {
+      return "";
+    }
+  } else {
+    end = std::min(contentType.find_first_of("; \t", start), contentType.size());
+  }
+  // El boundary vive en el MultipartParser, más que la petición
+  return std::string(contentType.data() + start, end - start);
 }
 
 std::string PostHandler::generateResponseMessage(const std::map<std::string, std::string> &formFields) {
@@ -299,30 +294,3 @@ std::string PostHandler::generateResponseMessage(const std::map<std::string, std
       << "</html>\n";
   return oss.str();
 }*/
-
-bool PostHandler::saveUploadedFile(const std::string &filename, const std::string &content) {
-  std::string uploadPath = _post_location_config.upload_path;
-  if (uploadPath.empty()) {
-    uploadPath = "./uploads/";
-  }
-
-  mkdir(uploadPath.c_str(), 0777);
-
-  std::string   fullPath = uploadPath + "/" + filename;
-  std::ofstream file(fullPath.c_str(), std::ios::binary);
-  if (!file) {
-    LOG_ERROR("Failed to open file for writing: " << fullPath);
-    return false;
-  }
-
-  file.write(content.c_str(), content.length());
-  file.close();
-
-  if (!file) {
-    LOG_ERROR("Failed to write to file: " << fullPath);
-    return false;
-  }
-
-  LOG_INFO("File saved successfully: " << fullPath);
-  return true;
-}
@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include "CommonDefinitions.hpp"
+#include "MultipartParser.hpp"
 #include "RequestParser/RequestParser.hpp"
 #include "WebServer/HttpUtils/HttpUtils.hpp"
 #include "WebServer/RequestHandler/GetHandler/GetHandler.hpp"
@@ -19,36 +20,30 @@ class PostHandler {
   const LocationConfig &_post_location_config;
   RequestParser        &_post_request;
   bool                  _post_keep_alive;
+  MultipartParser      *_post_upload; // Cuerpo multipart ya procesado al recibirlo
 
  public:
   PostHandler(int                   client_socket,
               const LocationConfig &loc_config,
               RequestParser        &request,
-              bool                  keep_alive);
+              bool                  keep_alive,
+              MultipartParser      *upload = NULL);
   ~PostHandler();
 
   SocketResult processPost();
 
+  static MultipartParser *startUpload(const LocationConfig &loc_config, const RequestParser &request);
+
  private:
   void ValidatePost();
   void HeaderandBody();
 
   SocketResult handleFileUpload(int clientSocket);
-  SocketResult processMultipartData(int                clientSocket,
-                                    const std::string &data,
-                                    const std::string &boundary);
-  bool saveUploadedFile(const std::string &filename, const std::string &content);
+  SocketResult processMultipartData(int clientSocket);
 
   // Nuevas funciones para manejar multipart/form-data
-  std::string              extractBoundary(const std::string &contentType);
-  std::vector<std::string> splitMultipartBody(const std::string &body,
-                                              const std::string &boundary);
-  bool                     isFilePart(const std::string &part);
-  std::string              extractFilename(const std::string &part);
-  std::string              extractFieldName(const std::string &part);
-  std::string              extractContent(const std::string &part);
-  std::pair<std::string, std::string> processTextPart(const std::string &part);
-  std::string                         generateResponseMessage(
+  static std::string extractBoundary(const ArenaString &contentType);
+  std::string generateResponseMessage(
                               const std::map<std::string, std::string> &formFields);
 };
 
@@ -3,36 +3,40 @@
 #include "../../ConfigFileParse/ConfigurationManager.hpp"
 #include "../../RequestParser/RequestParser.hpp"
 #include "../WebServer.hpp"
+#include "WebServer/ResponseHead/ResponseHead.hpp"
 #include "CommonDefinitions.hpp"
 
 RequestHandler::RequestHandler(ConfigurationManager &config) : config(config), getHandler(config) {
   LOG_DEBUG("RequestHandler initialized");
 }
 
-SocketResult RequestHandler::handle_request(int         client_socket,
-                                            const char *request_data,
-                                            size_t      request_size,
-                                            int         server_port,
-                                            int         client_id,
-                                            size_t     *bytes_read) {
-  if (bytes_read == NULL) {
-    LOG_ERROR("bytes_read pointer is null");
-    return SOCKET_ERROR;
-  }
-
+/**
+ * @brief Handles a request framed by the connection's HttpScanner.
+ *
+ * @param client_socket The client socket.
+ * @param request The connection buffer holding the request.
+ * @param scan The scanner that framed the request (done or failed).
+ * @param body The body streamed out of the request buffer.
+ * @param upload The parser that received a multipart body, NULL if none.
+ * @param server_port The port that accepted the connection.
+ * @param client_id The client id used in the logs.
+ * @return The result of sending the response.
+ */
+SocketResult RequestHandler::handle_request(int                client_socket,
+                                            const InputBuffer &request,
+                                            const HttpScanner &scan,
+                                            const RequestBody &body,
+                                            MultipartParser   *upload,
+                                            int                server_port,
+                                            int                client_id) {
   LOG_DEBUG("Handling request on socket: " << client_socket << ", client ID: " << client_id
-                                          << ", server_port : " << server_port << ", request size: " << request_size);
+                                          << ", server_port : " << server_port << ", request size: " << scan.requestEnd());
 
   RequestParser parser;
-  parser.parseRequest(std::string(request_data, request_size));
+  parser.parseRequest(request, scan, &body);
 
-  std::string request_method = parser.getMethod();
-  std::string request_path   = parser.getPath();
-  std::string hostname       = get_hostname(parser.getHeader("Host"));
-
-  LocationConfig loc_config;
-  Server        *server = config.get_server(hostname, server_port, request_path);
-  loc_config            = create_location_config(server);
+  const ArenaString    &request_method = parser.getMethod();
+  const LocationConfig &loc_config     = get_location_config(parser, server_port);
 
   if (parser.getErrorCode() && !parser.isComplete()) {
     LOG_ERROR("Parsing error or incomplete request");
@@ -44,7 +48,6 @@ SocketResult RequestHandler::handle_request(int         client_socket,
   }
 
 // PARSER DEL REQUEST
-  //save_request_to_file(std::string(request_data, request_size), "", 0);
   //save_parsing_request_to_file(parser);
 
 
@@ -55,7 +58,7 @@ SocketResult RequestHandler::handle_request(int         client_socket,
   if (request_method == "GET") {
     method_result = handle_get_request(client_socket, parser, loc_config, true);
   } else if (request_method == "POST") {
-    method_result = handle_post_request(client_socket, loc_config, parser, true);
+    method_result = handle_post_request(client_socket, loc_config, parser, upload, true);
   } else if (request_method == "DELETE") {
     method_result = handle_delete_request(client_socket, loc_config, parser, true);
   } else if (request_method == "PUT") {
@@ -66,12 +69,56 @@ SocketResult RequestHandler::handle_request(int         client_socket,
     method_result = handle_unsupported_method(client_socket, true);
   }
 
-  *bytes_read = request_size;
   return method_result;
 }
 
 
 
+/**
+ * @brief Decides where the body of a request goes before it is received.
+ *
+ * Called as soon as the header is complete, so an oversized body can be
+ * refused before it is received and a multipart upload can be parsed as it
+ * arrives instead of being stored first.
+ *
+ * @param request The connection buffer holding the header.
+ * @param scan The scanner, with the header complete.
+ * @param server_port The port that accepted the connection.
+ * @param upload Set to the parser the body must be fed to, owned by the
+ *               caller, or NULL if the body goes to the RequestBody.
+ * @return The body limit of the matching location.
+ */
+size_t RequestHandler::prepare_body(const InputBuffer &request,
+                                    const HttpScanner &scan,
+                                    int                server_port,
+                                    MultipartParser  *&upload) {
+  RequestParser parser;
+  parser.parseRequest(request, scan);
+  const LocationConfig &loc_config = get_location_config(parser, server_port);
+
+  upload = NULL;
+  if (parser.getMethod() == "POST") {
+    upload = PostHandler::startUpload(loc_config, parser);
+  }
+  return loc_config.client_max_body_size;
+}
+
+/**
+ * @brief Sends 413 for a body over the limit, before it has been read.
+ *
+ * The rest of the body is never read, so the connection must be closed
+ * after this.
+ *
+ * @return The result of sending the response.
+ */
+SocketResult
+RequestHandler::reject_body(int client_socket, const InputBuffer &request, const HttpScanner &scan, int server_port) {
+  RequestParser parser;
+  parser.parseRequest(request, scan);
+  LOG_WARNING("Client maximun size exceeded.");
+  return HttpUtils::sendErrorResponse(client_socket, 413, false, get_location_config(parser, server_port));
+}
+
 SocketResult
 RequestHandler::read_and_parse_request(int client_socket, std::string &request, bool &keep_alive, size_t *bytes_read) {
   char    buffer[4096];
@@ -100,9 +147,13 @@ RequestHandler::read_and_parse_request(int client_socket, std::string &request,
  return SOCKET_WOULD_BLOCK;
 }
 
-std::string RequestHandler::get_hostname(const std::string &host_header) {
+/**
+ * @brief Length of the hostname at the start of a Host header, without
+ *        the port.
+ */
+size_t RequestHandler::get_hostname_length(const ArenaString &host_header) {
   size_t colonPos = host_header.find(':');
-  return (colonPos != std::string::npos) ? host_header.substr(0, colonPos) : host_header;
+  return (colonPos != ArenaString::npos) ? colonPos : host_header.size();
 }
 
 SocketResult RequestHandler::handle_get_request(int                   client_socket,
@@ -123,8 +174,9 @@ SocketResult RequestHandler::handle_head_request(int                   client_so
 SocketResult RequestHandler::handle_post_request(int                   client_socket,
                                                  const LocationConfig &config,
                                                  RequestParser        &request,
+                                                 MultipartParser      *upload,
                                                  bool                  keep_alive) {
-  PostHandler post(client_socket, config, request, keep_alive);
+  PostHandler post(client_socket, config, request, keep_alive, upload);
   return post.processPost();
 }
 
@@ -167,55 +219,40 @@ SocketResult RequestHandler::send_response(int                client_socket,
                                            const std::string &content,
                                            int                status_code,
                                            bool               keep_alive) {
-  std::string status_line;
-  switch (status_code) {
-    case 200:
-      status_line = "HTTP/1.1 200 OK";
-      break;
-    case 404:
-      status_line = "HTTP/1.1 404 Not Found";
-      break;
-    case 405:
-      status_line = "HTTP/1.1 405 Method Not Allowed";
-      break;
-    default:
-      status_line = "HTTP/1.1 500 Internal Server Error";
+  // Solo se responde con los códigos que genera este manejador
+  if (status_code != 200 && status_code != 404 && status_code != 405) {
+    status_code = 500;
   }
+  LOG_INFO("HTTP/1.1 " << status_code << " " << HttpUtils::getStatusMessage(status_code));
 
-  LOG_INFO(status_line);
-  std::string response = status_line + "\r\n";
-  response += "Content-Type: " + content_type + "\r\n";
-
-  std::ostringstream content_length_stream;
-  content_length_stream << content.length();
-  response += "Content-Length: " + content_length_stream.str() + "\r\n";
-
+  OutputQueue *output = HttpUtils::getOutput(client_socket);
+  if (output == NULL) {
+    LOG_ERROR("Error sending response");
+    return SOCKET_ERROR;
+  }
+  output->setStatus(status_code);
+
+  std::string &head = output->headBuffer();
+  ResponseHead builder(head);
+  builder.status(status_code);
+  builder.header("Content-Type", content_type);
+  builder.contentLength(content.length());
+  builder.connection(keep_alive);
   if (keep_alive) {
-    response += "Connection: keep-alive\r\n";
-    response += "Keep-Alive: timeout=5, max=1000\r\n";
-  } else {
-    response += "Connection: close\r\n";
+    head.append("Keep-Alive: timeout=5, max=1000\r\n");
   }
-
-  response += "\r\n";
-  response += content;
-
-  size_t total_sent = 0;
-  size_t bytes_left = response.length();
-
-  while (total_sent < response.length()) {
-    ssize_t bytes_sent = send(client_socket, response.c_str() + total_sent, bytes_left, MSG_DONTWAIT | MSG_NOSIGNAL);
-    if (bytes_sent > 0) {
-      total_sent += bytes_sent;
-      bytes_left -= bytes_sent;
-    } else if (bytes_sent == 0) {
-      return SOCKET_CLOSED;
-    } else {
-      LOG_ERROR("Error sending response");
-      return SOCKET_ERROR;
-    }
+  builder.end();
+
+  // Cabecera y cuerpo en una escritura agrupada; lo que no sale se encola
+  struct iovec iov[2];
+  iov[0].iov_base = const_cast<char *>(head.data());
+  iov[0].iov_len  = head.size();
+  iov[1].iov_base = const_cast<char *>(content.data());
+  iov[1].iov_len  = content.size();
+  if (output->appendGather(client_socket, iov, 2) != SOCKET_OK) {
+    LOG_ERROR("Error sending response");
+    return SOCKET_ERROR;
   }
-
   return SOCKET_OK;
 }
 
@@ -249,26 +286,6 @@ std::string RequestHandler::get_current_time() {
   return std::string(buf);
 }
 
-void RequestHandler::save_request_to_file(const std::string &request, const char *client_ip, int client_port) {
-  std::string filename = "requests.txt";
-  (void)client_ip;
-  (void)client_port;
-  // Open the file in append mode
-  std::ofstream file(filename.c_str(), std::ios::app);
-  LOG_WARNING("Saving request to file");
-  if (file.is_open()) {
-    // Add a separator and metadata before each new request
-    file << "\n----- New Request -----\n";
-    file << request << "\n";
-    file << "----- End of Request -----\n\n";
-
-    file.close();
-    LOG_INFO("Request appended to file: " << filename);
-  } else {
-    LOG_ERROR("Unable to open file for appending request: " << filename);
-  }
-}
-
 void RequestHandler::save_parsing_request_to_file(const RequestParser &request) {
   std::string filename = "parsed_requests.txt";
 
@@ -289,7 +306,7 @@ void RequestHandler::save_parsing_request_to_file(const RequestParser &request)
 }
 
 std::string RequestHandler::get_root_path(int server_port) {
-  std::vector<Server> servers = config.get_servers();
+  const std::vector<Server> &servers = config.get_servers();
   for (size_t i = 0; i < servers.size(); ++i) {
     if (servers[i].getListen() == server_port) {
       return servers[i].getRootPath();
@@ -308,38 +325,15 @@ std::string RequestHandler::join_strings(const std::vector<std::string> &strings
   return result;
 }
 
-LocationConfig RequestHandler::create_location_config(const Server *server) {
-  LocationConfig config;
-
-  config.location_path        = server->getLocationPath();
-  config.root_path            = server->getRootPath();
-  config.autoindex            = server->getAutoindex();
-  config.client_max_body_size = server->getClientMaxBodySize();
-  config.allowed_methods      = server->getAllowedMethods();
-  config.error_pages          = server->getErrorPages();
-  config.index_files          = server->getIndex();
-  config.cgi_extensions       = server->getLocationCgiHandler();
-  config.upload_path          = server->getUploadPath();
-  config.return_code_path     = server->getReturnCodePath();
-  LOG_DEBUG("Using location-specific configuration for path: " << server->getLocationPath());
-  return config;
+/**
+ * @brief The compiled location that serves a request. Nothing is copied:
+ *        the reference stays valid as long as the configuration.
+ */
+const LocationConfig &RequestHandler::get_location_config(const RequestParser &parser, int server_port) {
+  const ArenaString    &host     = parser.getHeader("Host");
+  const ArenaString    &path     = parser.getPath();
+  const LocationConfig &location =
+      config.get_location(host.data(), get_hostname_length(host), server_port, path.data(), path.size());
+  LOG_DEBUG("Using location-specific configuration for path: " << location.location_path);
+  return location;
 }
-
-bool RequestHandler::isRequestComplete(const ClientInfo &client) const {
-    size_t header_end = client.partial_request.find("\r\n\r\n");
-    if (header_end == std::string::npos) {
-        return false;
-    }
-
-    std::string headers = client.partial_request.substr(0, header_end);
-    size_t content_length_pos = headers.find("Content-Length: ");
-    if (content_length_pos != std::string::npos) {
-        size_t content_length_end = headers.find("\r\n", content_length_pos);
-        std::string content_length_str = headers.substr(content_length_pos + 16, content_length_end - (content_length_pos + 16));
-        size_t content_length = std::atoi(content_length_str.c_str());
-        return client.bytes_received >= (header_end + 4 + content_length);
-    }
-
-    // Si no hay Content-Length, asumimos que la solicitud está completa si tenemos los encabezados
-    return true;
-}
\ No newline at end of file
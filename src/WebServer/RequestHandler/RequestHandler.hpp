@@ -42,14 +42,19 @@ class RequestHandler {
 
   // ---------------METHODS------------------------------------------------------
  public:
-  bool         isRequestComplete(const ClientInfo &client) const;
   std::string  get_root_path(int server_port);
-  SocketResult handle_request(int         client_socket,
-                              const char *request_data,
-                              size_t      request_size,
-                              int         server_port,
-                              int         client_id,
-                              size_t     *bytes_read);
+  SocketResult handle_request(int                client_socket,
+                              const InputBuffer &request,
+                              const HttpScanner &scan,
+                              const RequestBody &body,
+                              MultipartParser   *upload,
+                              int                server_port,
+                              int                client_id);
+  size_t       prepare_body(const InputBuffer &request,
+                            const HttpScanner &scan,
+                            int                server_port,
+                            MultipartParser  *&upload);
+  SocketResult reject_body(int client_socket, const InputBuffer &request, const HttpScanner &scan, int server_port);
 
  private:
   SocketResult read_request(int          client_socket,
@@ -64,9 +69,6 @@ class RequestHandler {
   void        log_request(const std::string &message, const std::string &url);
   std::string get_current_time();
   void        save_parsing_request_to_file(const RequestParser &request);
-  void        save_request_to_file(const std::string &request,
-                                   const char        *client_ip,
-                                   int                client_port);
   void        log_server_config(const Server &server, size_t server_num);
   void        log_error_pages(const std::map<int, std::string> &error_pages);
 
@@ -78,7 +80,7 @@ class RequestHandler {
                                        std::string &request,
                                        bool        &keep_alive,
                                        size_t      *bytes_read);
-  std::string   get_hostname(const std::string &host_header);
+  size_t        get_hostname_length(const ArenaString &host_header);
   const Server *get_server(const std::string &hostname, int server_port);
 
   SocketResult handle_get_request(int                   client_socket,
@@ -92,6 +94,7 @@ class RequestHandler {
   SocketResult handle_post_request(int                   client_socket,
                                    const LocationConfig &config,
                                    RequestParser        &request,
+                                   MultipartParser      *upload,
                                    bool                  keep_alive);
   SocketResult handle_delete_request(int                   client_socket,
                                      const LocationConfig &config,
@@ -100,7 +103,7 @@ class RequestHandler {
   SocketResult handle_unsupported_method(int client_socket, bool keep_alive);
 
   // ---------------UTILS------------------------------------------------------
-  LocationConfig create_location_config(const Server *server);
+  const LocationConfig &get_location_config(const RequestParser &parser, int server_port);
 };
 
 #endif // REQUEST_HANDLER_HPP
\ No newline at end of file
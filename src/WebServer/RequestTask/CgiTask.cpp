@@ -0,0 +1,154 @@
+#include "CgiTask.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include "Logger/includes/Logger.hpp"
+#include "WebServer/Clock/Clock.hpp"
+#include "WebServer/EventLoop/EventLoop.hpp"
+#include "WebServer/HttpUtils/HttpUtils.hpp"
+
+// Sondeo del proceso hijo cuando no hay pidfd
+#define CGI_REAP_POLL_MS 100
+
+/**
+ * @param pipe_fd Read end of the script's stdout; the task owns it.
+ */
+CgiTask::CgiTask(int client_socket, pid_t pid, int pipe_fd, bool keep_alive, const LocationConfig &config)
+    : RequestTask(client_socket),
+      _state(S_READING),
+      _pid(pid),
+      _pipe_fd(pipe_fd),
+      _pid_fd(-1),
+      _keep_alive(keep_alive),
+      _config(config),
+      _deadline_ms(Clock::monotonicMs() + CGI_TIMEOUT_MS) {
+  fcntl(_pipe_fd, F_SETFL, fcntl(_pipe_fd, F_GETFL, 0) | O_NONBLOCK);
+  fcntl(_pipe_fd, F_SETFD, FD_CLOEXEC);
+  waitFor(_pipe_fd, IO_READ, _deadline_ms);
+}
+
+/**
+ * @brief Closes the descriptors and kills the script if it is still running
+ *        (the connection was closed before it finished).
+ */
+CgiTask::~CgiTask() {
+  if (_pipe_fd != -1) {
+    close(_pipe_fd);
+  }
+  if (_pid_fd != -1) {
+    close(_pid_fd);
+  }
+  if (_pid > 0) {
+    ::kill(_pid, SIGKILL);
+    waitpid(_pid, NULL, 0);
+  }
+}
+
+/**
+ * @brief Reads the available output, or checks the child once it exited.
+ */
+TaskStatus CgiTask::resume(unsigned int events) {
+  (void)events;
+  if (_state == S_EXITING) {
+    return reap();
+  }
+  // Un script que no para de escribir despierta la tarea sin que venza el plazo
+  if (remainingMs() == 0) {
+    return timeout();
+  }
+
+  char buffer[4096];
+  for (;;) {
+    ssize_t bytes_read = read(_pipe_fd, buffer, sizeof(buffer));
+    if (bytes_read > 0) {
+      if (_output.size() + bytes_read > CGI_MAX_OUTPUT) {
+        LOG_WARNING("CGI output exceeds " << CGI_MAX_OUTPUT << " bytes");
+        return kill(502);
+      }
+      _output.append(buffer, bytes_read);
+    } else if (bytes_read == 0) {
+      break;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      waitFor(_pipe_fd, IO_READ, _deadline_ms);
+      return TASK_WAITING;
+    } else if (errno != EINTR) {
+      LOG_ERROR("Error reading CGI output: " << strerror(errno));
+      break;
+    }
+  }
+
+  // El pidfd se abre antes de cerrar la tubería para que no reciba su número
+#ifdef SYS_pidfd_open
+  _pid_fd = syscall(SYS_pidfd_open, _pid, 0);
+#endif
+  close(_pipe_fd);
+  _pipe_fd = -1;
+  _state   = S_EXITING;
+  return reap();
+}
+
+/**
+ * @brief Kills a script that ran past its deadline; without a pidfd it is
+ *        also the poll that checks whether the child exited.
+ */
+TaskStatus CgiTask::timeout() {
+  if (_state == S_EXITING && _pid_fd == -1 && remainingMs() > 0) {
+    return reap();
+  }
+  LOG_WARNING("CGI Execution Timeout");
+  return kill(504);
+}
+
+/**
+ * @brief Collects the exit status and sends the response if the child is done.
+ */
+TaskStatus CgiTask::reap() {
+  int   status;
+  pid_t result = waitpid(_pid, &status, WNOHANG);
+
+  if (result == 0) {
+    if (_pid_fd != -1) {
+      waitFor(_pid_fd, IO_READ, _deadline_ms);
+    } else {
+      waitFor(-1, 0, std::min(_deadline_ms, Clock::monotonicMs() + CGI_REAP_POLL_MS));
+    }
+    return TASK_WAITING;
+  }
+  _pid = -1;
+
+  SocketResult sent;
+  if (result > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+    // El script se ejecutó correctamente
+    LOG_DEBUG("CGI Execution Success");
+    sent = HttpUtils::sendResponse(clientSocket(), "text/html", _output, 200, _keep_alive);
+  } else {
+    // Hubo un error en la ejecución del script
+    LOG_WARNING("CGI Execution Error");
+    sent = HttpUtils::sendErrorResponse(clientSocket(), 500, _keep_alive, _config);
+  }
+  return sent == SOCKET_OK ? TASK_DONE : TASK_FAILED;
+}
+
+/**
+ * @brief Kills the script and answers with an error instead of its output.
+ */
+TaskStatus CgiTask::kill(int status_code) {
+  ::kill(_pid, SIGKILL);
+  waitpid(_pid, NULL, 0);
+  _pid = -1;
+  _output.clear();
+  return HttpUtils::sendErrorResponse(clientSocket(), status_code, _keep_alive, _config) == SOCKET_OK
+             ? TASK_DONE
+             : TASK_FAILED;
+}
+
+unsigned int CgiTask::remainingMs() const {
+  unsigned long now_ms = Clock::monotonicMs();
+  return now_ms >= _deadline_ms ? 0 : static_cast<unsigned int>(_deadline_ms - now_ms);
+}
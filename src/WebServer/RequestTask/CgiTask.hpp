@@ -0,0 +1,51 @@
+#ifndef CGI_TASK_HPP
+#define CGI_TASK_HPP
+
+//------------------------------------------------------------------------------
+#include "CommonDefinitions.hpp"
+#include "WebServer/RequestTask/RequestTask.hpp"
+//------------------------------------------------------------------------------
+#include <sys/types.h>
+#include <string>
+
+// Maximum run time of a CGI script
+#define CGI_TIMEOUT_MS 5000
+// Maximum size of the output of a CGI script
+#define CGI_MAX_OUTPUT (4 * 1024 * 1024)
+
+// CgiTask: collects the output of a CGI script without blocking
+//
+// Reads the pipe on readiness until EOF, then waits for the child to exit
+// (on a pidfd when the kernel has them, polling with a short timer
+// otherwise) and answers 200 with the output, 500 if the script failed,
+// 502 if its output grew past CGI_MAX_OUTPUT or 504 if it ran past
+// CGI_TIMEOUT_MS; in the last two cases it is killed.
+class CgiTask : public RequestTask {
+ public:
+  CgiTask(int client_socket, pid_t pid, int pipe_fd, bool keep_alive, const LocationConfig &config);
+  ~CgiTask();
+
+  TaskStatus resume(unsigned int events);
+  TaskStatus timeout();
+
+ private:
+  enum State {
+    S_READING, // Leyendo la salida del script
+    S_EXITING  // Salida completa, esperando a que termine el proceso
+  };
+
+  State                 _state;
+  pid_t                 _pid;
+  int                   _pipe_fd;
+  int                   _pid_fd;
+  bool                  _keep_alive;
+  const LocationConfig &_config; // Compilada, vive tanto como la configuración
+  unsigned long         _deadline_ms;
+  std::string           _output;
+
+  TaskStatus   reap();
+  TaskStatus   kill(int status_code);
+  unsigned int remainingMs() const;
+};
+
+#endif // CGI_TASK_HPP
@@ -0,0 +1,46 @@
+#include "RequestTask.hpp"
+
+RequestTask::RequestTask(int client_socket)
+    : _client_socket(client_socket), _wait_fd(-1), _wait_events(0), _deadline_ms(0) {}
+
+RequestTask::~RequestTask() {}
+
+int RequestTask::clientSocket() const {
+  return _client_socket;
+}
+
+/**
+ * @brief The descriptor the task is waiting on, -1 to wait for the deadline only.
+ */
+int RequestTask::waitFd() const {
+  return _wait_fd;
+}
+
+/**
+ * @brief IoEventFlags awaited on waitFd().
+ */
+unsigned int RequestTask::waitEvents() const {
+  return _wait_events;
+}
+
+/**
+ * @brief Time at which timeout() is called, in Clock::monotonicMs() units.
+ */
+unsigned long RequestTask::deadlineMs() const {
+  return _deadline_ms;
+}
+
+/**
+ * @brief Sets what the task waits for before returning TASK_WAITING.
+ *
+ * @param fd Descriptor owned by the task, -1 for none. It has to stay open
+ *           until the task waits on another one or is deleted; the next
+ *           one is opened before closing it, so both never share a number.
+ * @param events IoEventFlags to wait for on fd.
+ * @param deadline_ms Absolute deadline, in Clock::monotonicMs() units.
+ */
+void RequestTask::waitFor(int fd, unsigned int events, unsigned long deadline_ms) {
+  _wait_fd     = fd;
+  _wait_events = events;
+  _deadline_ms = deadline_ms;
+}
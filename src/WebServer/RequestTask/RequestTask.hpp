@@ -0,0 +1,55 @@
+#ifndef REQUEST_TASK_HPP
+#define REQUEST_TASK_HPP
+
+//------------------------------------------------------------------------------
+#include <cstddef>
+
+// Outcome of RequestTask::resume and RequestTask::timeout
+enum TaskStatus {
+  TASK_DONE,    // Respuesta encolada en la conexión
+  TASK_WAITING, // Esperando a waitFd() o al plazo
+  TASK_FAILED   // La conexión tiene que cerrarse
+};
+
+// RequestTask: a request handler suspended on I/O
+//
+// A handler that would otherwise block (reading a CGI pipe, waiting for a
+// child to exit, a disk completion...) creates a task, hands it over with
+// HttpUtils::startTask and returns. The event loop then watches waitFd()
+// for waitEvents() and calls resume() on readiness, or timeout() once
+// deadlineMs() has passed without it; fd -1 waits for the deadline only.
+// The deadline is absolute: waiting again with the same one does not
+// extend it.
+//
+// The task queues its response on the connection output like any handler.
+// No further request is read from the connection while a task is pending,
+// so responses keep their order; the connection is only watched for the
+// client going away. The event loop deletes the task once it is done or
+// the connection is closed.
+class RequestTask {
+ public:
+  explicit RequestTask(int client_socket);
+  virtual ~RequestTask();
+
+  virtual TaskStatus resume(unsigned int events) = 0;
+  virtual TaskStatus timeout()                   = 0;
+
+  int          clientSocket() const;
+  int          waitFd() const;
+  unsigned int waitEvents() const;
+  unsigned long deadlineMs() const;
+
+ protected:
+  void waitFor(int fd, unsigned int events, unsigned long deadline_ms);
+
+ private:
+  int           _client_socket;
+  int           _wait_fd;
+  unsigned int  _wait_events;
+  unsigned long _deadline_ms;
+
+  RequestTask(const RequestTask &);
+  RequestTask &operator=(const RequestTask &);
+};
+
+#endif // REQUEST_TASK_HPP
@@ -0,0 +1,100 @@
+#include "ResponseCache.hpp"
+
+#include <algorithm>
+
+ResponseCache::ResponseCache() : _budget(0), _max_file(0), _memory(0) {}
+
+/**
+ * @brief Sets the memory budget and the largest file that is cached.
+ *
+ * @param budget Bytes of head and body kept in total; 0 disables the cache.
+ * @param max_file Largest body that is cached.
+ */
+void ResponseCache::configure(size_t budget, size_t max_file) {
+  clear();
+  _budget   = budget;
+  _max_file = budget > 0 ? std::min(max_file, budget) : 0;
+}
+
+/**
+ * @brief Whether a file of that size goes through the cache.
+ */
+bool ResponseCache::accepts(size_t file_size) const {
+  return _budget > 0 && file_size <= _max_file;
+}
+
+/**
+ * @brief Bytes currently held by the cache.
+ */
+size_t ResponseCache::memory() const {
+  return _memory;
+}
+
+/**
+ * @brief Finds the response of a file.
+ *
+ * @param generation Generation of the current OpenFileCache entry; a
+ *                   response built from an older one is dropped.
+ * @return The response, NULL on a miss. Valid until the next insert().
+ */
+const CachedResponse *ResponseCache::lookup(const std::string &path, int status, unsigned long generation) {
+  _probe.first.assign(path);
+  _probe.second = status;
+
+  EntryMap::iterator it = _entries.find(_probe);
+  if (it == _entries.end()) {
+    return NULL;
+  }
+  if (it->second->generation != generation) {
+    erase(it);
+    return NULL;
+  }
+  _lru.splice(_lru.begin(), _lru, it->second);
+  return &*it->second;
+}
+
+/**
+ * @brief Stores a response, evicting the least recently used ones to stay
+ *        within the budget.
+ *
+ * @return The stored response.
+ */
+const CachedResponse *ResponseCache::insert(const std::string &path,
+                                            int                status,
+                                            unsigned long      generation,
+                                            const std::string &head,
+                                            const std::string &body) {
+  std::pair<std::string, int> key(path, status);
+  EntryMap::iterator          it = _entries.find(key);
+  if (it != _entries.end()) {
+    erase(it);
+  }
+
+  size_t size = head.size() + body.size();
+  while (!_lru.empty() && _memory + size > _budget) {
+    erase(_entries.find(std::make_pair(_lru.back().path, _lru.back().status)));
+  }
+
+  _lru.push_front(CachedResponse());
+  CachedResponse &entry = _lru.front();
+  entry.path            = path;
+  entry.status          = status;
+  entry.generation      = generation;
+  entry.head            = head;
+  entry.body            = body;
+  _entries[key]         = _lru.begin();
+  _memory += size;
+  return &entry;
+}
+
+void ResponseCache::clear() {
+  _entries.clear();
+  _lru.clear();
+  _memory = 0;
+}
+
+void ResponseCache::erase(EntryMap::iterator it) {
+  _memory -= it->second->head.size() + it->second->body.size();
+  _lru.erase(it->second);
+  _entries.erase(it);
+}
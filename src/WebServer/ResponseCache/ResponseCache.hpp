@@ -0,0 +1,62 @@
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+// Serialized response of a small file
+struct CachedResponse {
+  std::string   path;       // Ruta resuelta del fichero
+  int           status;
+  unsigned long generation; // CachedFile::generation del que se construyó
+  std::string   head;       // Línea de estado y cabeceras, sin Date/Connection
+  std::string   body;
+};
+
+// ResponseCache: complete responses for small static files
+//
+// Holds the status line, the headers that do not change between requests
+// and the body of files up to max_file bytes, in LRU order within a memory
+// budget. A hit is sent with a single gathered write (sendmsg, as writev
+// cannot take MSG_NOSIGNAL), adding only the Date and Connection headers.
+//
+// Entries are tied to the OpenFileCache entry they were built from through
+// its generation: once the file is reloaded the old response is dropped.
+class ResponseCache {
+ public:
+  ResponseCache();
+
+  void   configure(size_t budget, size_t max_file);
+  bool   accepts(size_t file_size) const;
+  size_t memory() const;
+
+  const CachedResponse *lookup(const std::string &path, int status, unsigned long generation);
+  const CachedResponse *insert(const std::string &path,
+                               int                status,
+                               unsigned long      generation,
+                               const std::string &head,
+                               const std::string &body);
+  void                  clear();
+
+ private:
+  typedef std::list<CachedResponse>                               EntryList;
+  typedef std::map<std::pair<std::string, int>, EntryList::iterator> EntryMap;
+
+  EntryList                   _lru; // El más reciente al principio
+  EntryMap                    _entries;
+  std::pair<std::string, int> _probe; // Clave de lookup(); conserva su capacidad
+  size_t                      _budget;
+  size_t                      _max_file;
+  size_t                      _memory;
+
+  void erase(EntryMap::iterator it);
+
+  ResponseCache(const ResponseCache &);
+  ResponseCache &operator=(const ResponseCache &);
+};
+
+#endif // RESPONSE_CACHE_HPP
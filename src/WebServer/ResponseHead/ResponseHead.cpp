@@ -0,0 +1,139 @@
+#include "ResponseHead.hpp"
+
+#include "CommonDefinitions.hpp"
+#include "WebServer/Clock/Clock.hpp"
+
+#define RESPONSE_STATUS(code, reason) {code, "HTTP/1.1 " #code " " reason "\r\n", sizeof("HTTP/1.1 " #code " " reason "\r\n") - 1, reason}
+
+#define RESPONSE_FRAGMENT(literal) literal, sizeof(literal) - 1
+
+// Ordenada por código: se busca por bisección
+const ResponseHead::StatusLine ResponseHead::STATUS_LINES[] = {
+    RESPONSE_STATUS(200, "OK"),
+    RESPONSE_STATUS(201, "Created"),
+    RESPONSE_STATUS(204, "No Content"),
+    RESPONSE_STATUS(301, "Moved Permanently"),
+    RESPONSE_STATUS(302, "Found"),
+    RESPONSE_STATUS(303, "See Other"),
+    RESPONSE_STATUS(307, "Temporary Redirect"),
+    RESPONSE_STATUS(308, "Permanent Redirect"),
+    RESPONSE_STATUS(400, "Bad Request"),
+    RESPONSE_STATUS(403, "Forbidden"),
+    RESPONSE_STATUS(404, "Not Found"),
+    RESPONSE_STATUS(405, "Method Not Allowed"),
+    RESPONSE_STATUS(408, "Request Timeout"),
+    RESPONSE_STATUS(411, "Length Required"),
+    RESPONSE_STATUS(413, "Payload Too Large"),
+    RESPONSE_STATUS(414, "URI Too Long"),
+    RESPONSE_STATUS(415, "Unsupported Media Type"),
+    RESPONSE_STATUS(431, "Request Header Fields Too Large"),
+    RESPONSE_STATUS(500, "Internal Server Error"),
+    RESPONSE_STATUS(501, "Not Implemented"),
+    RESPONSE_STATUS(502, "Bad Gateway"),
+    RESPONSE_STATUS(503, "Service Unavailable"),
+    RESPONSE_STATUS(504, "Gateway Timeout"),
+    RESPONSE_STATUS(505, "HTTP Version Not Supported"),
+};
+
+const size_t ResponseHead::STATUS_COUNT = sizeof(STATUS_LINES) / sizeof(STATUS_LINES[0]);
+
+ResponseHead::ResponseHead(std::string &out) : _out(out) {}
+
+/**
+ * @brief Appends the status line; codes without an entry in the table get
+ *        "Unknown Status" as their reason.
+ */
+void ResponseHead::status(int code) {
+  const StatusLine *status = find(code);
+  if (status != NULL) {
+    _out.append(status->line, status->length);
+    return;
+  }
+  _out.append(RESPONSE_FRAGMENT("HTTP/1.1 "));
+  appendNumber(code < 0 ? 0 : code);
+  _out.append(RESPONSE_FRAGMENT(" Unknown Status\r\n"));
+}
+
+/**
+ * @brief Appends "name: value\r\n".
+ */
+void ResponseHead::header(const char *name, const std::string &value) {
+  header(name, value.data(), value.size());
+}
+
+void ResponseHead::header(const char *name, const char *value, size_t length) {
+  _out.append(name);
+  _out.append(RESPONSE_FRAGMENT(": "));
+  _out.append(value, length);
+  _out.append(RESPONSE_FRAGMENT("\r\n"));
+}
+
+void ResponseHead::contentLength(size_t length) {
+  _out.append(RESPONSE_FRAGMENT("Content-Length: "));
+  appendNumber(length);
+  _out.append(RESPONSE_FRAGMENT("\r\n"));
+}
+
+void ResponseHead::server() {
+  _out.append(RESPONSE_FRAGMENT("Server: AJX Server/" AJXWEBSERVER_VERSION "\r\n"));
+}
+
+/**
+ * @brief Appends the Date header of the current second, from the Clock.
+ */
+void ResponseHead::date() {
+  _out.append(Clock::dateHeader());
+}
+
+void ResponseHead::connection(bool keep_alive) {
+  if (keep_alive) {
+    _out.append(RESPONSE_FRAGMENT("Connection: keep-alive\r\n"));
+  } else {
+    _out.append(RESPONSE_FRAGMENT("Connection: close\r\n"));
+  }
+}
+
+/**
+ * @brief Appends the empty line that ends the head.
+ */
+void ResponseHead::end() {
+  _out.append(RESPONSE_FRAGMENT("\r\n"));
+}
+
+/**
+ * @brief The reason phrase of a status code.
+ */
+const char *ResponseHead::reason(int code) {
+  const StatusLine *status = find(code);
+  return status != NULL ? status->reason : "Unknown Status";
+}
+
+const ResponseHead::StatusLine *ResponseHead::find(int code) {
+  size_t low  = 0;
+  size_t high = STATUS_COUNT;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (STATUS_LINES[mid].code == code) {
+      return &STATUS_LINES[mid];
+    }
+    if (STATUS_LINES[mid].code < code) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Appends a number in decimal without going through a stream.
+ */
+void ResponseHead::appendNumber(size_t number) {
+  char   digits[24];
+  size_t pos = sizeof(digits);
+  do {
+    digits[--pos] = static_cast<char>('0' + number % 10);
+    number /= 10;
+  } while (number > 0);
+  _out.append(digits + pos, sizeof(digits) - pos);
+}
@@ -0,0 +1,50 @@
+#ifndef RESPONSE_HEAD_HPP
+#define RESPONSE_HEAD_HPP
+
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+
+// ResponseHead: serializer of the status line and headers of a response
+//
+// Writes into a string owned by the caller, normally the head buffer of the
+// connection (OutputQueue::headBuffer), which keeps its capacity from one
+// response to the next. Status lines come from a table of literals built at
+// compile time and the fixed headers are static fragments, so a head costs
+// a few appends and, once the buffer has grown, no allocation.
+//
+// The head is sent together with the body by a gathered write; the body is
+// never copied behind it.
+class ResponseHead {
+ public:
+  explicit ResponseHead(std::string &out);
+
+  void status(int code);
+  void header(const char *name, const std::string &value);
+  void header(const char *name, const char *value, size_t length);
+  void contentLength(size_t length);
+  void server();
+  void date();
+  void connection(bool keep_alive);
+  void end();
+
+  static const char *reason(int code);
+
+ private:
+  struct StatusLine {
+    int         code;
+    const char *line; // "HTTP/1.1 <code> <reason>\r\n"
+    size_t      length;
+    const char *reason;
+  };
+
+  static const StatusLine STATUS_LINES[];
+  static const size_t     STATUS_COUNT;
+
+  std::string &_out;
+
+  static const StatusLine *find(int code);
+  void                     appendNumber(size_t number);
+};
+
+#endif // RESPONSE_HEAD_HPP
@@ -0,0 +1,190 @@
+#include "TimerWheel.hpp"
+
+#include <time.h>
+
+TimerWheel::TimerWheel(unsigned int tick_ms) : _tick_ms(tick_ms ? tick_ms : 1), _size(0) {
+  _current_tick = nowMs() / _tick_ms;
+  for (int i = 0; i < LEVEL0_SIZE; ++i) {
+    _level0[i].prev = _level0[i].next = &_level0[i];
+  }
+  for (int level = 0; level < UPPER_LEVELS; ++level) {
+    for (int i = 0; i < LEVELN_SIZE; ++i) {
+      _levels[level][i].prev = _levels[level][i].next = &_levels[level][i];
+    }
+  }
+}
+
+/**
+ * @brief Milliseconds from a monotonic clock, immune to wall clock changes.
+ */
+unsigned long TimerWheel::nowMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<unsigned long>(ts.tv_sec) * 1000UL + ts.tv_nsec / 1000000;
+}
+
+void TimerWheel::push(TimerNode &head, TimerNode &node) {
+  node.prev       = head.prev;
+  node.next       = &head;
+  head.prev->next = &node;
+  head.prev       = &node;
+}
+
+void TimerWheel::unlink(TimerNode &node) {
+  node.prev->next = node.next;
+  node.next->prev = node.prev;
+  node.prev       = NULL;
+  node.next       = NULL;
+}
+
+/**
+ * @brief Puts a node in the bucket that matches its distance to the current tick.
+ */
+void TimerWheel::link(TimerNode &node) {
+  if (node.expires <= _current_tick) {
+    push(_level0[_current_tick & LEVEL0_MASK], node);
+    return;
+  }
+  unsigned long delta = node.expires - _current_tick;
+  if (delta < LEVEL0_SIZE) {
+    push(_level0[node.expires & LEVEL0_MASK], node);
+  } else if (delta < (1UL << (LEVEL0_BITS + LEVELN_BITS))) {
+    push(_levels[0][(node.expires >> LEVEL0_BITS) & LEVELN_MASK], node);
+  } else {
+    unsigned long max_delta = (1UL << (LEVEL0_BITS + 2 * LEVELN_BITS)) - 1;
+    if (delta > max_delta) {
+      node.expires = _current_tick + max_delta;
+    }
+    push(_levels[1][(node.expires >> (LEVEL0_BITS + LEVELN_BITS)) & LEVELN_MASK], node);
+  }
+}
+
+/**
+ * @brief Re-distributes the timers of an upper level bucket into lower levels.
+ */
+void TimerWheel::cascade(int level, unsigned int index) {
+  TimerNode &head = _levels[level][index];
+  while (head.next != &head) {
+    TimerNode *node = head.next;
+    unlink(*node);
+    link(*node);
+  }
+}
+
+/**
+ * @brief Arms (or re-arms) a timer.
+ *
+ * @param node The timer, cancelled first if it is already armed.
+ * @param now_ms Current time from nowMs().
+ * @param delay_ms Delay until expiry, rounded up to the tick.
+ * @param kind Caller defined tag, returned untouched on expiry.
+ */
+void TimerWheel::schedule(TimerNode &node, unsigned long now_ms, unsigned int delay_ms, int kind) {
+  if (node.isLinked()) {
+    cancel(node);
+  }
+  node.expires = (now_ms + delay_ms + _tick_ms - 1) / _tick_ms;
+  if (node.expires <= _current_tick) {
+    node.expires = _current_tick + 1;
+  }
+  node.kind = kind;
+  link(node);
+  ++_size;
+}
+
+/**
+ * @brief Arms a timer for an absolute deadline.
+ *
+ * A timer already armed for the same tick and kind is left alone, so a
+ * deadline can be re-applied on every wait without pushing it back.
+ *
+ * @param node The timer.
+ * @param deadline_ms Expiry time, in the units of nowMs().
+ * @param kind Caller defined tag, returned untouched on expiry.
+ */
+void TimerWheel::scheduleAt(TimerNode &node, unsigned long deadline_ms, int kind) {
+  unsigned long expires = (deadline_ms + _tick_ms - 1) / _tick_ms;
+  if (expires <= _current_tick) {
+    expires = _current_tick + 1;
+  }
+  if (node.isLinked() && node.kind == kind && node.expires == expires) {
+    return;
+  }
+  if (node.isLinked()) {
+    cancel(node);
+  }
+  node.expires = expires;
+  node.kind    = kind;
+  link(node);
+  ++_size;
+}
+
+void TimerWheel::cancel(TimerNode &node) {
+  if (!node.isLinked()) {
+    return;
+  }
+  unlink(node);
+  node.kind = TIMER_NONE;
+  --_size;
+}
+
+/**
+ * @brief Advances the wheel up to now_ms and collects the expired timers.
+ *
+ * Expired nodes are unlinked but keep their kind so the caller can tell
+ * which deadline fired.
+ *
+ * @param now_ms Current time from nowMs().
+ * @param expired Output vector; expired timers are appended to it.
+ */
+void TimerWheel::expire(unsigned long now_ms, std::vector<TimerNode *> &expired) {
+  unsigned long target = now_ms / _tick_ms;
+
+  while (_current_tick < target) {
+    if (_size == 0) {
+      _current_tick = target;
+      break;
+    }
+    ++_current_tick;
+    unsigned int index = _current_tick & LEVEL0_MASK;
+    if (index == 0) {
+      unsigned int index1 = (_current_tick >> LEVEL0_BITS) & LEVELN_MASK;
+      if (index1 == 0) {
+        cascade(1, (_current_tick >> (LEVEL0_BITS + LEVELN_BITS)) & LEVELN_MASK);
+      }
+      cascade(0, index1);
+    }
+    TimerNode &head = _level0[index];
+    while (head.next != &head) {
+      TimerNode *node = head.next;
+      unlink(*node);
+      --_size;
+      expired.push_back(node);
+    }
+  }
+}
+
+/**
+ * @brief Time until the wheel has to be advanced again.
+ *
+ * Returns the delay to the next non-empty level 0 bucket, or to the next
+ * cascade if level 0 is empty, so it is suitable as an event loop timeout.
+ *
+ * @param now_ms Current time from nowMs().
+ * @return Milliseconds to wait, or -1 if no timer is armed.
+ */
+int TimerWheel::nextTimeout(unsigned long now_ms) const {
+  if (_size == 0) {
+    return -1;
+  }
+  unsigned long tick = _current_tick + 1;
+  while ((tick & LEVEL0_MASK) != 0 && _level0[tick & LEVEL0_MASK].next == &_level0[tick & LEVEL0_MASK]) {
+    ++tick;
+  }
+  unsigned long when = tick * _tick_ms;
+  return when <= now_ms ? 0 : static_cast<int>(when - now_ms);
+}
+
+size_t TimerWheel::size() const {
+  return _size;
+}
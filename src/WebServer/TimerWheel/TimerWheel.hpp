@@ -0,0 +1,61 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+//------------------------------------------------------------------------------
+#include "CommonDefinitions.hpp"
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+// TimerWheel: hierarchical timing wheel for connection deadlines
+//
+// Three levels of buckets (256 x tick, 64 x 256 ticks, 64 x 16384 ticks)
+// cover about 29 days with the default 100 ms tick. Deadlines further away
+// are clamped to the last bucket. Arming, re-arming and cancelling are O(1);
+// expire() only touches the buckets whose tick has passed, plus a cascade
+// every 256 ticks, so its cost depends on the expired timers and not on the
+// number of connections.
+//
+// Timers are TimerNode objects embedded in their owner, which must cancel
+// them before it is destroyed or reused.
+class TimerWheel {
+ public:
+  explicit TimerWheel(unsigned int tick_ms = 100);
+
+  void   schedule(TimerNode &node, unsigned long now_ms, unsigned int delay_ms, int kind);
+  void   scheduleAt(TimerNode &node, unsigned long deadline_ms, int kind);
+  void   cancel(TimerNode &node);
+  void   expire(unsigned long now_ms, std::vector<TimerNode *> &expired);
+  int    nextTimeout(unsigned long now_ms) const;
+  size_t size() const;
+
+  static unsigned long nowMs();
+
+ private:
+  enum {
+    LEVEL0_BITS  = 8,
+    LEVELN_BITS  = 6,
+    LEVEL0_SIZE  = 1 << LEVEL0_BITS,
+    LEVELN_SIZE  = 1 << LEVELN_BITS,
+    LEVEL0_MASK  = LEVEL0_SIZE - 1,
+    LEVELN_MASK  = LEVELN_SIZE - 1,
+    UPPER_LEVELS = 2
+  };
+
+  unsigned int  _tick_ms;
+  unsigned long _current_tick;
+  size_t        _size;
+  TimerNode     _level0[LEVEL0_SIZE];
+  TimerNode     _levels[UPPER_LEVELS][LEVELN_SIZE];
+
+  void link(TimerNode &node);
+  void cascade(int level, unsigned int index);
+
+  static void push(TimerNode &head, TimerNode &node);
+  static void unlink(TimerNode &node);
+
+  TimerWheel(const TimerWheel &);
+  TimerWheel &operator=(const TimerWheel &);
+};
+
+#endif // TIMER_WHEEL_HPP
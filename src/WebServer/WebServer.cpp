@@ -12,17 +12,40 @@
 
 #include "WebServer.hpp"
 #include "Logger/includes/Logger.hpp"
+#include "WebServer/HttpUtils/HttpUtils.hpp"
 #include "WebServer/RequestHandler/RequestHandler.hpp"
 
+// Salida pendiente a partir de la cual no se atienden más peticiones encadenadas
+#define PIPELINE_MAX_PENDING (256 * 1024)
+// Conexiones aceptadas por socket de escucha en cada vuelta del bucle
+#define ACCEPT_BUDGET 64
+// Conexiones admitidas por vuelta mientras el bucle va con retraso
+#define ADMISSION_LAGGING_BATCH 4
+
 volatile sig_atomic_t g_shutdownRequested = 0;
+volatile sig_atomic_t g_reopenLogs        = 0;
 
 extern "C" void signalHandler(int signum) {
   if (signum == SIGINT || signum == SIGTERM) {
     g_shutdownRequested = 1;
+  } else if (signum == SIGUSR1) {
+    g_reopenLogs = 1;
   }
 }
 
-WebServer::WebServer(ConfigurationManager &config) : config(config), next_client_id(1), active_connections(0) {
+WebServer::WebServer(ConfigurationManager &config)
+    : config(config),
+      request_arena(buffer_pool),
+      connections(buffer_pool),
+      next_client_id(1),
+      event_loop(NULL),
+      now_ms(Clock::monotonicMs()),
+      worker_id(-1),
+      max_clients(config.get_max_clients()),
+      keep_alive_timeout_ms(config.get_keep_alive_timeout() * 1000),
+      header_timeout_ms(config.get_client_header_timeout() * 1000),
+      body_timeout_ms(config.get_client_body_timeout() * 1000) {
+  admission.configure(config.get_admission_target(), config.get_admission_interval(), max_clients);
   request_handler = new RequestHandler(config);
   if (request_handler == NULL) {
     LOG_ERROR("Failed to create RequestHandler");
@@ -34,6 +57,7 @@ WebServer::~WebServer() {
   LOG_DEBUG("Shutting down WebServer");
 
   delete request_handler;
+  delete event_loop;
 
   for (size_t i = 0; i < server_fds.size(); ++i) {
     if (server_fds[i] != -1) {
@@ -43,7 +67,7 @@ WebServer::~WebServer() {
   }
 }
 
-void WebServer::addPort(int port, const char *ip) {
+void WebServer::addPort(int port, const char *ip, const ListenOptions &options) {
   std::ostringstream logMsg;
   logMsg << "Adding port " << port << " with IP " << ip;
   LOG_INFO(logMsg.str());
@@ -61,6 +85,8 @@ void WebServer::addPort(int port, const char *ip) {
   ports.push_back(port);
   server_fds.push_back(-1);
   addresses.push_back(addr);
+  listen_options.push_back(options);
+  accept_pending.push_back(false);
 }
 
 void WebServer::run() {
@@ -70,49 +96,69 @@ void WebServer::run() {
   sa.sa_flags = 0;
   sigaction(SIGINT, &sa, NULL);
   sigaction(SIGTERM, &sa, NULL);
+  sigaction(SIGUSR1, &sa, NULL);
+
+  if (config.get_workers() > 1) {
+    runMaster(config.get_workers());
+  } else {
+    runWorker();
+  }
+}
 
+/**
+ * @brief Runs the event loop of one worker until shutdown.
+ *
+ * @return false if the listening sockets could not be opened.
+ */
+bool WebServer::runWorker() {
   const int MAX_RESTART_ATTEMPTS = 10;
+  // Cota superior de la espera: una señal que llega justo antes de wait()
+  // no interrumpe la llamada, así que no se bloquea indefinidamente
+  const int WAIT_TIMEOUT_MS      = 1000;
   int       restartAttempts      = 0;
   bool      shouldRestart        = false;
   bool      shouldShutdown       = false;
 
+  // Después del fork: cada worker tiene su propia caché y su descriptor inotify
+  HttpUtils::getFileCache().configure(config.get_open_file_cache(), config.get_open_file_cache_valid() * 1000);
+  HttpUtils::getResponseCache().configure(config.get_response_cache(), config.get_response_cache_max_file());
+  // y su hilo de escritura del log
+  if (config.get_log_async()) {
+    Logger::getInstance().startAsync(config.get_log_buffer(), config.get_log_overflow() == "block");
+  }
+  openAccessLog();
+
   do {
     shouldRestart  = false;
     shouldShutdown = false;
 
     if (!initializeSockets()) {
       LOG_DEBUG("Failed to initialize sockets");
+      cleanupConnections();
+      return false;
+    }
+    if (!initializeEventLoop()) {
+      LOG_CRITICAL("Failed to initialize the event loop");
       break;
     }
 
-    fd_set master_set, read_fds, write_fds;
-    int    max_fd = initializeFdSets(master_set);
-
-    struct timeval timeout;
-    timeout.tv_sec  = 5;
-    timeout.tv_usec = 0;
-
     while (!g_shutdownRequested && !shouldRestart && !shouldShutdown) {
-      int selectResult = handleSelect(master_set, read_fds, write_fds, max_fd, timeout);
-
-      switch (selectResult) {
-        case 0: // SELECT_OK
-          handleNewConnections(master_set, read_fds, max_fd);
-          handleExistingConnections(master_set);
-          break;
-        case 1: // SELECT_TIMEOUT
-          // No necesita hacer nada, ya se manejan las conexiones inactivas en handleSelect
+      switch (handleEvents(WAIT_TIMEOUT_MS)) {
+        case LOOP_OK:
+        case LOOP_TIMEOUT:
           break;
-        case 2: // SELECT_ERROR
+        case LOOP_ERROR:
           cleanupConnectionsRestart();
           restartAttempts++;
           shouldRestart = true;
           break;
-        case 3: // SELECT_SHUTDOWN
+        case LOOP_SHUTDOWN:
           shouldShutdown = true;
           break;
       }
     }
+    // Fuera del bucle cada lectura del reloj vuelve a ser la hora actual
+    Clock::release();
 
     if (shouldRestart) {
       // Espera un poco antes de reiniciar
@@ -127,6 +173,9 @@ void WebServer::run() {
   }
 
   cleanupConnections();
+  access_log.close();
+  Logger::getInstance().stopAsync();
+  return true;
 }
 
 bool WebServer::initializeSockets() {
@@ -137,6 +186,12 @@ bool WebServer::initializeSockets() {
     if (setsockopt(server_fds[i], SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
       LOG_ERROR("setsockopt(SO_REUSEADDR) failed for port " << ports[i]);
     }
+#ifdef SO_REUSEPORT
+    // Cada worker tiene su propio socket; el kernel reparte los accept entre ellos
+    if (worker_id >= 0 && setsockopt(server_fds[i], SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+      LOG_ERROR("setsockopt(SO_REUSEPORT) failed for port " << ports[i]);
+    }
+#endif
     sockets_open++;
     sockets_open += bind_socket(i);
     if (server_fds[i] != -1) {
@@ -151,217 +206,705 @@ bool WebServer::initializeSockets() {
   return true;
 }
 
-int WebServer::initializeFdSets(fd_set &master_set) {
-  int max_fd = -1;
-  FD_ZERO(&master_set);
+/**
+ * @brief Creates the event loop backend and registers the listening sockets.
+ *
+ * @return true if every listening socket could be registered.
+ */
+bool WebServer::initializeEventLoop() {
+  delete event_loop;
+  event_loop = EventLoop::create(config.get_event_engine());
+  LOG_INFO("Using " << event_loop->name() << " event engine");
+
   for (size_t i = 0; i < server_fds.size(); ++i) {
-    FD_SET(server_fds[i], &master_set);
-    if (server_fds[i] > max_fd) {
-      max_fd = server_fds[i];
+    if (server_fds[i] == -1) {
+      continue;
     }
+    if (!event_loop->addListener(server_fds[i])) {
+      return false;
+    }
+  }
+  int watch_fd = HttpUtils::getFileCache().watchFd();
+  if (watch_fd != -1 && !event_loop->add(watch_fd, IO_READ)) {
+    return false;
   }
-  return max_fd;
+  return true;
 }
 
-int WebServer::handleSelect(fd_set &master_set, fd_set &read_fds, fd_set &write_fds, int max_fd, struct timeval &timeout) {
-    read_fds = master_set;
-    FD_ZERO(&write_fds);
+/**
+ * @brief Runs one iteration of the event loop.
+ *
+ * Waits for readiness and dispatches every ready descriptor either to the
+ * open file cache (inotify), to the suspended request waiting on it or to
+ * its client connection. Listening sockets are accepted from last, at most
+ * ACCEPT_BUDGET connections each; a queue left with connections makes the
+ * next iteration poll without waiting. Accepted connections go through the
+ * AdmissionQueue, which is served once the iteration is done so its delay
+ * includes the time the loop took. The wait ends
+ * early when the next connection deadline is due, and expired deadlines are
+ * processed after the events.
+ *
+ * @param max_timeout_ms Upper bound for the wait.
+ * @return LoopResult describing the outcome of the iteration.
+ */
+int WebServer::handleEvents(int max_timeout_ms) {
+  int timeout_ms = timers.nextTimeout(now_ms);
+  if (timeout_ms < 0 || timeout_ms > max_timeout_ms) {
+    timeout_ms = max_timeout_ms;
+  }
+  // Próxima decisión de la cola de admisión
+  int admission_ms = admission.nextTimeout(now_ms);
+  if (admission_ms >= 0 && admission_ms < timeout_ms) {
+    timeout_ms = admission_ms;
+  }
+  // Entrega del access log por tiempo
+  int access_ms = access_log.nextTimeout(now_ms);
+  if (access_ms >= 0 && access_ms < timeout_ms) {
+    timeout_ms = access_ms;
+  }
+  // Quedan conexiones por aceptar de la vuelta anterior: no se espera
+  if (std::find(accept_pending.begin(), accept_pending.end(), true) != accept_pending.end()) {
+    timeout_ms = 0;
+  }
+  Clock::release();
+  int count = event_loop->wait(ready_events, timeout_ms);
+  // Una lectura del reloj por vuelta: la comparten plazos, fechas y logs
+  Clock::hold();
+  now_ms = Clock::monotonicMs();
+
+  if (g_reopenLogs) {
+    g_reopenLogs = 0;
+    LOG_INFO("Reopening the access log");
+    access_log.reopen();
+  }
+  if (count < 0) {
+    if (g_shutdownRequested) {
+      std::cout << "\033[2J\033[1;1H"; // Borrar la pantalla
+      LOG_SUCCESS("Received exit signal, shutting down gracefully");
+      return LOOP_SHUTDOWN;
+    }
+    if (errno == EINTR) {
+      return LOOP_TIMEOUT;
+    }
+    LOG_ERROR("Event loop wait failed: " << strerror(errno));
+    return LOOP_ERROR;
+  }
+
+  int watch_fd = HttpUtils::getFileCache().watchFd();
+  for (std::vector<IoEvent>::const_iterator it = ready_events.begin(); it != ready_events.end(); ++it) {
+    int listener = findListener(it->fd);
+    if (it->fd == watch_fd) {
+      HttpUtils::getFileCache().processEvents();
+    } else if (task_fds.count(it->fd)) {
+      resumeTask(it->fd, it->events);
+    } else if (listener >= 0) {
+      accept_pending[listener] = true;
+    } else {
+      handleExistingConnections(*it);
+    }
+  }
+  // Las conexiones nuevas se aceptan después de atender a las existentes
+  for (size_t i = 0; i < accept_pending.size(); ++i) {
+    if (accept_pending[i]) {
+      accept_pending[i] = !handleNewConnections(i);
+    }
+  }
 
-    for (std::vector<ClientInfo>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (it->waiting_to_write || HttpUtils::hasFileState(it->socket)) {
-            FD_SET(it->socket, &write_fds);
+  expireTimers();
+  admitConnections();
+  access_log.tick(now_ms);
+  return count == 0 ? LOOP_TIMEOUT : LOOP_OK;
+}
+
+int WebServer::findListener(int fd) const {
+  for (size_t i = 0; i < server_fds.size(); ++i) {
+    if (server_fds[i] == fd) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Accepts the pending connections on a listening socket, up to
+ *        ACCEPT_BUDGET, and queues them for admission.
+ *
+ * The sockets come already non-blocking and close-on-exec. The client
+ * address is only looked up when the access log needs it. The event loop
+ * may be edge-triggered, so a queue that is not drained has to be visited
+ * again without waiting for a new notification.
+ *
+ * @param i Index of the listening socket in server_fds.
+ * @return true if the accept queue was drained.
+ */
+bool WebServer::handleNewConnections(size_t i) {
+  for (int accepted = 0; accepted < ACCEPT_BUDGET; ++accepted) {
+    sockaddr_in client_addr;
+    std::memset(&client_addr, 0, sizeof(client_addr));
+    int new_socket = event_loop->accept(server_fds[i], access_log.enabled() ? &client_addr : NULL);
+
+    if (new_socket < 0) {
+      if (errno == EINTR) {
+        --accepted;
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        LOG_ERROR("Error accepting connection on port " << ports[i] << ": " << strerror(errno));
+      }
+      return true;
+    }
+
+    // Cola llena: se rechaza la conexión que más tiempo lleva esperando
+    AdmissionQueue::Pending oldest;
+    if (admission.full() && admission.pop(oldest)) {
+      rejectConnection(oldest, "admission queue full");
+    }
+    admission.push(new_socket, ports[i], client_addr.sin_addr.s_addr, now_ms);
+  }
+  return false;
+}
+
+/**
+ * @brief Registers the queued connections the worker has room for and
+ *        sheds the ones that waited too long.
+ *
+ * There is room while fewer than max_clients connections are open; when
+ * the loop is lagging only ADMISSION_LAGGING_BATCH connections are added
+ * per iteration, so the queueing delay grows and the AdmissionQueue sheds
+ * the excess.
+ */
+void WebServer::admitConnections() {
+  unsigned long now      = TimerWheel::nowMs();
+  size_t        admitted = 0;
+
+  admission.recordLag(now - now_ms);
+  for (;;) {
+    bool can_admit = getActiveConnections() < static_cast<size_t>(max_clients) &&
+                     (!admission.lagging() || admitted < ADMISSION_LAGGING_BATCH);
+    AdmissionQueue::Pending pending;
+    AdmissionDecision       decision = admission.next(now, can_admit, pending);
+    if (decision == ADMISSION_WAIT) {
+      return;
+    }
+    if (decision == ADMISSION_DROP) {
+      rejectConnection(pending, "queueing delay above target");
+    } else if (registerConnection(pending)) {
+      ++admitted;
+    }
+  }
+}
+
+/**
+ * @brief Starts serving an accepted connection.
+ *
+ * @return false if it could not be watched and was closed.
+ */
+bool WebServer::registerConnection(const AdmissionQueue::Pending &pending) {
+  int new_socket = pending.fd;
+
+  // Verificar si ya existe una conexión para este socket
+  if (connections.find(new_socket) != NULL) {
+    LOG_WARNING("Attempted to accept a connection on an existing socket: " << new_socket);
+    close(new_socket);
+    return false;
+  }
+
+  configureClientSocket(new_socket);
+  if (!event_loop->addConnection(new_socket, IO_READ)) {
+    LOG_WARNING("Could not watch socket " << new_socket << ", closing it");
+    close(new_socket);
+    return false;
+  }
+  LOG_SUCCESS("New connection accepted on socket: " << new_socket << ", on port " << pending.port
+                                                   << ", client ID: " << next_client_id);
+  ClientInfo *client = connections.insert(new_socket, next_client_id++, pending.port);
+  client->interest   = IO_READ;
+  client->access.remote_addr = pending.addr;
+  HttpUtils::attachOutput(new_socket, &client->output);
+  armTimer(*client, TIMER_HEADER);
+  LOG_INFO("Active connections: " << getActiveConnections());
+  return true;
+}
+
+/**
+ * @brief Answers a queued connection with 503 and closes it.
+ */
+void WebServer::rejectConnection(const AdmissionQueue::Pending &pending, const char *reason) {
+  LOG_WARNING("Server overloaded (" << reason << "). Rejecting connection queued for "
+                                    << Clock::monotonicMs() - pending.queued_ms
+                                    << " ms. Active connections: " << getActiveConnections());
+  send(pending.fd, SERVER_BUSY_RESPONSE, strlen(SERVER_BUSY_RESPONSE), MSG_DONTWAIT | MSG_NOSIGNAL);
+  close(pending.fd);
+}
+
+/**
+ * @brief Handles readiness on a client connection.
+ *
+ * Reading stops while a request is suspended (RequestTask) or while too
+ * much output is pending; in the latter case it resumes once the queue
+ * has been drained on write readiness.
+ *
+ * @param event The readiness reported by the event loop.
+ */
+void WebServer::handleExistingConnections(const IoEvent &event) {
+    ClientInfo *client = connections.find(event.fd);
+    if (client == NULL) {
+        LOG_WARNING("Event for unknown socket " << event.fd);
+        event_loop->remove(event.fd);
+        return;
+    }
+
+    bool should_close = false;
+
+    if ((event.events & IO_READ) && client->task != NULL) {
+        // Con una tarea pendiente no se leen peticiones: solo se comprueba
+        // que el cliente siga ahí, para no esperar a una respuesta que nadie leerá
+        should_close = (event.events & IO_ERROR) || clientGone(*client);
+        if (should_close) {
+            LOG_INFO("Client ID " << client->id << " went away during a pending request");
+            client->output.setStatus(499);
+            finishAccess(*client);
         }
+    } else if (event.events & IO_READ) {
+        LOG_DEBUG("Activity on socket " << client->socket << " (read), client ID: " << client->id);
+        should_close = !readRequests(*client);
     }
 
-    struct timeval tmp_timeout = timeout;
-    int            activity    = select(max_fd + 1, &read_fds, &write_fds, NULL, &tmp_timeout);
+    if ((event.events & IO_WRITE) && !should_close) {
+        LOG_DEBUG("Activity on socket " << client->socket << " (write), client ID: " << client->id);
 
-    if (activity < 0) {
-        if (g_shutdownRequested) {
-            std::cout << "\033[2J\033[1;1H"; // Borrar la pantalla
-            LOG_SUCCESS("Received exit signal, shutting down gracefully");
-            return 3;
+        if (!client->output.empty() && !flushOutput(*client)) {
+            should_close = true;
+        } else if (client->read_paused && client->output.pending() < PIPELINE_MAX_PENDING) {
+            should_close = !readRequests(*client);
         }
-        return 2;
-    } else if (activity == 0) {
-        //LOG_INFO("Tiempo de espera de select agotado - realizando tareas periódicas");
-        checkIdleConnections();
-        return 1;
     }
 
-    // Actualizar el estado de lectura/escritura de cada cliente
-    for (std::vector<ClientInfo>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        it->ready_for_read  = FD_ISSET(it->socket, &read_fds);
-        it->ready_for_write = FD_ISSET(it->socket, &write_fds);
+    if (should_close) {
+        closeClient(*client);
+        LOG_INFO("Active connections: " << getActiveConnections());
+    } else {
+        updateInterest(*client);
     }
+}
 
-    return 0;
+/**
+ * @brief Checks, without consuming anything, whether the client closed its
+ *        side of the connection or the connection failed.
+ *
+ * Bytes of a pipelined request waiting in the socket mean the client is
+ * still there.
+ */
+bool WebServer::clientGone(ClientInfo &client) {
+  char    byte;
+  ssize_t peeked;
+  do {
+    peeked = recv(client.socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+  } while (peeked < 0 && errno == EINTR);
+  if (peeked == 0) {
+    return true;
+  }
+  return peeked < 0 && errno != EAGAIN && errno != EWOULDBLOCK;
 }
 
-void WebServer::handleNewConnections(fd_set &master_set, const fd_set &read_fds, int &max_fd) {
-  for (size_t i = 0; i < server_fds.size(); ++i) {
-    if (FD_ISSET(server_fds[i], &read_fds)) {
-      sockaddr_in client_addr;
-      socklen_t   addrlen    = sizeof(client_addr);
-      int         new_socket = accept(server_fds[i], (struct sockaddr *)&client_addr, &addrlen);
+/**
+ * @brief Reads from a connection until the socket would block and answers
+ *        every complete request.
+ *
+ * Requests pipelined behind the current one stay in the buffer and are
+ * answered in order; all the responses produced by one call are sent with
+ * a single flush of the connection output.
+ *
+ * @param client The connection to read from.
+ * @return false if the connection has to be closed.
+ */
+bool WebServer::readRequests(ClientInfo &client) {
+  do {
+    size_t handled = 0;
 
-      if (new_socket < 0) {
-        LOG_ERROR("Error accepting connection on port " << ports[i]);
-        continue;
-      }
+    client.read_paused = false;
+    // Peticiones que quedaron en el buffer mientras la conexión estaba parada
+    if (!processRequests(client, handled)) {
+      return false;
+    }
+    while (client.task == NULL && !client.read_paused) {
+      // Se recibe en los bloques del buffer de la conexión
+      ssize_t bytes_read = event_loop->receive(client.socket, client.input);
 
-      if (getActiveConnections() >= config.get_max_clients()) {
-        LOG_WARNING("Server overloaded. Rejecting new connection. Active connections: " << getActiveConnections());
-        send(new_socket, SERVER_BUSY_RESPONSE, strlen(SERVER_BUSY_RESPONSE), MSG_DONTWAIT | MSG_NOSIGNAL);
-        close(new_socket);
-        continue;
+      if (bytes_read > 0) {
+        if (!processRequests(client, handled)) {
+          return false;
+        }
+      } else if (bytes_read == 0) {
+        LOG_SUCCESS("Client closed connection for client ID: " << client.id);
+        return false;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      } else if (errno != EINTR) {
+        LOG_ERROR("Error reading from socket for client ID: " << client.id);
+        return false;
       }
+    }
+    if ((handled > 0 || !client.output.empty()) && !flushOutput(client)) {
+      return false;
+    }
+    // Si el socket se lo ha llevado todo no habrá aviso de escritura
+  } while (client.read_paused && client.output.pending() < PIPELINE_MAX_PENDING);
+  return true;
+}
 
-      // Verificar si ya existe una conexión para este socket
-      bool socket_exists = false;
-      for (std::vector<ClientInfo>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (it->socket == new_socket) {
-          socket_exists = true;
-          break;
-        }
+/**
+ * @brief Answers the complete requests at the front of the connection buffer.
+ *
+ * Each response is queued behind the previous ones and the request is
+ * removed from the buffer, so the bytes after it are scanned as the next
+ * request. Stops at an incomplete request, at a request that suspends
+ * itself, or when the pending output reaches PIPELINE_MAX_PENDING.
+ *
+ * @param client The connection.
+ * @param handled Incremented for every request answered.
+ * @return false if the connection has to be closed.
+ */
+bool WebServer::processRequests(ClientInfo &client, size_t &handled) {
+  while (client.task == NULL) {
+    if (client.output.pending() >= PIPELINE_MAX_PENDING) {
+      // Se sigue leyendo cuando el cliente haya recibido lo pendiente
+      client.read_paused = true;
+      return true;
+    }
+
+    if (access_log.enabled() && client.access.start_us == 0 && !client.input.empty()) {
+      // Primer byte de la petición: la latencia se cuenta desde aquí
+      client.access.start_us = AccessLog::nowUs();
+      client.output.setStatus(0);
+    }
+
+    // Solo se examinan los bytes nuevos
+    HttpScanner::Result scan = client.scanner.consume(client.input);
+    if (scan != HttpScanner::SCAN_ERROR && client.scanner.headComplete() && !receiveBody(client)) {
+      return false;
+    }
+    if (scan == HttpScanner::SCAN_INCOMPLETE || scan == HttpScanner::SCAN_HEAD_DONE) {
+      if (!client.input.empty()) {
+        updateReadTimer(client);
       }
+      return true;
+    }
 
-      if (!socket_exists) {
-        LOG_SUCCESS("New connection accepted on socket: " << new_socket << ", on port " << ports[i]
-                                                       << ", client ID: " << next_client_id);
-        configureClientSocket(new_socket);
-        FD_SET(new_socket, &master_set);
-        if (new_socket > max_fd) {
-          max_fd = new_socket;
-        }
-        clients.push_back(ClientInfo(new_socket, next_client_id++, ports[i]));
-        update_last_activity(new_socket);
-        incrementActiveConnections();
-        LOG_INFO("Active connections: " << getActiveConnections());
-        usleep(1); 
-      } else {
-        LOG_WARNING("Attempted to accept a connection on an existing socket: " << new_socket);
-        close(new_socket);
+    ++handled;
+    size_t       bytes_before = client.output.total();
+    SocketResult result;
+    // Con otra petición detrás la respuesta espera al flush de readRequests
+    if (client.input.size() > client.scanner.requestEnd()) {
+      client.output.cork();
+    }
+    {
+      // Lo que el parser y el handler asignan se libera de golpe al salir
+      RequestArena::Scope scope(request_arena);
+      result = request_handler->handle_request(client.socket,
+                                               client.input,
+                                               client.scanner,
+                                               client.body,
+                                               client.upload,
+                                               client.port,
+                                               client.id);
+    }
+    client.output.uncork();
+    recordAccess(client, bytes_before);
+
+    if (result == SOCKET_ERROR) {
+      LOG_ERROR("Error handling request for client ID: " << client.id);
+    }
+    if (result == SOCKET_CLOSED || result == SOCKET_ERROR || scan == HttpScanner::SCAN_ERROR) {
+      // La conexión se cierra (tras un error no se sabe dónde empieza la
+      // siguiente petición): se envía lo que el socket admita ahora
+      finishAccess(client);
+      client.output.flush(client.socket);
+      return false;
+    }
+
+    // Lo que sigue a la petición es el comienzo de la siguiente; los bloques
+    // que ya solo tenían esta petición vuelven al pool
+    client.input.consume(client.scanner.requestEnd());
+    client.scanner.reset();
+    client.body.clear();
+    client.body_checked = false;
+    endUpload(client);
+
+    RequestTask *task = HttpUtils::takeTask(client.socket);
+    if (task != NULL) {
+      return beginTask(client, task);
+    }
+    finishAccess(client);
+    armTimer(client, TIMER_KEEPALIVE);
+  }
+  return true;
+}
+
+/**
+ * @brief Moves the body received so far out of the connection buffer.
+ *
+ * The de-framed body goes to the connection's RequestBody and the buffer
+ * keeps only the header, so it never grows with the upload. The body limit
+ * of the location is resolved once, when the header is complete, and a
+ * body that exceeds it is refused with 413 without reading the rest.
+ *
+ * @param client A connection whose request header is complete.
+ * @return false if the connection has to be closed.
+ */
+bool WebServer::receiveBody(ClientInfo &client) {
+  HttpScanner &scanner = client.scanner;
+
+  if (!client.body_checked) {
+    client.body_checked = true;
+    client.body_limit   = static_cast<size_t>(-1);
+    if (scanner.isChunked() || scanner.contentLength() > 0) {
+      RequestArena::Scope scope(request_arena);
+      client.body_limit = request_handler->prepare_body(client.input, scanner, client.port, client.upload);
+    }
+  }
+  if (scanner.contentLength() > client.body_limit || scanner.bodyLength() > client.body_limit) {
+    size_t bytes_before = client.output.total();
+    {
+      RequestArena::Scope scope(request_arena);
+      request_handler->reject_body(client.socket, client.input, scanner, client.port);
+    }
+    recordAccess(client, bytes_before);
+    finishAccess(client);
+    // La conexión se cierra: se envía lo que el socket admita ahora
+    client.output.flush(client.socket);
+    return false;
+  }
+
+  const std::vector<HttpScanner::Span> &spans = scanner.bodySpans();
+  for (std::vector<HttpScanner::Span>::const_iterator it = spans.begin(); it != spans.end(); ++it) {
+    // Un tramo puede ocupar varios bloques del buffer
+    for (size_t done = 0; done < it->length;) {
+      size_t      length = it->length - done;
+      const char *data   = client.input.contiguous(it->offset + done, length);
+      if (client.upload != NULL) {
+        // Un error del parser se responde cuando el cuerpo esté completo
+        client.upload->feed(data, length);
+      } else if (!client.body.append(data, length)) {
+        return false;
       }
+      done += length;
     }
   }
+  scanner.discardBody(client.input);
+  return true;
 }
 
+/**
+ * @brief Sends as much of the queued output as the socket takes.
+ *
+ * Arms the send deadline while output is pending and the keep-alive one
+ * once everything has been sent and no request is partially received.
+ *
+ * @param client The connection to flush.
+ * @return false if the connection has to be closed.
+ */
+bool WebServer::flushOutput(ClientInfo &client) {
+  SocketResult result = client.output.flush(client.socket);
+  if (result == SOCKET_OK) {
+    client.waiting_to_write = false;
+    // Con una tarea pendiente el plazo es el suyo, y con una petición a
+    // medias el de su lectura
+    if (client.task == NULL && client.input.empty()) {
+      armTimer(client, TIMER_KEEPALIVE);
+    }
+    return true;
+  }
+  if (result == SOCKET_WOULD_BLOCK) {
+    // Continuará cuando el socket vuelva a admitir escritura
+    client.waiting_to_write = true;
+    if (client.task == NULL) {
+      armTimer(client, TIMER_SEND);
+    }
+    return true;
+  }
+  LOG_ERROR("Error sending response on socket " << client.socket);
+  return false;
+}
 
-void WebServer::handleExistingConnections(fd_set &master_set) {
-    time_t current_time = time(NULL);
+/**
+ * @brief Suspends a connection on a request that waits for I/O.
+ *
+ * @param client The connection that started the task.
+ * @param task Task returned by HttpUtils::takeTask; owned by the connection.
+ * @return false if the connection has to be closed.
+ */
+bool WebServer::beginTask(ClientInfo &client, RequestTask *task) {
+  LOG_DEBUG("Request suspended on socket " << client.socket << ", client ID: " << client.id);
+  client.task = task;
+  if (client.access.start_us != 0) {
+    client.access.task_start_us = AccessLog::nowUs();
+  }
+  if (!applyTaskWait(client)) {
+    endTask(client);
+    return false;
+  }
+  return true;
+}
 
-    for (std::vector<ClientInfo>::iterator it = clients.begin(); it != clients.end();) {
-        int client_socket = it->socket;
-        int server_port   = it->port;
+/**
+ * @brief Resumes the task waiting on a descriptor that became ready.
+ */
+void WebServer::resumeTask(int task_fd, unsigned int events) {
+  // Si la conexión ya se cerró y su socket se reutilizó, la generación no
+  // coincide y la tarea no llega al cliente nuevo
+  ClientInfo *client = connections.get(task_fds[task_fd]);
+  if (client == NULL || client->task == NULL) {
+    task_fds.erase(task_fd);
+    event_loop->remove(task_fd);
+    return;
+  }
+  handleTaskStatus(*client, client->task->resume(events));
+}
 
-        bool should_close = false;
+/**
+ * @brief Acts on what a task returned.
+ *
+ * A finished task releases the connection: its response is flushed and the
+ * requests that arrived meanwhile are read. The socket may be
+ * edge-triggered, so they are read now instead of waiting for new data.
+ *
+ * The ClientInfo must not be used after this call.
+ */
+void WebServer::handleTaskStatus(ClientInfo &client, TaskStatus status) {
+  if (status == TASK_WAITING && applyTaskWait(client)) {
+    return;
+  }
+  endTask(client);
+  finishAccess(client);
+  if (status != TASK_DONE || !flushOutput(client)) {
+    closeClient(client);
+    LOG_INFO("Active connections: " << getActiveConnections());
+    return;
+  }
+  IoEvent event;
+  event.fd     = client.socket;
+  event.events = IO_READ;
+  handleExistingConnections(event);
+}
 
-        // Comprobar si la conexión ha estado inactiva por demasiado tiempo
-        if (difftime(current_time, it->last_activity) > config.get_keep_alive_timeout()) {
-            LOG_INFO("Connection idle for too long on socket " << client_socket << ", client ID: " << it->id);
-            should_close = true;
-        }
+/**
+ * @brief Registers what the task of a connection waits for.
+ *
+ * The event loop is only touched when the descriptor changes, and the
+ * timer only when the deadline does: waking up does not extend it.
+ *
+ * @return false if the descriptor could not be watched.
+ */
+bool WebServer::applyTaskWait(ClientInfo &client) {
+  RequestTask *task = client.task;
+  if (task->waitFd() != client.task_fd) {
+    if (client.task_fd != -1) {
+      event_loop->remove(client.task_fd);
+      task_fds.erase(client.task_fd);
+    }
+    client.task_fd = task->waitFd();
+    if (client.task_fd != -1) {
+      if (!event_loop->add(client.task_fd, task->waitEvents())) {
+        LOG_ERROR("Could not watch descriptor " << client.task_fd << " for client ID: " << client.id);
+        client.task_fd = -1;
+        return false;
+      }
+      task_fds[client.task_fd] = connections.ref(client);
+    }
+  }
+  timers.scheduleAt(client.timer, task->deadlineMs(), TIMER_TASK);
+  return true;
+}
 
-        if (it->ready_for_read) {
-            LOG_DEBUG("Activity on socket " << client_socket << " (read), client ID: " << it->id);
-
-            char    buffer[4096];
-            ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer), MSG_DONTWAIT);
-
-            if (bytes_read > 0) {
-                it->partial_request.append(buffer, bytes_read);
-                it->bytes_received += bytes_read;
-                it->last_activity = current_time;
-
-                if (!it->request_complete && request_handler->isRequestComplete(*it)) {
-                    it->request_complete = true;
-                }
-
-                if (it->request_complete) {
-                    SocketResult result = request_handler->handle_request(client_socket,
-                                                                          it->partial_request.c_str(),
-                                                                          it->partial_request.size(),
-                                                                          server_port,
-                                                                          it->id,
-                                                                          &it->bytes_received);
-
-                    if (result == SOCKET_CLOSED) {
-                        should_close = true;
-                    } else if (result == SOCKET_ERROR) {
-                        LOG_ERROR("Error handling request for client ID: " << it->id);
-                        should_close = true;
-                    } else {
-                        // Reiniciar para la próxima solicitud
-                        it->partial_request.clear();
-                        it->request_complete = false;
-                        it->content_length   = 0;
-                        it->bytes_received   = 0;
-                    }
-                }
-            } else if (bytes_read == 0) {
-                LOG_SUCCESS("Client closed connection for client ID: " << it->id);
-                should_close = true;
-            } else if (bytes_read < 0) {
-                LOG_ERROR("Error reading from socket for client ID: " << it->id);
-                should_close = true;
-            }
-        }
+/**
+ * @brief Unregisters and deletes the task of a connection.
+ */
+void WebServer::endTask(ClientInfo &client) {
+  if (client.task_fd != -1) {
+    event_loop->remove(client.task_fd);
+    task_fds.erase(client.task_fd);
+    client.task_fd = -1;
+  }
+  timers.cancel(client.timer);
+  delete client.task;
+  client.task = NULL;
+}
 
-        if (it->ready_for_write && !should_close) {
-            LOG_DEBUG("Activity on socket " << client_socket << " (write), client ID: " << it->id);
-
-            if (HttpUtils::hasFileState(client_socket)) {
-                SocketResult result = HttpUtils::sendChunkedFileNonBlocking(client_socket, true, LocationConfig());
-                if (result == SOCKET_OK) {
-                    // Transferencia completa
-                    it->waiting_to_write = false;
-                } else if (result == SOCKET_WOULD_BLOCK) {
-                    // Continuará en la próxima iteración
-                    it->waiting_to_write = true;
-                } else {
-                    // Error, cerrar conexión
-                    LOG_ERROR("Error sending file on socket " << client_socket);
-                    should_close = true;
-                }
-            }
-        }
+/**
+ * @brief Deletes the parser of an upload; an unfinished file part is removed.
+ */
+void WebServer::endUpload(ClientInfo &client) {
+  delete client.upload;
+  client.upload = NULL;
+}
 
-        if (should_close) {
-            LOG_DEBUG("Closing connection for client ID: " << it->id);
-            FD_CLR(client_socket, &master_set);
-            close(client_socket);
-            HttpUtils::removeFileState(client_socket);
-            it = clients.erase(it);
-            decrementActiveConnections();
-            LOG_INFO("Active connections: " << getActiveConnections());
-        } else {
-            ++it;
-        }
-    }
+/**
+ * @brief Unregisters and closes a client connection and frees its slot.
+ *
+ * The ClientInfo must not be used after this call.
+ *
+ * @param client The connection to close.
+ */
+void WebServer::closeClient(ClientInfo &client) {
+  LOG_DEBUG("Closing connection for client ID: " << client.id);
+  if (client.task != NULL) {
+    endTask(client);
+  }
+  endUpload(client);
+  timers.cancel(client.timer);
+  event_loop->remove(client.socket);
+  close(client.socket);
+  HttpUtils::detachOutput(client.socket);
+  connections.erase(client.socket);
+}
+
+/**
+ * @brief Asks for write readiness only while output is pending.
+ *
+ * The event loop is only touched when the interest set actually changes.
+ *
+ * @param client The connection to update.
+ */
+void WebServer::updateInterest(ClientInfo &client) {
+  unsigned int wanted = IO_READ;
+  if (!client.output.empty()) {
+    wanted |= IO_WRITE;
+  }
+  if (wanted != client.interest && event_loop->modify(client.socket, wanted)) {
+    client.interest = wanted;
+  }
 }
 
 void WebServer::cleanupConnections() {
   std::cout << std::endl;
   LOG_INFO("Received exit signal, shutting down gracefully");
 
-  for (std::vector<ClientInfo>::const_iterator it = clients.begin(); it != clients.end(); ++it) {
-    if (it->socket != -1) {
-      close(it->socket);
-      LOG_DEBUG("Closed client socket: " << it->socket << ", ID: " << it->id);
+  for (size_t slot = 0; slot < connections.capacity(); ++slot) {
+    ClientInfo *client = connections.at(slot);
+    if (client != NULL) {
+      if (client->task != NULL) {
+        endTask(*client);
+      }
+      endUpload(*client);
+      close(client->socket);
+      HttpUtils::detachOutput(client->socket);
+      LOG_DEBUG("Closed client socket: " << client->socket << ", ID: " << client->id);
     }
   }
-  clients.clear();
+  connections.clear();
+  closeQueuedConnections();
   for (size_t i = 0; i < server_fds.size(); ++i) {
     if (server_fds[i] != -1) {
       close(server_fds[i]);
       LOG_DEBUG("Closed server socket on port: " << ports[i]);
       server_fds[i] = -1;
     }
+    accept_pending[i] = false;
   }
 
-  last_activity_map.clear();
-  client_to_server_port.clear();
+  delete event_loop;
+  event_loop = NULL;
 
   LOG_SUCCESS("🧹 All cleaned up 🧹 . See you next time! 👋");
 }
@@ -369,23 +912,41 @@ void WebServer::cleanupConnections() {
 void WebServer::cleanupConnectionsRestart() {
   std::cout << std::endl;
 
-  for (std::vector<ClientInfo>::const_iterator it = clients.begin(); it != clients.end(); ++it) {
-    if (it->socket != -1) {
-      close(it->socket);
-      LOG_DEBUG("Closed client socket: " << it->socket << ", ID: " << it->id);
+  for (size_t slot = 0; slot < connections.capacity(); ++slot) {
+    ClientInfo *client = connections.at(slot);
+    if (client != NULL) {
+      if (client->task != NULL) {
+        endTask(*client);
+      }
+      endUpload(*client);
+      close(client->socket);
+      HttpUtils::detachOutput(client->socket);
+      LOG_DEBUG("Closed client socket: " << client->socket << ", ID: " << client->id);
     }
   }
-  clients.clear();
+  connections.clear();
+  closeQueuedConnections();
   for (size_t i = 0; i < server_fds.size(); ++i) {
     if (server_fds[i] != -1) {
       close(server_fds[i]);
       LOG_DEBUG("Closed server socket on port: " << ports[i]);
       server_fds[i] = -1;
     }
+    accept_pending[i] = false;
   }
 
-  last_activity_map.clear();
-  client_to_server_port.clear();
+  delete event_loop;
+  event_loop = NULL;
+}
+
+/**
+ * @brief Closes the connections still waiting for admission.
+ */
+void WebServer::closeQueuedConnections() {
+  AdmissionQueue::Pending pending;
+  while (admission.pop(pending)) {
+    close(pending.fd);
+  }
 }
 
 void WebServer::configureClientSocket(int client_socket) {
@@ -428,73 +989,122 @@ int WebServer::bind_socket(int index) {
   }
 }
 
+/**
+ * @brief Applies the listen options and starts listening.
+ *
+ * The buffer sizes are set on the listening socket so accepted sockets
+ * inherit them; SO_RCVBUF has to be known before the handshake to pick the
+ * window scale.
+ */
 void WebServer::listen_socket(int index) {
-  if (listen(server_fds[index], 10) < 0) {
+  const ListenOptions &options = listen_options[index];
+  int                  fd      = server_fds[index];
+
+  if (options.rcvbuf > 0 && setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &options.rcvbuf, sizeof(options.rcvbuf)) < 0) {
+    LOG_ERROR("setsockopt(SO_RCVBUF) failed for port " << ports[index] << ": " << strerror(errno));
+  }
+  if (options.sndbuf > 0 && setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &options.sndbuf, sizeof(options.sndbuf)) < 0) {
+    LOG_ERROR("setsockopt(SO_SNDBUF) failed for port " << ports[index] << ": " << strerror(errno));
+  }
+#ifdef TCP_DEFER_ACCEPT
+  // accept solo devuelve la conexión cuando han llegado datos
+  if (options.defer_accept > 0 &&
+      setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &options.defer_accept, sizeof(options.defer_accept)) < 0) {
+    LOG_ERROR("setsockopt(TCP_DEFER_ACCEPT) failed for port " << ports[index] << ": " << strerror(errno));
+  }
+#endif
+#ifdef TCP_FASTOPEN
+  if (options.fastopen > 0 &&
+      setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &options.fastopen, sizeof(options.fastopen)) < 0) {
+    LOG_ERROR("setsockopt(TCP_FASTOPEN) failed for port " << ports[index] << ": " << strerror(errno));
+  }
+#endif
+  if (listen(fd, options.backlog) < 0) {
     throw std::runtime_error("Failed to listen on socket");
   }
+  // El bucle de eventos vacía la cola de accept hasta EAGAIN
+  if (fcntl(server_fds[index], F_SETFL, fcntl(server_fds[index], F_GETFL, 0) | O_NONBLOCK) < 0) {
+    LOG_ERROR("Failed to set listening socket non-blocking on port " << ports[index]);
+  }
 }
 
-void WebServer::update_last_activity(int client_socket) {
-  last_activity_map[client_socket] = time(NULL);
+size_t WebServer::getActiveConnections() const {
+  return connections.size();
 }
 
-time_t WebServer::get_last_activity(int client_socket) {
-  std::map<int, time_t>::iterator it = last_activity_map.find(client_socket);
-  if (it != last_activity_map.end()) {
-    return it->second;
+const char WebServer::SERVER_BUSY_RESPONSE[] =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 21\r\n\r\nServer is "
+    "overloaded.";
+
+/**
+ * @brief Arms the deadline of a connection for its current phase.
+ *
+ * TIMER_SEND uses the keep-alive timeout and is re-armed on every write, so
+ * only a stalled transfer is closed.
+ *
+ * @param client The connection.
+ * @param kind One of TIMER_KEEPALIVE, TIMER_HEADER, TIMER_BODY or TIMER_SEND.
+ */
+void WebServer::armTimer(ClientInfo &client, int kind) {
+  unsigned int delay_ms = keep_alive_timeout_ms;
+  if (kind == TIMER_HEADER) {
+    delay_ms = header_timeout_ms;
+  } else if (kind == TIMER_BODY) {
+    delay_ms = body_timeout_ms;
   }
-  return 0;
+  timers.schedule(client.timer, now_ms, delay_ms, kind);
 }
 
-void WebServer::check_idle_connections(fd_set &master_set) {
-  time_t current_time       = time(NULL);
-  int    keep_alive_timeout = config.get_keep_alive_timeout();
-
-  std::vector<ClientInfo>::iterator it = clients.begin();
-  while (it != clients.end()) {
-    int    client_socket = it->socket;
-    time_t last_activity = get_last_activity(client_socket);
-    if (current_time - last_activity > keep_alive_timeout) {
-      LOG_INFO("Closing idle connection on socket " << client_socket << ", client ID: " << it->id);
-      FD_CLR(client_socket, &master_set);
-      close(client_socket);
-      last_activity_map.erase(client_socket);
-      it = clients.erase(it);
-      decrementActiveConnections();
-      LOG_INFO("Idle connection closed. Active connections: " << getActiveConnections());
-    } else {
-      ++it;
+/**
+ * @brief Moves the deadline along while a request is being received.
+ *
+ * The header deadline covers the whole header and is not extended by new
+ * data; the body deadline is the maximum time between two reads.
+ *
+ * @param client The connection that just received data.
+ */
+void WebServer::updateReadTimer(ClientInfo &client) {
+  if (client.timer.kind == TIMER_KEEPALIVE || client.timer.kind == TIMER_SEND) {
+    armTimer(client, TIMER_HEADER);
+  }
+  if (client.timer.kind == TIMER_HEADER) {
+    if (client.scanner.headComplete()) {
+      armTimer(client, TIMER_BODY);
     }
+  } else if (client.timer.kind == TIMER_BODY) {
+    armTimer(client, TIMER_BODY);
   }
 }
 
-void WebServer::incrementActiveConnections() {
-  ++active_connections;
-}
-
-void WebServer::decrementActiveConnections() {
-  --active_connections;
-}
-
-int WebServer::getActiveConnections() const {
-  return active_connections;
-}
-
-const char WebServer::SERVER_BUSY_RESPONSE[] =
-    "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 21\r\n\r\nServer is "
-    "overloaded.";
-
-void WebServer::checkIdleConnections() {
-    time_t current_time = time(NULL);
-    std::vector<ClientInfo>::iterator it = clients.begin();
-    while (it != clients.end()) {
-        if (difftime(current_time, it->last_activity) > config.get_keep_alive_timeout()) {
-            LOG_INFO("Closing idle connection on socket " << it->socket << ", client ID: " << it->id);
-            close(it->socket);
-            it = clients.erase(it);
-            decrementActiveConnections();
-        } else {
-            ++it;
-        }
+/**
+ * @brief Closes every connection whose deadline has passed, or lets its
+ *        suspended request handle the timeout.
+ *
+ * Only the expired timers are visited, never the whole connection table.
+ */
+void WebServer::expireTimers() {
+  expired_timers.clear();
+  timers.expire(now_ms, expired_timers);
+  for (size_t i = 0; i < expired_timers.size(); ++i) {
+    ClientInfo *client = static_cast<ClientInfo *>(expired_timers[i]->owner);
+    if (expired_timers[i]->kind == TIMER_TASK && client->task != NULL) {
+      handleTaskStatus(*client, client->task->timeout());
+      continue;
+    }
+    switch (expired_timers[i]->kind) {
+      case TIMER_HEADER:
+        LOG_INFO("Timed out reading headers on socket " << client->socket << ", client ID: " << client->id);
+        break;
+      case TIMER_BODY:
+        LOG_INFO("Timed out reading body on socket " << client->socket << ", client ID: " << client->id);
+        break;
+      case TIMER_SEND:
+        LOG_INFO("Timed out sending response on socket " << client->socket << ", client ID: " << client->id);
+        break;
+      default:
+        LOG_INFO("Closing idle connection on socket " << client->socket << ", client ID: " << client->id);
+        break;
     }
-}
\ No newline at end of file
+    closeClient(*client);
+  }
+}
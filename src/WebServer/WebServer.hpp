@@ -15,14 +15,24 @@
 
 // -----------------------------------------------------------------------------
 #include "ConfigFileParse/ConfigurationManager.hpp"
+#include "WebServer/AccessLog/AccessLog.hpp"
+#include "WebServer/AdmissionQueue/AdmissionQueue.hpp"
+#include "WebServer/Clock/Clock.hpp"
+#include "WebServer/ConnectionTable/ConnectionTable.hpp"
+#include "WebServer/RequestArena/RequestArena.hpp"
+#include "WebServer/EventLoop/EventLoop.hpp"
+#include "WebServer/RequestTask/RequestTask.hpp"
+#include "WebServer/TimerWheel/TimerWheel.hpp"
 // -----------------------------------------------------------------------------
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <string.h>
-#include <sys/select.h>
 #include <unistd.h>
 #include <algorithm>
 #include <cstring>
@@ -33,6 +43,14 @@
 
 class RequestHandler;
 
+// Result of one event loop iteration (see WebServer::handleEvents)
+enum LoopResult {
+  LOOP_OK,
+  LOOP_TIMEOUT,
+  LOOP_ERROR,
+  LOOP_SHUTDOWN
+};
+
 class WebServer {
   // -----------CONSTRUCTOR AND DESTRUCTOR--------------------------------
  public:
@@ -41,7 +59,7 @@ class WebServer {
 
   // -----------PUBLIC METHODS----------------------------------------------
  public:
-  void addPort(int port, const char *ip = "0.0.0.0");
+  void addPort(int port, const char *ip = "0.0.0.0", const ListenOptions &options = ListenOptions());
   void run();
   void cleanup();
   bool isShutdownRequested() const;
@@ -49,33 +67,46 @@ class WebServer {
 
   // ----------------------ATTRIBUTES------------------------------------------
  private:
-  std::vector<int>         ports;
-  std::vector<int>         server_fds;
-  std::vector<sockaddr_in> addresses;
-  RequestHandler          *request_handler;
-  std::map<int, time_t>    last_activity_map;
-  ConfigurationManager    &config;
-  std::map<int, int>       client_to_server_port;
-  std::vector<ClientInfo>  clients;
-  int                      next_client_id;
-  int                      active_connections;
-  
+  typedef std::map<int, ConnectionRef> TaskMap;
 
- private:
+  std::vector<int>           ports;
+  std::vector<int>           server_fds;
+  std::vector<sockaddr_in>   addresses;
+  std::vector<ListenOptions> listen_options;
+  std::vector<bool>          accept_pending; // Cola de accept sin vaciar
+  RequestHandler            *request_handler;
+  ConfigurationManager      &config;
+  BufferPool                 buffer_pool;
+  RequestArena               request_arena; // Memoria de la petición en curso
+  ConnectionTable            connections;
+  AdmissionQueue             admission;
+  int                        next_client_id;
+  EventLoop                 *event_loop;
+  std::vector<IoEvent>       ready_events;
+  TimerWheel                 timers;
+  std::vector<TimerNode *>   expired_timers;
+  unsigned long              now_ms;
+  int                        worker_id;
+  int                        max_clients;
+  unsigned int               keep_alive_timeout_ms;
+  unsigned int               header_timeout_ms;
+  unsigned int               body_timeout_ms;
+  std::vector<pid_t>         worker_pids;
+  TaskMap                    task_fds; // Descriptor de una tarea -> su conexión
+  AccessLog                  access_log;
+
+  bool   runWorker();
+  void   runMaster(int workers);
+  pid_t  spawnWorker(int id);
+  bool   respawnWorkers(std::vector<time_t> &started);
+  void   stopWorkers();
+  void   signalWorkers(int signum);
   bool   initializeSockets();
-  int    handleSelect(fd_set         &master_set,
-                      fd_set         &read_fds,
-                      fd_set         &write_fds,
-                      int             max_fd,
-                      struct timeval &timeout);
-  int    initializeFdSets(fd_set &master_set);
+  bool   initializeEventLoop();
+  int    handleEvents(int max_timeout_ms);
+  int    findListener(int fd) const;
   int    create_socket(int index);
-  int    get_client_server_port(int client_socket);
-  int    accept_connection(int index);
-  int    getActiveConnections() const;
-  time_t get_last_activity(int client_socket);
-  void   check_idle_connections(fd_set &master_set);
-  void   add_client_server_port(int client_socket, int server_port);
+  size_t getActiveConnections() const;
   void   logServerConfig(const Server &server, size_t server_num) const;
   void   logErrorPages(const std::map<int, std::string> &error_pages,
                        int                               spaces) const;
@@ -84,19 +115,36 @@ class WebServer {
                           const std::string              &delimiter) const;
   void logCgiExtensions(const std::map<std::string, std::string> &cgiExtensions,
                         int                                       spaces) const;
-  void handleNewConnections(fd_set       &master_set,
-                            const fd_set &read_fds,
-                            int          &max_fd);
-  void handleExistingConnections(fd_set &master_set);
+  bool handleNewConnections(size_t listener_index);
+  void admitConnections();
+  bool registerConnection(const AdmissionQueue::Pending &pending);
+  void rejectConnection(const AdmissionQueue::Pending &pending, const char *reason);
+  void closeQueuedConnections();
+  void handleExistingConnections(const IoEvent &event);
+  bool readRequests(ClientInfo &client);
+  bool clientGone(ClientInfo &client);
+  bool processRequests(ClientInfo &client, size_t &handled);
+  bool receiveBody(ClientInfo &client);
+  bool flushOutput(ClientInfo &client);
+  bool beginTask(ClientInfo &client, RequestTask *task);
+  void resumeTask(int task_fd, unsigned int events);
+  void handleTaskStatus(ClientInfo &client, TaskStatus status);
+  bool applyTaskWait(ClientInfo &client);
+  void endTask(ClientInfo &client);
+  void endUpload(ClientInfo &client);
+  void closeClient(ClientInfo &client);
+  void updateInterest(ClientInfo &client);
   int bind_socket(int index);
   void listen_socket(int index);
-  void update_last_activity(int client_socket);
   void cleanupConnections();
   void cleanupConnectionsRestart();
   void configureClientSocket(int client_socket);
-  void incrementActiveConnections();
-  void decrementActiveConnections();
-  void checkIdleConnections();
+  void armTimer(ClientInfo &client, int kind);
+  void updateReadTimer(ClientInfo &client);
+  void expireTimers();
+  void openAccessLog();
+  void recordAccess(ClientInfo &client, size_t bytes_before);
+  void finishAccess(ClientInfo &client);
   static const char SERVER_BUSY_RESPONSE[];
 
   std::map<int, std::pair<std::string, size_t> > pending_files;
@@ -0,0 +1,78 @@
+#include "WebServer.hpp"
+#include "Logger/includes/Logger.hpp"
+
+// Copia un tramo reutilizando la memoria del string
+static void copySpan(std::string &out, const InputBuffer &buffer, const HttpScanner::Span &span) {
+  out.resize(span.length);
+  if (span.length > 0) {
+    buffer.copy(span.offset, span.length, &out[0]);
+  }
+}
+
+/**
+ * @brief Opens the access log of this worker as configured (`access_log`).
+ */
+void WebServer::openAccessLog() {
+  std::string path = config.get_access_log();
+  if (path.empty()) {
+    return;
+  }
+  AccessLog::Format format =
+      config.get_access_log_format() == "json" ? AccessLog::FORMAT_JSON : AccessLog::FORMAT_COMBINED;
+  if (access_log.open(path, format, config.get_access_log_buffer(), config.get_access_log_flush(),
+                      config.get_access_log_rotate_size())) {
+    LOG_INFO("Access log: " << path);
+  }
+}
+
+/**
+ * @brief Copies what the access log needs from the request at the front of
+ *        the connection buffer, before the buffer drops it.
+ *
+ * @param bytes_before OutputQueue::total() before the response was queued.
+ */
+void WebServer::recordAccess(ClientInfo &client, size_t bytes_before) {
+  if (client.access.start_us == 0) {
+    return;
+  }
+  AccessEntry       &entry   = client.access;
+  const HttpScanner &scanner = client.scanner;
+
+  entry.bytes_before = bytes_before;
+  copySpan(entry.method, client.input, scanner.method());
+  copySpan(entry.uri, client.input, scanner.uri());
+  copySpan(entry.version, client.input, scanner.version());
+  entry.referer.clear();
+  entry.user_agent.clear();
+
+  const std::vector<HttpScanner::Header> &headers = scanner.headers();
+  for (std::vector<HttpScanner::Header>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+    if (HttpScanner::equalsIgnoreCase(client.input, it->name, "Referer")) {
+      copySpan(entry.referer, client.input, it->value);
+    } else if (HttpScanner::equalsIgnoreCase(client.input, it->name, "User-Agent")) {
+      copySpan(entry.user_agent, client.input, it->value);
+    }
+  }
+}
+
+/**
+ * @brief Writes the access log line of a request whose response has been
+ *        queued, and gets the connection ready for the next one.
+ */
+void WebServer::finishAccess(ClientInfo &client) {
+  AccessEntry &entry = client.access;
+  if (entry.start_us == 0) {
+    return;
+  }
+  unsigned long now_us = AccessLog::nowUs();
+  if (entry.task_start_us != 0) {
+    entry.upstream_us = now_us - entry.task_start_us;
+  }
+  entry.status     = client.output.status();
+  entry.bytes_sent = client.output.total() - entry.bytes_before;
+  entry.request_us = now_us - entry.start_us;
+  access_log.write(entry, now_ms);
+
+  entry.start_us      = 0;
+  entry.task_start_us = 0;
+}
@@ -0,0 +1,154 @@
+#include "WebServer.hpp"
+#include "Logger/includes/Logger.hpp"
+
+#include <cstdlib>
+
+extern volatile sig_atomic_t g_shutdownRequested;
+extern volatile sig_atomic_t g_reopenLogs;
+
+/**
+ * @brief Supervises `workers` worker processes until shutdown.
+ *
+ * Every worker opens its own SO_REUSEPORT listening sockets and runs an
+ * independent event loop, so the kernel spreads new connections across
+ * them. The master never accepts connections: it only respawns workers that
+ * die, forwards SIGTERM to them when a shutdown is requested and SIGUSR1
+ * (reopen the access log) as it gets it.
+ *
+ * A worker that exits with EXIT_FAILURE could not open its sockets; respawning
+ * it would fail the same way, so the whole server is stopped instead.
+ *
+ * @param workers Number of worker processes to keep running.
+ */
+void WebServer::runMaster(int workers) {
+  // Segundo del último intento de arrancar cada worker, haya fallado o no
+  std::vector<time_t> started(workers, 0);
+
+  worker_pids.assign(workers, -1);
+  while (!g_shutdownRequested) {
+    if (g_reopenLogs) {
+      g_reopenLogs = 0;
+      signalWorkers(SIGUSR1);
+    }
+    bool missing = respawnWorkers(started);
+
+    // Con huecos por rellenar no se bloquea: se reintenta al segundo siguiente
+    int   status = 0;
+    pid_t pid    = waitpid(-1, &status, missing ? WNOHANG : 0);
+    if (pid == 0 || (pid < 0 && errno == ECHILD && missing)) {
+      sleep(1);
+      continue;
+    }
+    if (pid < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_ERROR("waitpid failed: " << strerror(errno));
+      break;
+    }
+
+    std::vector<pid_t>::iterator it = std::find(worker_pids.begin(), worker_pids.end(), pid);
+    if (it == worker_pids.end()) {
+      continue;
+    }
+    int id = static_cast<int>(it - worker_pids.begin());
+    *it    = -1;
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE) {
+      LOG_CRITICAL("Worker " << id << " could not start. Shutting down.");
+      break;
+    }
+    if (WIFSIGNALED(status)) {
+      LOG_ERROR("Worker " << id << " (pid " << pid << ") killed by signal " << WTERMSIG(status));
+    } else {
+      LOG_WARNING("Worker " << id << " (pid " << pid << ") exited with status " << WEXITSTATUS(status));
+    }
+  }
+
+  stopWorkers();
+  LOG_SUCCESS("All workers stopped");
+}
+
+/**
+ * @brief Spawns the workers that are not running.
+ *
+ * A worker is not restarted less than a second after its last start, so a
+ * worker that dies right away, or a fork that fails, does not turn into a
+ * fork loop; the slot is retried on a later call.
+ *
+ * @param started Second of the last start attempt of each worker.
+ * @return true if some worker is still missing.
+ */
+bool WebServer::respawnWorkers(std::vector<time_t> &started) {
+  bool missing = false;
+  for (size_t i = 0; i < worker_pids.size(); ++i) {
+    if (worker_pids[i] > 0) {
+      continue;
+    }
+    if (started[i] != 0 && Clock::seconds() - started[i] < 1) {
+      missing = true;
+      continue;
+    }
+    started[i]     = Clock::seconds();
+    worker_pids[i] = spawnWorker(static_cast<int>(i));
+    if (worker_pids[i] < 0) {
+      missing = true;
+    }
+  }
+  return missing;
+}
+
+/**
+ * @brief Forks one worker process.
+ *
+ * The child runs the event loop with its share of max_clients and never
+ * returns from this function.
+ *
+ * @param id Index of the worker, used for SO_REUSEPORT and logging.
+ * @return The pid of the worker in the master, -1 if fork failed.
+ */
+pid_t WebServer::spawnWorker(int id) {
+  pid_t pid = fork();
+  if (pid < 0) {
+    LOG_ERROR("Failed to fork worker " << id << ": " << strerror(errno));
+    return -1;
+  }
+  if (pid > 0) {
+    LOG_INFO("Started worker " << id << " (pid " << pid << ")");
+    return pid;
+  }
+
+  int workers = static_cast<int>(worker_pids.size());
+  worker_id   = id;
+  max_clients = (config.get_max_clients() + workers - 1) / workers;
+  worker_pids.clear();
+
+  bool ok = runWorker();
+  std::exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/**
+ * @brief Sends a signal to every live worker.
+ */
+void WebServer::signalWorkers(int signum) {
+  for (size_t i = 0; i < worker_pids.size(); ++i) {
+    if (worker_pids[i] > 0) {
+      kill(worker_pids[i], signum);
+    }
+  }
+}
+
+/**
+ * @brief Sends SIGTERM to every live worker and waits for all of them.
+ */
+void WebServer::stopWorkers() {
+  signalWorkers(SIGTERM);
+  for (size_t i = 0; i < worker_pids.size(); ++i) {
+    if (worker_pids[i] <= 0) {
+      continue;
+    }
+    while (waitpid(worker_pids[i], NULL, 0) < 0 && errno == EINTR) {
+    }
+    worker_pids[i] = -1;
+  }
+}
@@ -85,14 +85,14 @@ void setupLogger(ConfigurationManager &configuration, int argc, char *argv[]) {
  * @param configuration The configuration parser.
  */
 void runWebServer(ConfigurationManager &configuration) {
-  WebServer           server(configuration);
-  std::vector<Server> servers = configuration.get_servers();
+  WebServer                  server(configuration);
+  const std::vector<Server> &servers = configuration.get_servers();
 
   for (std::vector<Server>::const_iterator it = servers.begin(); it != servers.end(); ++it) {
     std::ostringstream logMsg;
 
     if (it->getType() == 0) {
-      server.addPort(it->getListen(), it->getIp().c_str());
+      server.addPort(it->getListen(), it->getIp().c_str(), it->getListenOptions());
     }
   }
   server.run();